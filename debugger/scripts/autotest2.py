@@ -0,0 +1,124 @@
+"""
+ @copyright  Copyright 2018 GNSS Sensor Ltd. All right reserved.
+ @author     Sergey Khabarov - sergeykhbr@gmail.com
+ @brief      Interpreter, block execution and JIT modes of the functional
+             model must give the same state on the bundled firmware.
+
+ Usage: autotest2.py [config] [steps]
+"""
+
+import sys,os,re,time,socket,subprocess,tempfile,rpc
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+BIN_DIR = os.path.join(SCRIPT_DIR, '..', 'linuxbuild', 'bin')
+CONFIG = os.path.join(SCRIPT_DIR, '..', 'targets', 'functional_sim_gui.json')
+STEPS = 10000000
+SRAM_BASE = 0x10000000
+SRAM_SIZE = 0x80000
+READ_CHUNK = 0x10000
+
+# [Name, BlockExecution, Jit]
+MODES = [
+    ['Interpreter', 'false', 'false'],
+    ['Block', 'true', 'false'],
+    ['Jit', 'true', 'true'],
+]
+
+def set_attr(cfg, name, value):
+    pattern = r"\['{0}',\s*(true|false)".format(name)
+    if not re.search(pattern, cfg):
+        raise ValueError('Attribute {0} not found in config'.format(name))
+    return re.sub(pattern, "['{0}',{1}".format(name, value), cfg)
+
+def free_port():
+    """
+    TCP port of the previous simulator instance may stay occupied for a
+    while, so each instance gets its own port.
+    """
+    skt = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    skt.bind(('127.0.0.1', 0))
+    port = skt.getsockname()[1]
+    skt.close()
+    return port
+
+def run(mode, cfg, steps, tmpdir):
+    cfgfile = os.path.join(tmpdir, mode[0] + '.json')
+    cfg = set_attr(cfg, 'BlockExecution', mode[1])
+    cfg = set_attr(cfg, 'Jit', mode[2])
+    with open(cfgfile, 'w') as f:
+        f.write(cfg)
+
+    env = dict(os.environ)
+    env['LD_LIBRARY_PATH'] = BIN_DIR
+    log = open(os.path.join(tmpdir, mode[0] + '.log'), 'w')
+    rpc.client.TCP_PORT = free_port()
+    sim = subprocess.Popen([os.path.join(BIN_DIR, 'appdbg64g.exe'),
+                            '-c', cfgfile, '-nogui',
+                            '-p', str(rpc.client.TCP_PORT)],
+                           cwd=BIN_DIR, env=env, stdin=subprocess.PIPE,
+                           stdout=log, stderr=subprocess.STDOUT)
+    time.sleep(2.0)
+
+    # CPU stays halted on reset vector without GUI
+    pump = rpc.Simulator()
+    pump.connect()
+    t1 = time.time()
+    pump.step(steps)
+    t1 = time.time() - t1
+    state = {}
+    state['Steps'] = pump.simSteps()
+    state['Regs'] = pump.regs()
+    mem = ()
+    for addr in range(SRAM_BASE, SRAM_BASE + SRAM_SIZE, READ_CHUNK):
+        mem += pump.read(addr, READ_CHUNK)
+    state['Sram'] = mem
+    pump.disconnect()
+
+    sim.terminate()
+    sim.wait()
+    log.close()
+    print "{0}: {1} steps in {2:.2f} sec".format(mode[0], state['Steps'], t1)
+    return state
+
+def compare(name, ref, state):
+    err = 0
+    if state['Steps'] != ref['Steps']:
+        print "{0}: Steps {1} != {2}".format(name, state['Steps'], ref['Steps'])
+        err += 1
+    for reg in sorted(ref['Regs'].keys()):
+        if state['Regs'].get(reg) != ref['Regs'][reg]:
+            print "{0}: {1}={2:#x} expected {3:#x}".format(
+                name, reg, state['Regs'].get(reg), ref['Regs'][reg])
+            err += 1
+    if len(state['Sram']) != len(ref['Sram']):
+        print "{0}: wrong SRAM size".format(name)
+        err += 1
+    else:
+        for i in range(len(ref['Sram'])):
+            if state['Sram'][i] != ref['Sram'][i]:
+                print "{0}: SRAM differs at {1:#x}".format(name, SRAM_BASE + i)
+                err += 1
+                break
+    return err
+
+config = CONFIG
+steps = STEPS
+if len(sys.argv) > 1:
+    config = sys.argv[1]
+if len(sys.argv) > 2:
+    steps = int(sys.argv[2], 0)
+
+rpc.client.TCP_DEBUG = 0
+with open(config, 'r') as f:
+    cfg = f.read()
+tmpdir = tempfile.mkdtemp()
+
+ref = run(MODES[0], cfg, steps, tmpdir)
+errors = 0
+for mode in MODES[1:]:
+    errors += compare(mode[0], ref, run(mode, cfg, steps, tmpdir))
+
+if errors:
+    print "FAILED: {0} mismatches, logs in {1}".format(errors, tmpdir)
+    sys.exit(1)
+print "PASSED"
@@ -0,0 +1,96 @@
+"""
+ @copyright  Copyright 2018 GNSS Sensor Ltd. All right reserved.
+ @author     Sergey Khabarov - sergeykhbr@gmail.com
+ @brief      Save -> restore -> compare round-trip of the simulation state
+             using in-memory snapshot and checkpoint file.
+
+ Usage: autotest3.py [config] [steps]
+"""
+
+import sys,os,time,socket,subprocess,tempfile,filecmp,rpc
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+BIN_DIR = os.path.join(SCRIPT_DIR, '..', 'linuxbuild', 'bin')
+CONFIG = os.path.join(SCRIPT_DIR, '..', 'targets', 'functional_sim_gui.json')
+STEPS = 2000000
+
+errors = 0
+
+def free_port():
+    """
+    TCP port of the previous simulator instance may stay occupied for a
+    while, so each instance gets its own port.
+    """
+    skt = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    skt.bind(('127.0.0.1', 0))
+    port = skt.getsockname()[1]
+    skt.close()
+    return port
+
+def check(pump, resp, file, expected):
+    """
+    Response of the save/restore must be empty, the state of the
+    simulation must be the same as in the expected checkpoint file.
+    """
+    global errors
+    if resp:
+        print "{0}: {1}".format(os.path.basename(file), resp)
+        errors += 1
+        return
+    pump.save(file)
+    if not filecmp.cmp(file, expected, shallow=False):
+        print "{0} differs from {1}".format(os.path.basename(file),
+                                            os.path.basename(expected))
+        errors += 1
+
+config = CONFIG
+steps = STEPS
+if len(sys.argv) > 1:
+    config = sys.argv[1]
+if len(sys.argv) > 2:
+    steps = int(sys.argv[2], 0)
+
+rpc.client.TCP_DEBUG = 0
+tmpdir = tempfile.mkdtemp()
+snap = lambda name: os.path.join(tmpdir, name + '.snap')
+
+env = dict(os.environ)
+env['LD_LIBRARY_PATH'] = BIN_DIR
+log = open(os.path.join(tmpdir, 'sim.log'), 'w')
+rpc.client.TCP_PORT = free_port()
+sim = subprocess.Popen([os.path.join(BIN_DIR, 'appdbg64g.exe'),
+                        '-c', config, '-nogui',
+                        '-p', str(rpc.client.TCP_PORT)],
+                       cwd=BIN_DIR, env=env, stdin=subprocess.PIPE,
+                       stdout=log, stderr=subprocess.STDOUT)
+time.sleep(2.0)
+
+pump = rpc.Simulator()
+pump.connect()
+
+# Reference points: state A and state B after 'steps' more instructions
+pump.step(steps)
+pump.save(snap('A'))
+pump.save()
+pump.step(steps)
+pump.save(snap('B'))
+
+# In-memory snapshot
+check(pump, pump.restore(), snap('mem_A'), snap('A'))
+pump.step(steps)
+check(pump, None, snap('mem_B'), snap('B'))
+
+# Checkpoint file
+check(pump, pump.restore(snap('A')), snap('file_A'), snap('A'))
+pump.step(steps)
+check(pump, None, snap('file_B'), snap('B'))
+
+pump.disconnect()
+sim.terminate()
+sim.wait()
+log.close()
+
+if errors:
+    print "FAILED: {0} mismatches, files in {1}".format(errors, tmpdir)
+    sys.exit(1)
+print "PASSED"
@@ -35,6 +35,41 @@ class Simulator(object):
         req = ["Command","loadmap {0}".format(file)]
         return self.client.send(req)
 
+    def regs(self):
+        """
+        Read CPU registers as a dictionary {name: value}.
+        """
+        req = ["Command","regs"]
+        return self.client.send(req)
+
+    def read(self, addr, size):
+        """
+        Read memory block. Returns tuple of bytes.
+        """
+        req = ["Command","read {0:#x} {1}".format(addr, size)]
+        return self.client.send(req)
+
+    def save(self, file=None):
+        """
+        Save simulation state into file or into host memory when file
+        isn't specified. Simulation must be halted.
+        """
+        if file:
+            req = ["Snapshot",["Save",file]]
+        else:
+            req = ["Snapshot",["Save"]]
+        return self.client.send(req)
+
+    def restore(self, file=None):
+        """
+        Restore simulation state saved by save() method.
+        """
+        if file:
+            req = ["Snapshot",["Restore",file]]
+        else:
+            req = ["Snapshot",["Restore"]]
+        return self.client.send(req)
+
     def pressButton(self, btn):
         req = ["Button",["Press",btn]]
         return self.client.send(req)
@@ -219,26 +219,51 @@ int RISCV_sprintf(char *s, size_t len, const char *fmt, ...);
 /** Format output to the default stream. */
 int RISCV_printf(void *iface, int level, const char *fmt, ...);
 
+/** Check the logging level of the service before formatting output. */
+int RISCV_is_log_enabled(void *iface, int level);
+
+/**
+ * Messages with the level above this value are removed from the build,
+ * e.g. -DRISCV_LOG_LEVEL_MAX=3 drops all RISCV_debug() calls.
+ */
+#ifndef RISCV_LOG_LEVEL_MAX
+#define RISCV_LOG_LEVEL_MAX LOG_DEBUG
+#endif
+
+/**
+ * Arguments aren't evaluated when the level is disabled. Inside a service
+ * getLogLevel() is the inline IService member, so disabled messages don't
+ * look up any interface.
+ */
+#define RISCV_log(level, fmt, ...) \
+    do { \
+        if ((level) <= RISCV_LOG_LEVEL_MAX && (level) <= getLogLevel()) { \
+            IFace *log_iface_ = getInterface(IFACE_SERVICE); \
+            if (RISCV_is_log_enabled(log_iface_, level)) { \
+                RISCV_printf(log_iface_, level, fmt, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
 /** Output always */
 #define RISCV_printf0(fmt, ...) \
     RISCV_printf(getInterface(IFACE_SERVICE), 0, fmt, __VA_ARGS__)
 
 /** Output with the maximal logging level */
 #define RISCV_error(fmt, ...) \
-    RISCV_printf(getInterface(IFACE_SERVICE), LOG_ERROR, "%s:%d " fmt, \
-                 __FILE__, __LINE__, __VA_ARGS__)
+    RISCV_log(LOG_ERROR, "%s:%d " fmt, __FILE__, __LINE__, __VA_ARGS__)
 
 /** Output with the information logging level */
 #define RISCV_important(fmt, ...) \
-    RISCV_printf(getInterface(IFACE_SERVICE), LOG_IMPORTANT, fmt, __VA_ARGS__)
+    RISCV_log(LOG_IMPORTANT, fmt, __VA_ARGS__)
 
 /** Output with the information logging level */
 #define RISCV_info(fmt, ...) \
-    RISCV_printf(getInterface(IFACE_SERVICE), LOG_INFO, fmt, __VA_ARGS__)
+    RISCV_log(LOG_INFO, fmt, __VA_ARGS__)
 
 /** Output with the lower logging level */
 #define RISCV_debug(fmt, ...) \
-    RISCV_printf(getInterface(IFACE_SERVICE), LOG_DEBUG, fmt, __VA_ARGS__)
+    RISCV_log(LOG_DEBUG, fmt, __VA_ARGS__)
 
 /** Suspend thread on certain number of milliseconds */
 void RISCV_sleep_ms(int ms);
@@ -252,6 +277,9 @@ int RISCV_get_pid();
 /** Memory barrier */
 void RISCV_memory_barrier();
 
+/** Atomically add value and return the previous one */
+uint64_t RISCV_atomic_add64(volatile uint64_t *p, uint64_t v);
+
 void RISCV_thread_create(void *data);
 uint64_t RISCV_thread_id();
 
@@ -294,6 +322,12 @@ void RISCV_write_json_file(const char *filename, const char *s);
 }
 #endif
 
+/**
+ * Used by RISCV_log() outside of services (ports, registers), their parent
+ * service level is checked by RISCV_is_log_enabled().
+ */
+inline int getLogLevel() { return LOG_DEBUG; }
+
 }  // namespace debugger
 
 #endif  // __DEBUGGER_API_CORE_H__
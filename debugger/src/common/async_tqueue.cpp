@@ -73,8 +73,10 @@ void AsyncTQueueType::initProc() {
 
 /** Clock queue */
 ClockAsyncTQueueType::ClockAsyncTQueueType() {
-    size_ = 1;
-    queue_ = new StepQueueItemType[size_];
+    size_ = 0;
+    items_ = 0;
+    heap_ = 0;
+    prequeue_ = 0;
 
     RISCV_mutex_init(&mutex_);
     hardReset();
@@ -82,48 +84,151 @@ ClockAsyncTQueueType::ClockAsyncTQueueType() {
 
 ClockAsyncTQueueType::~ClockAsyncTQueueType() {
     RISCV_mutex_destroy(&mutex_);
-    delete [] queue_;
+    delete [] items_;
+    delete [] heap_;
+    delete [] prequeue_;
 }
 
 void ClockAsyncTQueueType::hardReset() {
-    item_total_ = 0;
+    free_ = -1;
+    for (int i = size_ - 1; i >= 0; i--) {
+        items_[i].next = free_;
+        free_ = i;
+    }
+    for (int i = 0; i < HASH_TABLE_SIZE; i++) {
+        hash_[i] = -1;
+    }
+    heap_cnt_ = 0;
     precnt_ = 0;
-    item_cnt_ = 0;
+    pre_time_ = ~0ull;
+    next_time_ = ~0ull;
 }
 
+int ClockAsyncTQueueType::allocItem(uint64_t time, IFace *cb) {
+    if (free_ < 0) {
+        int t1 = size_ ? 2 * size_ : 16;
+        StepQueueItemType *p1 = new StepQueueItemType[t1];
+        int *p2 = new int[t1];
+        int *p3 = new int[t1];
+        if (size_) {
+            memcpy(p1, items_, size_ * sizeof(StepQueueItemType));
+            memcpy(p2, heap_, heap_cnt_ * sizeof(int));
+            memcpy(p3, prequeue_, precnt_ * sizeof(int));
+            delete [] items_;
+            delete [] heap_;
+            delete [] prequeue_;
+        }
+        items_ = p1;
+        heap_ = p2;
+        prequeue_ = p3;
+        for (int i = t1 - 1; i >= size_; i--) {
+            items_[i].next = free_;
+            free_ = i;
+        }
+        size_ = t1;
+    }
+    int idx = free_;
+    int h = hash(cb);
+    free_ = items_[idx].next;
+    items_[idx].time = time;
+    items_[idx].iface = cb;
+    items_[idx].heap_pos = -1;
+    items_[idx].next = hash_[h];
+    hash_[h] = idx;
+    return idx;
+}
+
+void ClockAsyncTQueueType::freeItem(int idx) {
+    int *pprev = &hash_[hash(items_[idx].iface)];
+    while (*pprev != idx) {
+        pprev = &items_[*pprev].next;
+    }
+    *pprev = items_[idx].next;
+    items_[idx].next = free_;
+    free_ = idx;
+}
+
+void ClockAsyncTQueueType::heapPush(int idx) {
+    heapSet(heap_cnt_, idx);
+    siftUp(heap_cnt_++);
+}
+
+void ClockAsyncTQueueType::siftUp(int pos) {
+    int idx = heap_[pos];
+    uint64_t t = items_[idx].time;
+    while (pos > 0) {
+        int parent = (pos - 1) >> 1;
+        if (items_[heap_[parent]].time <= t) {
+            break;
+        }
+        heapSet(pos, heap_[parent]);
+        pos = parent;
+    }
+    heapSet(pos, idx);
+}
+
+void ClockAsyncTQueueType::siftDown(int pos) {
+    int idx = heap_[pos];
+    uint64_t t = items_[idx].time;
+    while (true) {
+        int child = 2 * pos + 1;
+        if (child >= heap_cnt_) {
+            break;
+        }
+        if (child + 1 < heap_cnt_
+            && items_[heap_[child + 1]].time < items_[heap_[child]].time) {
+            child++;
+        }
+        if (t <= items_[heap_[child]].time) {
+            break;
+        }
+        heapSet(pos, heap_[child]);
+        pos = child;
+    }
+    heapSet(pos, idx);
+}
+
+void ClockAsyncTQueueType::updateNextTime() {
+    uint64_t t = pre_time_;
+    if (heap_cnt_ && items_[heap_[0]].time < t) {
+        t = items_[heap_[0]].time;
+    }
+    next_time_ = t;
+}
 
 void ClockAsyncTQueueType::put(uint64_t time, IFace *cb) {
     RISCV_mutex_lock(&mutex_);
-    if (precnt_ >= 1024) {
-        RISCV_mutex_unlock(&mutex_);
-        RISCV_printf(0, 0, "clock pre-queue overflow: %d", precnt_);
-        return;
+    int idx = allocItem(time, cb);
+    prequeue_[precnt_++] = idx;
+    if (time < pre_time_) {
+        pre_time_ = time;
+    }
+    if (time < next_time_) {
+        next_time_ = time;
     }
-    prequeue_[precnt_].left = 0;
-    prequeue_[precnt_].right = 0;
-    prequeue_[precnt_].time = time;
-    prequeue_[precnt_++].iface = cb;
     RISCV_mutex_unlock(&mutex_);
 }
 
 bool ClockAsyncTQueueType::move(IFace *cb, uint64_t time) {
     RISCV_mutex_lock(&mutex_);
-    for (int i = 0; i < precnt_; i++) {
-        if (prequeue_[i].iface == cb) {
-            prequeue_[i].time = time;
-            RISCV_mutex_unlock(&mutex_);
-            return true;
-        }
+    int idx = hash_[hash(cb)];
+    while (idx >= 0 && items_[idx].iface != cb) {
+        idx = items_[idx].next;
     }
-    for (int i = 0; i < item_total_; i++) {
-        if (queue_[i].iface == cb) {
-            queue_[i].time = time;
-            RISCV_mutex_unlock(&mutex_);
-            return true;
-        }
+    if (idx < 0) {
+        RISCV_mutex_unlock(&mutex_);
+        return false;
     }
+    items_[idx].time = time;
+    if (items_[idx].heap_pos >= 0) {
+        siftUp(items_[idx].heap_pos);
+        siftDown(items_[idx].heap_pos);
+    } else if (time < pre_time_) {
+        pre_time_ = time;
+    }
+    updateNextTime();
     RISCV_mutex_unlock(&mutex_);
-    return false;
+    return true;
 }
 
 void ClockAsyncTQueueType::pushPreQueued() {
@@ -131,43 +236,47 @@ void ClockAsyncTQueueType::pushPreQueued() {
         return;
     }
     RISCV_mutex_lock(&mutex_);
-    while ((precnt_ + item_total_) > size_) {
-        int t1 = 2*size_;
-        StepQueueItemType *p1 = new StepQueueItemType[t1];
-        memcpy(p1, queue_, item_total_*sizeof(StepQueueItemType));
-        delete [] queue_;
-        queue_ = p1;
-        size_ = t1;
+    for (int i = 0; i < precnt_; i++) {
+        heapPush(prequeue_[i]);
     }
-    memcpy(&queue_[item_total_], prequeue_, precnt_*sizeof(StepQueueItemType));
-    item_total_ += precnt_;
     precnt_ = 0;
+    pre_time_ = ~0ull;
+    updateNextTime();
     RISCV_mutex_unlock(&mutex_);
 }
 
-
 IFace *ClockAsyncTQueueType::getNext(uint64_t step_cnt) {
     IFace *ret = 0;
-    if (item_cnt_ >= item_total_) {
+    if (step_cnt < next_time_) {
         return ret;
     }
-    for (; item_cnt_ < item_total_; item_cnt_++) {
-        if (step_cnt < queue_[item_cnt_].time) {
-            continue;
-        }
-        ret = queue_[item_cnt_].iface;
-
-        // remove item from list using swap function to avoid usage
-        // of allocation/deallocation calls.
-        if (item_cnt_ < (item_total_ - 1)) {
-            queue_[item_cnt_] = queue_[item_total_ - 1];
+    RISCV_mutex_lock(&mutex_);
+    if (heap_cnt_ && items_[heap_[0]].time <= step_cnt) {
+        int idx = heap_[0];
+        ret = items_[idx].iface;
+        if (--heap_cnt_) {
+            heapSet(0, heap_[heap_cnt_]);
+            siftDown(0);
         }
-        item_total_--;
-        break;
+        freeItem(idx);
+        updateNextTime();
     }
+    RISCV_mutex_unlock(&mutex_);
     return ret;
 }
 
+void ClockAsyncTQueueType::getItem(int idx, uint64_t *time, IFace **cb) {
+    RISCV_mutex_lock(&mutex_);
+    if (idx < heap_cnt_) {
+        idx = heap_[idx];
+    } else {
+        idx = prequeue_[idx - heap_cnt_];
+    }
+    *time = items_[idx].time;
+    *cb = items_[idx].iface;
+    RISCV_mutex_unlock(&mutex_);
+}
+
 
 /** GUI queue */
 GuiAsyncTQueueType::GuiAsyncTQueueType() : AsyncTQueueType() {
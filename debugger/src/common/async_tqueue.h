@@ -51,6 +51,15 @@ class AsyncTQueueType {
 };
 
 
+/**
+ * @brief Queue of the clock callbacks.
+ *
+ * Registered callbacks are kept in the indexed min-heap ordered by time.
+ * Callbacks registered by put() are collected in the pre-queue and moved
+ * into heap by pushPreQueued(), so callback registered while processing
+ * the queue is called not earlier than on the next processing cycle.
+ * Interface pointers are hashed to find the moved callbacks.
+ */
 class ClockAsyncTQueueType {
  public:
     ClockAsyncTQueueType();
@@ -65,9 +74,6 @@ class ClockAsyncTQueueType {
     /** push registered to the main queue */
     void pushPreQueued();
 
-    /** Reset proccessed counter at the begining of each iteration */
-    void initProc() { item_cnt_ = 0; }
-
     /** move previously regsiterd callbacks: true: moved; false: not found */
     bool move(IFace *cb, uint64_t time);
 
@@ -76,20 +82,56 @@ class ClockAsyncTQueueType {
      */
     IFace *getNext(uint64_t step_cnt);
 
+    /**
+     * Earliest time of the registered callbacks. Value may be less than
+     * the real one (moved pre-queued callbacks) but never greater.
+     */
+    uint64_t getNextTime() { return next_time_; }
+
+    /** Number of registered callbacks including pre-queued */
+    int size() { return heap_cnt_ + precnt_; }
+
+    /** Get registered callback with index in range [0, size()) */
+    void getItem(int idx, uint64_t *time, IFace **cb);
+
+ private:
+    int allocItem(uint64_t time, IFace *cb);
+    void freeItem(int idx);
+    int hash(IFace *cb) {
+        return static_cast<int>(
+            (reinterpret_cast<uintptr_t>(cb) >> 4) & (HASH_TABLE_SIZE - 1));
+    }
+    void heapPush(int idx);
+    void heapSet(int pos, int idx) {
+        heap_[pos] = idx;
+        items_[idx].heap_pos = pos;
+    }
+    void siftUp(int pos);
+    void siftDown(int pos);
+    void updateNextTime();
+
  private:
+    static const int HASH_TABLE_SIZE = 1 << 8;
+
     struct StepQueueItemType {
-        StepQueueItemType *left;
-        StepQueueItemType *right;
         uint64_t time;
         IFace *iface;
+        int heap_pos;       // -1 when item is pre-queued
+        int next;           // hash chain or free list
     };
-    StepQueueItemType *queue_;
-    int size_;
-    int item_total_;
-    int item_cnt_;
+    StepQueueItemType *items_;
+    int size_;              // allocated items, heap_ and prequeue_ size
+    int free_;
+    int hash_[HASH_TABLE_SIZE];
+
+    int *heap_;
+    int heap_cnt_;
 
+    int *prequeue_;
     int precnt_;
-    StepQueueItemType prequeue_[1024];
+    uint64_t pre_time_;     // earliest pre-queued time
+
+    volatile uint64_t next_time_;
 
     mutex_def mutex_;
 };
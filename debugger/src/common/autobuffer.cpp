@@ -37,16 +37,16 @@ void AutoBuffer::write_bin(const char *p, int sz) {
     if (buf_len_ + sz >= buf_size_) {
         if (buf_size_ == 0) {
             buf_size_ = 1024;
-            buf_ = new char[buf_size_];
-        } else {
-            while (buf_len_ + sz >= buf_size_) {
-                buf_size_ <<= 1;
-            }
-            char *t1 = new char[buf_size_];
+        }
+        while (buf_len_ + sz >= buf_size_) {
+            buf_size_ <<= 1;
+        }
+        char *t1 = new char[buf_size_];
+        if (buf_) {
             memcpy(t1, buf_, buf_len_);
             delete [] buf_;
-            buf_ = t1;
         }
+        buf_ = t1;
     }
     memcpy(&buf_[buf_len_], p, sz);
     buf_len_ += sz;
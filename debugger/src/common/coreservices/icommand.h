@@ -17,9 +17,14 @@
 #ifndef __DEBUGGER_COMMON_CORESERVICES_ICOMMAND_H__
 #define __DEBUGGER_COMMON_CORESERVICES_ICOMMAND_H__
 
+#include <string.h>
 #include <iface.h>
 #include <attribute.h>
+#include <api_core.h>
+#include <iservice.h>
 #include "coreservices/itap.h"
+#include "coreservices/idsugen.h"
+#include "debug/dsumap.h"
 
 namespace debugger {
 
@@ -52,6 +57,67 @@ class ICommand : public IFace {
         (*res)[2].make_string(descr);
     }
 
+ protected:
+    /** Check the run control register of each hart accessed via DSU */
+    virtual bool isHalted() {
+        Reg64Type t1, ctx;
+        GenericCpuControlType ctrl;
+        DsuMapType *pdsu = DSUBASE();
+        uint64_t addr = reinterpret_cast<uint64_t>(&pdsu->udbg.v.control);
+        uint64_t addr_ctx =
+            reinterpret_cast<uint64_t>(&pdsu->ulocal.v.cpu_context);
+        uint64_t addr_total =
+            reinterpret_cast<uint64_t>(&pdsu->ulocal.v.cpu_total);
+        tap_->read(addr_total, 8, t1.buf);
+        uint64_t total = t1.val;
+        if (total <= 1) {
+            tap_->read(addr, 8, t1.buf);
+            ctrl.val = t1.val;
+            return ctrl.bits.halt != 0;
+        }
+
+        bool halted = true;
+        tap_->read(addr_ctx, 8, ctx.buf);
+        for (uint64_t i = 0; i < total && halted; i++) {
+            t1.val = i;
+            tap_->write(addr_ctx, 8, t1.buf);
+            tap_->read(addr, 8, t1.buf);
+            ctrl.val = t1.val;
+            halted = ctrl.bits.halt != 0;
+        }
+        tap_->write(addr_ctx, 8, ctx.buf);
+        return halted;
+    }
+
+    /**
+     * Service of the hart selected by 'hart' command from the list of
+     * services. Service is matched by its name or by the value of 'attr'
+     * attribute when it isn't 0. Without match the first one is used.
+     */
+    IService *getHartService(AttributeType *lst, const char *attr = 0) {
+        AttributeType lstDsu;
+        const char *cpuname = 0;
+        RISCV_get_services_with_iface(IFACE_DSU_GENERIC, &lstDsu);
+        if (lstDsu.size()) {
+            IService *idsu = static_cast<IService *>(lstDsu[0u].to_iface());
+            cpuname = static_cast<IDsuGeneric *>(
+                idsu->getInterface(IFACE_DSU_GENERIC))->getContextCpuName();
+        }
+        for (unsigned i = 0; cpuname && i < lst->size(); i++) {
+            IService *iserv = static_cast<IService *>((*lst)[i].to_iface());
+            const char *name = iserv->getObjName();
+            if (attr) {
+                AttributeType *a = static_cast<AttributeType *>(
+                                    iserv->getAttribute(attr));
+                name = a && a->is_string() ? a->to_string() : "";
+            }
+            if (strcmp(name, cpuname) == 0) {
+                return iserv;
+            }
+        }
+        return static_cast<IService *>((*lst)[0u].to_iface());
+    }
+
  protected:
     AttributeType cmdName_;
     AttributeType briefDescr_;
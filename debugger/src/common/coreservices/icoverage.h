@@ -0,0 +1,59 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef __DEBUGGER_COMMON_CORESERVICES_ICOVERAGE_H__
+#define __DEBUGGER_COMMON_CORESERVICES_ICOVERAGE_H__
+
+#include <inttypes.h>
+#include <iface.h>
+
+namespace debugger {
+
+static const char *const IFACE_COVERAGE_TRACKER = "ICoverageTracker";
+
+/**
+ * @brief Executed code tracker.
+ *
+ * Instructions are tracked inside of the address region cached by the CPU
+ * model without any instrumentation of the executed firmware.
+ */
+class ICoverageTracker : public IFace {
+ public:
+    ICoverageTracker() : IFace(IFACE_COVERAGE_TRACKER) {}
+
+    /** Tracked address range. Size is zero if tracking isn't available */
+    virtual void getCoverageRegion(uint64_t *base, uint64_t *size) = 0;
+
+    /** Instruction starting at the address was executed */
+    virtual bool isCovered(uint64_t addr) = 0;
+
+    /** Number of executed instructions */
+    virtual uint64_t coveredTotal() = 0;
+
+    /** Track (previous pc, pc) pairs. Slows down the simulation */
+    virtual void enableEdgeCoverage(bool en) = 0;
+
+    /** Number of different (previous pc, pc) hashes */
+    virtual unsigned edgeTotal() = 0;
+
+    /** Clear collected data. Should be called while CPU is halted */
+    virtual void resetCoverage() = 0;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_CORESERVICES_ICOVERAGE_H__
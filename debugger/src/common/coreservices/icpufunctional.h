@@ -21,6 +21,7 @@
 #include <iface.h>
 #include <api_types.h>
 #include "coreservices/imemop.h"
+#include "coreservices/iinstrmix.h"
 
 namespace debugger {
 
@@ -37,7 +38,21 @@ class IInstruction : public IFace {
 
 class GenericInstruction : public IInstruction {
  public:
-    GenericInstruction() : IInstruction() {}
+    GenericInstruction() : IInstruction() {
+        mix_[0] = InstrMix_Alu;
+        mix_[1] = InstrMix_Alu;
+    }
+
+    /** Mix class of the executed instruction with or without branch */
+    unsigned mixType(bool branch) { return mix_[branch]; }
+    void setMixType(EInstrMixType seq, EInstrMixType branch) {
+        mix_[0] = static_cast<uint8_t>(seq);
+        mix_[1] = static_cast<uint8_t>(branch);
+    }
+    void setMixType(EInstrMixType t) { setMixType(t, t); }
+
+ protected:
+    uint8_t mix_[2];
 };
 
 enum EEndianessType {
@@ -56,6 +71,11 @@ class ICpuFunctional : public IFace {
     virtual void setBranch(uint64_t npc) = 0;
     virtual void pushStackTrace() = 0;
     virtual void popStackTrace() = 0;
+    /**
+     * Copy addresses of the call instructions starting from the outermost
+     * call. Return number of copied addresses.
+     */
+    virtual unsigned getCallStack(uint64_t *calls, unsigned max) = 0;
     virtual uint64_t getPrvLevel() = 0;
     virtual void setPrvLevel(uint64_t lvl) = 0;
     virtual void dma_memop(Axi4TransactionType *tr) = 0;
@@ -31,6 +31,9 @@ class IDsuGeneric : public IFace {
     /** Bus utilization statistic methods */
     virtual void incrementRdAccess(int mst_id) = 0;
     virtual void incrementWrAccess(int mst_id) = 0;
+
+    /** Name of the CPU accessed by debugger via regions 0..2 */
+    virtual const char *getContextCpuName() = 0;
 };
 
 }  // namespace debugger
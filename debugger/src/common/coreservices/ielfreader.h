@@ -25,6 +25,18 @@ namespace debugger {
 
 static const char *const IFACE_ELFREADER = "IElfReader";
 
+/**
+ * Row of the DWARF line table. It describes instructions starting from
+ * 'addr' up to the address of the next row. Row with zero line ends the
+ * sequence of addresses.
+ */
+struct SourceLineType {
+    uint64_t addr;
+    const char *dir;        // include directory, empty if unknown
+    const char *file;
+    uint32_t line;
+};
+
 class IElfReader : public IFace {
  public:
     IElfReader() : IFace(IFACE_ELFREADER) {}
@@ -39,7 +51,16 @@ class IElfReader : public IFace {
 
     virtual uint64_t sectionSize(unsigned idx) = 0;
 
-    virtual uint8_t *sectionData(unsigned idx) = 0;
+    /**
+     * Section content or NULL for zero-filled section (.bss). Data is valid
+     * until the next readFile() call.
+     */
+    virtual const uint8_t *sectionData(unsigned idx) = 0;
+
+    /** Rows of the '.debug_line' section. Valid until the next readFile() */
+    virtual unsigned sourceLineTotal() = 0;
+
+    virtual const SourceLineType *sourceLine(unsigned idx) = 0;
 };
 
 }  // namespace debugger
@@ -0,0 +1,74 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef __DEBUGGER_COMMON_CORESERVICES_IINSTRMIX_H__
+#define __DEBUGGER_COMMON_CORESERVICES_IINSTRMIX_H__
+
+#include <inttypes.h>
+#include <iface.h>
+
+namespace debugger {
+
+static const char *const IFACE_INSTR_MIX = "IInstrMix";
+
+/** Execution class of the instruction */
+enum EInstrMixType {
+    InstrMix_Alu,
+    InstrMix_Load,
+    InstrMix_Store,
+    InstrMix_BranchNotTaken,
+    InstrMix_BranchTaken,
+    InstrMix_Jump,
+    InstrMix_MulDiv,
+    InstrMix_Fpu,
+    InstrMix_Atomic,
+    InstrMix_Csr,
+    InstrMix_System,
+    InstrMix_Illegal,
+    InstrMix_Total
+};
+
+static const unsigned TRAP_CODE_TOTAL = 32;
+
+struct InstrMixType {
+    uint64_t instr[InstrMix_Total];
+    uint64_t oplen[2];                  // 16-bit and 32-bit instructions
+    uint64_t trap[2][TRAP_CODE_TOTAL];  // exceptions and interrupts
+};
+
+/**
+ * @brief Instruction mix and traps statistic of the functional CPU.
+ *
+ * Trap codes are ISA specific: mcause code for RISC-V and exception
+ * vector index for ARM.
+ */
+class IInstrMix : public IFace {
+ public:
+    IInstrMix() : IFace(IFACE_INSTR_MIX) {}
+
+    virtual void enableInstrMix(bool en) = 0;
+    virtual bool isInstrMixEnabled() = 0;
+
+    /** Copy current counters */
+    virtual void getInstrMix(InstrMixType *mix) = 0;
+
+    virtual void resetInstrMix() = 0;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_CORESERVICES_IINSTRMIX_H__
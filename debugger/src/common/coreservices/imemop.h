@@ -62,6 +62,33 @@ typedef struct Axi4TransactionType {
     int source_idx;             // Need for bus utilization statistic
 } Axi4TransactionType;
 
+static const int DMI_ACCESS_READ = 0x1;
+static const int DMI_ACCESS_WRITE = 0x2;
+static const int DMI_PAGE_SHIFT = 12;
+
+/**
+ * Direct memory interface region.
+ *
+ * Range [addr, addr + length) is described uniformly: when 'access' is
+ * non-zero host pointer 'ptr' corresponds to 'addr' and may be used instead
+ * of the blocking transactions, otherwise the range has to be accessed
+ * via b_transport().
+ *
+ * Optional 'dirty' map has one flag per 2^DMI_PAGE_SHIFT bytes page counted
+ * from the host pointer 'pagebase'. Direct write is allowed only into pages
+ * with non-zero flag, the first write into other page goes via b_transport()
+ * so the device can copy the page before modification.
+ */
+typedef struct DmiRegionType {
+    uint64_t addr;
+    uint64_t length;
+    uint8_t *ptr;
+    int access;                 // DMI_ACCESS_* flags
+    uint64_t *util;             // [write, read] bus utilization counters
+    const volatile uint8_t *dirty;
+    const uint8_t *pagebase;
+} DmiRegionType;
+
 /**
  * Non-blocking memory access response interface (Initiator/Master)
  */
@@ -111,6 +138,20 @@ class IMemoryOperation : public IFace {
      */
     virtual ETransStatus b_transport(Axi4TransactionType *trans) = 0;
 
+    /**
+     * Direct memory interface request
+     *
+     * Device returns true and fills DMI region containing trans->addr if
+     * its memory can be accessed directly by the host pointer. Bus also
+     * describes the regions without DMI support (access = 0), so that
+     * initiator doesn't repeat the request on each transaction.
+     * Default implementation doesn't support DMI.
+     */
+    virtual bool getDmiPointer(Axi4TransactionType *trans,
+                               DmiRegionType *dmi) {
+        return false;
+    }
+
     /**
      * Non-blocking transaction
      *
@@ -124,6 +165,12 @@ class IMemoryOperation : public IFace {
         return ret;
     }
 
+    /**
+     * Device handles concurrent transactions itself. Otherwise the bus
+     * serializes all transactions to the device.
+     */
+    virtual bool isThreadSafe() { return false; }
+
     virtual uint64_t getBaseAddress() { return baseAddress_.to_uint64(); }
     virtual void setBaseAddress(uint64_t addr) {
         baseAddress_.make_uint64(addr);
@@ -0,0 +1,66 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef __DEBUGGER_COMMON_CORESERVICES_IPROFILER_H__
+#define __DEBUGGER_COMMON_CORESERVICES_IPROFILER_H__
+
+#include <inttypes.h>
+#include <iface.h>
+#include <attribute.h>
+
+namespace debugger {
+
+static const char *const IFACE_PROFILER = "IProfiler";
+
+enum EProfileFunctionItem {
+    ProfFunc_Name,
+    ProfFunc_Self,          // samples with pc inside of the function
+    ProfFunc_Inclusive,     // samples with the function on the call stack
+    ProfFunc_Total
+};
+
+/**
+ * @brief Statistical profiler of the executed code.
+ *
+ * Program counter and call stack of CPU are sampled with the fixed
+ * period of steps.
+ */
+class IProfiler : public IFace {
+ public:
+    IProfiler() : IFace(IFACE_PROFILER) {}
+
+    /** Start or stop sampling. Zero period keeps the previous value */
+    virtual void enableProfiler(bool en, uint64_t period) = 0;
+
+    virtual bool isProfilerEnabled() = 0;
+
+    virtual uint64_t getSamplePeriod() = 0;
+
+    virtual uint64_t sampleTotal() = 0;
+
+    virtual void resetProfile() = 0;
+
+    /** Functions list sorted by the number of self samples */
+    virtual void getTopFunctions(unsigned n, AttributeType *res) = 0;
+
+    /** Write 'outer;...;inner count' lines used by flame graph tools */
+    virtual bool writeFoldedStacks(const char *filename) = 0;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_CORESERVICES_IPROFILER_H__
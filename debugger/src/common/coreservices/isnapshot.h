@@ -0,0 +1,129 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_COMMON_CORESERVICES_ISNAPSHOT_H__
+#define __DEBUGGER_COMMON_CORESERVICES_ISNAPSHOT_H__
+
+#include <inttypes.h>
+#include <string.h>
+#include <iface.h>
+#include <autobuffer.h>
+
+namespace debugger {
+
+/**
+ * Checkpoint file:
+ *   header:   "RVSNAP\0\0", uint32 version, uint32 sections total;
+ *   sections: zero-terminated service name, uint32 size, state data.
+ */
+static const char SNAPSHOT_MAGIC[8] = {'R', 'V', 'S', 'N', 'A', 'P', 0, 0};
+static const uint32_t SNAPSHOT_VERSION = 2;
+
+/** Sequential reader of the state written by ISnapshot::saveState() */
+class SnapshotReader {
+ public:
+    SnapshotReader(const uint8_t *buf, unsigned sz)
+        : buf_(buf), size_(sz), pos_(0) {}
+
+    /** Copy data into 'p'. Return false if section is too short */
+    bool read(void *p, unsigned sz) {
+        if (sz > size_ - pos_) {
+            pos_ = size_;
+            return false;
+        }
+        memcpy(p, &buf_[pos_], sz);
+        pos_ += sz;
+        return true;
+    }
+    /** Pointer on the next 'sz' bytes or 0 if section is too short */
+    const uint8_t *readData(unsigned sz) {
+        if (sz > size_ - pos_) {
+            pos_ = size_;
+            return 0;
+        }
+        pos_ += sz;
+        return &buf_[pos_ - sz];
+    }
+    /** Zero-terminated string or 0 if it exceeds section */
+    const char *readString() {
+        const char *ret = reinterpret_cast<const char *>(&buf_[pos_]);
+        unsigned i = pos_;
+        while (i < size_ && buf_[i]) {
+            i++;
+        }
+        if (i == size_) {
+            pos_ = size_;
+            return 0;
+        }
+        pos_ = i + 1;
+        return ret;
+    }
+    unsigned left() { return size_ - pos_; }
+
+ private:
+    const uint8_t *buf_;
+    unsigned size_;
+    unsigned pos_;
+};
+
+
+static const char *const IFACE_SNAPSHOT = "ISnapshot";
+
+/**
+ * @brief Device state checkpoint.
+ *
+ * Methods are called by 'save'/'restore' commands only while the CPU is
+ * halted, so the device state isn't modified by the simulation thread.
+ */
+class ISnapshot : public IFace {
+ public:
+    ISnapshot() : IFace(IFACE_SNAPSHOT) {}
+
+    /** Append device state to the buffer */
+    virtual void saveState(AutoBuffer *buf) = 0;
+
+    /** Restore state written by saveState(). Return false on wrong format */
+    virtual bool restoreState(SnapshotReader *rd) = 0;
+
+    /**
+     * Keep the current state in host memory. Devices with large state
+     * override it to copy only the data modified after the snapshot.
+     */
+    virtual void takeSnapshot() {
+        snapshot_.clear();
+        saveState(&snapshot_);
+    }
+
+    /** takeSnapshot() was called and its state can be rewound */
+    virtual bool hasSnapshot() { return snapshot_.size() != 0; }
+
+    /** Return to the state of the last takeSnapshot() */
+    virtual bool rewindSnapshot() {
+        if (snapshot_.size() == 0) {
+            return false;
+        }
+        SnapshotReader rd(reinterpret_cast<uint8_t *>(snapshot_.getBuffer()),
+                          static_cast<unsigned>(snapshot_.size()));
+        return restoreState(&rd);
+    }
+
+ protected:
+    AutoBuffer snapshot_;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_CORESERVICES_ISNAPSHOT_H__
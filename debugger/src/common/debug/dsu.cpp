@@ -16,6 +16,7 @@
 
 #include <api_core.h>
 #include "dsu.h"
+#include "dsumap.h"
 
 namespace debugger {
 
@@ -26,24 +27,42 @@ DSU::DSU(const char *name)  : IService(name) {
     registerAttribute("CPU", &cpu_);
     registerAttribute("Bus", &bus_);
 
+    cpu_.make_list(0);
     memset(&info_, 0, sizeof(info_));
     soft_reset_ = 0x0;  // Active LOW
+    cpuTotal_ = 0;
+    cpuContext_ = 0;
+    nb_trans_.bcast_idx = -1;
 }
 
 DSU::~DSU() {
 }
 
+/**
+ * CPU attribute is the name of the single CPU or the list of harts names.
+ */
 void DSU::postinitService() {
-    icpu_ = static_cast<ICpuGeneric *>(
-        RISCV_get_service_iface(cpu_.to_string(), IFACE_CPU_GENERIC));
-    if (!icpu_) {
-        RISCV_error("Can't find ICpuGeneric interface %s", cpu_.to_string());
+    unsigned total = cpu_.is_list() ? cpu_.size() : 1;
+    if (total > static_cast<unsigned>(CPU_MAX)) {
+        RISCV_error("Number of CPUs exceeds %d", CPU_MAX);
+        total = CPU_MAX;
     }
-    icpurst_ = static_cast<IResetListener *>(
-        RISCV_get_service_iface(cpu_.to_string(), IFACE_RESET_LISTENER));
-    if (!icpurst_) {
-        RISCV_error("Can't find IResetListener interface %s",
-                    cpu_.to_string());
+    for (unsigned i = 0; i < total; i++) {
+        const char *cpuname = cpu_.is_list() ? cpu_[i].to_string()
+                                             : cpu_.to_string();
+        icpu_[i] = static_cast<ICpuGeneric *>(
+            RISCV_get_service_iface(cpuname, IFACE_CPU_GENERIC));
+        if (!icpu_[i]) {
+            RISCV_error("Can't find ICpuGeneric interface %s", cpuname);
+            break;
+        }
+        icpurst_[i] = static_cast<IResetListener *>(
+            RISCV_get_service_iface(cpuname, IFACE_RESET_LISTENER));
+        if (!icpurst_[i]) {
+            RISCV_error("Can't find IResetListener interface %s", cpuname);
+            break;
+        }
+        cpuTotal_++;
     }
     ibus_ = static_cast<IMemoryOperation *>(
         RISCV_get_service_iface(bus_.to_string(), IFACE_MEMORY_OPERATION));
@@ -55,7 +74,7 @@ void DSU::postinitService() {
 ETransStatus DSU::b_transport(Axi4TransactionType *trans) {
     uint64_t mask = (length_.to_uint64() - 1);
     uint64_t off64 = (trans->addr - getBaseAddress()) & mask;
-    if (!icpu_) {
+    if (cpuTotal_ == 0) {
         trans->response = MemResp_Error;
         return TRANS_ERROR;
     }
@@ -82,7 +101,7 @@ ETransStatus DSU::nb_transport(Axi4TransactionType *trans,
                                IAxi4NbResponse *cb) {
     uint64_t mask = (length_.to_uint64() - 1);
     uint64_t off64 = (trans->addr - getBaseAddress()) & mask;
-    if (!icpu_) {
+    if (cpuTotal_ == 0) {
         trans->response = MemResp_Error;
         cb->nb_response(trans);
         return TRANS_ERROR;
@@ -104,23 +123,71 @@ ETransStatus DSU::nb_transport(Axi4TransactionType *trans,
     if (nb_trans_.dbg_trans.region == 3) {
         ret = b_transport(trans);
         cb->nb_response(trans);
+    } else if (nb_trans_.dbg_trans.region == 2
+            && nb_trans_.dbg_trans.write && cpuTotal_ > 1
+            && isBroadcast(nb_trans_.dbg_trans.addr)) {
+        nb_trans_.bcast_idx = 1;
+        icpu_[0]->nb_transport_debug_port(&nb_trans_.dbg_trans, this);
     } else {
-        icpu_->nb_transport_debug_port(&nb_trans_.dbg_trans, this);
+        icpu_[cpuContext_]->nb_transport_debug_port(&nb_trans_.dbg_trans,
+                                                    this);
     }
     return ret;
 }
 
+/**
+ * Run control, stepping and HW breakpoints are applied to all harts.
+ * Instruction injected instead of the SW breakpoint is skipped by the
+ * selected hart only.
+ */
+bool DSU::isBroadcast(uint16_t addr) {
+    static const uint64_t BCAST_REGS[] = {
+        DSUREG(udbg.v.control),
+        DSUREG(udbg.v.stepping_mode_steps),
+        DSUREG(udbg.v.br_ctrl),
+        DSUREG(udbg.v.add_breakpoint),
+        DSUREG(udbg.v.remove_breakpoint),
+        DSUREG(udbg.v.br_flush_addr)
+    };
+    for (unsigned i = 0; i < sizeof(BCAST_REGS)/sizeof(BCAST_REGS[0]); i++) {
+        if ((BCAST_REGS[i] & 0x7FFF) == addr) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void DSU::nb_response_debug_port(DebugPortTransactionType *trans) {
+    if (nb_trans_.bcast_idx > 0) {
+        int idx = nb_trans_.bcast_idx;
+        nb_trans_.bcast_idx = idx + 1 < cpuTotal_ ? idx + 1 : -1;
+        icpu_[idx]->nb_transport_debug_port(&nb_trans_.dbg_trans, this);
+        return;
+    }
     nb_trans_.p_axi_trans->response = MemResp_Valid;
     nb_trans_.p_axi_trans->rpayload.b64[0] = trans->rdata;
     nb_trans_.iaxi_cb->nb_response(nb_trans_.p_axi_trans);
 }
 
+const char *DSU::getContextCpuName() {
+    if (cpuTotal_ == 0) {
+        return "";
+    }
+    return cpu_.is_list() ? cpu_[cpuContext_].to_string()
+                          : cpu_.to_string();
+}
+
 void DSU::readLocal(uint64_t off, Axi4TransactionType *trans) {
     switch (off >> 3) {
     case 0:
         trans->rpayload.b64[0] = soft_reset_;
         break;
+    case 3:
+        trans->rpayload.b64[0] = cpuContext_;
+        break;
+    case 4:
+        trans->rpayload.b64[0] = cpuTotal_;
+        break;
     case 8:
         trans->rpayload.b64[0] = info_[0].w_cnt;
         break;
@@ -154,13 +221,16 @@ void DSU::writeLocal(uint64_t off, Axi4TransactionType *trans) {
     }
     switch (off >> 3) {
     case 0:     // soft reset
-        if (wdata64_ & 0x1) {
-            icpurst_->reset(true);
-        } else {
-            icpurst_->reset(false);
+        for (int i = 0; i < cpuTotal_; i++) {
+            icpurst_[i]->reset((wdata64_ & 0x1) != 0);
         }
         soft_reset_ = wdata64_;
         break;
+    case 3:
+        if (wdata64_ < static_cast<uint64_t>(cpuTotal_)) {
+            cpuContext_ = static_cast<int>(wdata64_);
+        }
+        break;
     default:;
     }
 }
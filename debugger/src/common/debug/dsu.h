@@ -53,16 +53,21 @@ class DSU : public IService,
     /** IDsuGeneric */
     virtual void incrementRdAccess(int mst_id);
     virtual void incrementWrAccess(int mst_id);
+    virtual const char *getContextCpuName();
 
  private:
+    bool isBroadcast(uint16_t addr);
     void readLocal(uint64_t off, Axi4TransactionType *trans);
     void writeLocal(uint64_t off, Axi4TransactionType *trans);
 
  private:
     AttributeType cpu_;
     AttributeType bus_;
-    ICpuGeneric *icpu_;
-    IResetListener *icpurst_;
+    static const int CPU_MAX = 16;
+    ICpuGeneric *icpu_[CPU_MAX];
+    IResetListener *icpurst_[CPU_MAX];
+    int cpuTotal_;
+    int cpuContext_;        // hart accessed via regions 0..2
     IMemoryOperation *ibus_;
     uint64_t shifter32_;
     uint64_t wdata64_;
@@ -72,6 +77,7 @@ class DSU : public IService,
         Axi4TransactionType *p_axi_trans;
         IAxi4NbResponse *iaxi_cb;
         DebugPortTransactionType dbg_trans;
+        int bcast_idx;      // next hart of the broadcast or -1
     } nb_trans_;
 
     static const int BUS_MASTERS_MAX = 64;
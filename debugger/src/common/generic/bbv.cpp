@@ -0,0 +1,326 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include "bbv.h"
+
+namespace debugger {
+
+BbvWriter::BbvWriter() {
+    fp_ = 0;
+    interval_ = 0;
+    startStep_ = 0;
+    nextStep_ = ~0ull;
+    hashSize_ = 1 << 12;
+    hashPc_ = new uint64_t[hashSize_];
+    hashIdx_ = new unsigned[hashSize_];
+    memset(hashIdx_, 0xFF, hashSize_ * sizeof(unsigned));
+    blocks_ = 0;
+    countsMax_ = 1 << 10;
+    counts_ = new uint64_t[countsMax_];
+    touched_ = new unsigned[countsMax_];
+    memset(counts_, 0, countsMax_ * sizeof(uint64_t));
+    touchedCnt_ = 0;
+}
+
+BbvWriter::~BbvWriter() {
+    if (fp_) {
+        fclose(fp_);
+    }
+    delete [] hashPc_;
+    delete [] hashIdx_;
+    delete [] counts_;
+    delete [] touched_;
+}
+
+bool BbvWriter::open(const char *filename, uint64_t interval, uint64_t step) {
+    if (interval == 0) {
+        return false;
+    }
+    fp_ = fopen(filename, "wb");
+    if (fp_ == 0) {
+        return false;
+    }
+    uint32_t hdr[2];
+    uint64_t hdr64[2];
+    hdr[0] = BBV_VERSION;
+    hdr[1] = 0;
+    hdr64[0] = interval;
+    hdr64[1] = step;
+    fwrite(BBV_MAGIC, 1, sizeof(BBV_MAGIC), fp_);
+    fwrite(hdr, 1, sizeof(hdr), fp_);
+    fwrite(hdr64, 1, sizeof(hdr64), fp_);
+    interval_ = interval;
+    startStep_ = step;
+    nextStep_ = step + interval;
+    return true;
+}
+
+void BbvWriter::close(uint64_t step) {
+    if (fp_ == 0) {
+        return;
+    }
+    if (step > startStep_) {
+        writeInterval(step);
+    }
+    fclose(fp_);
+    fp_ = 0;
+    nextStep_ = ~0ull;
+}
+
+void BbvWriter::addCount(uint64_t pc, uint64_t cnt) {
+    if (cnt == 0) {
+        return;
+    }
+    unsigned idx = blockIndex(pc);
+    if (counts_[idx] == 0) {
+        touched_[touchedCnt_++] = idx;
+    }
+    counts_[idx] += cnt;
+}
+
+unsigned BbvWriter::blockIndex(uint64_t pc) {
+    unsigned mask = hashSize_ - 1;
+    unsigned h = static_cast<unsigned>((pc * 0x9E3779B97F4A7C15ull) >> 40);
+    while (hashIdx_[h & mask] != ~0u) {
+        if (hashPc_[h & mask] == pc) {
+            return hashIdx_[h & mask];
+        }
+        h++;
+    }
+
+    // New block: keep the table at most half full
+    if (2 * (blocks_ + 1) > hashSize_) {
+        uint64_t *oldPc = hashPc_;
+        unsigned *oldIdx = hashIdx_;
+        unsigned oldSize = hashSize_;
+        hashSize_ *= 2;
+        hashPc_ = new uint64_t[hashSize_];
+        hashIdx_ = new unsigned[hashSize_];
+        memset(hashIdx_, 0xFF, hashSize_ * sizeof(unsigned));
+        mask = hashSize_ - 1;
+        for (unsigned i = 0; i < oldSize; i++) {
+            if (oldIdx[i] == ~0u) {
+                continue;
+            }
+            unsigned n = static_cast<unsigned>(
+                (oldPc[i] * 0x9E3779B97F4A7C15ull) >> 40);
+            while (hashIdx_[n & mask] != ~0u) {
+                n++;
+            }
+            hashPc_[n & mask] = oldPc[i];
+            hashIdx_[n & mask] = oldIdx[i];
+        }
+        delete [] oldPc;
+        delete [] oldIdx;
+        h = static_cast<unsigned>((pc * 0x9E3779B97F4A7C15ull) >> 40);
+        while (hashIdx_[h & mask] != ~0u) {
+            h++;
+        }
+    }
+    if (blocks_ == countsMax_) {
+        uint64_t *oldCounts = counts_;
+        unsigned *oldTouched = touched_;
+        countsMax_ *= 2;
+        counts_ = new uint64_t[countsMax_];
+        touched_ = new unsigned[countsMax_];
+        memset(counts_, 0, countsMax_ * sizeof(uint64_t));
+        memcpy(counts_, oldCounts, blocks_ * sizeof(uint64_t));
+        memcpy(touched_, oldTouched, touchedCnt_ * sizeof(unsigned));
+        delete [] oldCounts;
+        delete [] oldTouched;
+    }
+    hashPc_[h & mask] = pc;
+    hashIdx_[h & mask] = blocks_;
+
+    fputc(BbvRecord_Block, fp_);
+    putVarint(pc);
+    return blocks_++;
+}
+
+void BbvWriter::writeInterval(uint64_t step) {
+    fputc(BbvRecord_Interval, fp_);
+    putVarint(step - startStep_);
+    putVarint(touchedCnt_);
+    for (unsigned i = 0; i < touchedCnt_; i++) {
+        unsigned idx = touched_[i];
+        putVarint(idx);
+        putVarint(counts_[idx]);
+        counts_[idx] = 0;
+    }
+    touchedCnt_ = 0;
+    // Intervals can be clustered while simulation is running
+    fflush(fp_);
+    startStep_ = step;
+    nextStep_ = step + interval_;
+}
+
+void BbvWriter::putVarint(uint64_t v) {
+    while (v >= 0x80) {
+        fputc(static_cast<int>((v & 0x7F) | 0x80), fp_);
+        v >>= 7;
+    }
+    fputc(static_cast<int>(v), fp_);
+}
+
+
+BbvReader::BbvReader() {
+    interval_ = 0;
+    blocks_ = 0;
+    total_ = 0;
+    start_ = 0;
+    steps_ = 0;
+    offset_ = 0;
+    idx_ = 0;
+    cnt_ = 0;
+}
+
+BbvReader::~BbvReader() {
+    clear();
+}
+
+void BbvReader::clear() {
+    delete [] start_;
+    delete [] steps_;
+    delete [] offset_;
+    delete [] idx_;
+    delete [] cnt_;
+    start_ = 0;
+    steps_ = 0;
+    offset_ = 0;
+    idx_ = 0;
+    cnt_ = 0;
+    blocks_ = 0;
+    total_ = 0;
+}
+
+static bool bbv_get_varint(const uint8_t *buf, unsigned sz, unsigned *pos,
+                           uint64_t *v) {
+    int shift = 0;
+    *v = 0;
+    while (*pos < sz && shift < 64) {
+        uint8_t b = buf[(*pos)++];
+        *v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+/**
+ * File is parsed twice: the first pass counts intervals and entries. The
+ * incomplete record at the end of file (simulation still running) is
+ * ignored.
+ */
+const char *BbvReader::load(const char *filename) {
+    char magic[sizeof(BBV_MAGIC)];
+    uint32_t hdr[2];
+    uint64_t hdr64[2];
+
+    clear();
+    FILE *fp = fopen(filename, "rb");
+    if (fp == 0) {
+        return "Can't open basic block vectors file";
+    }
+    if (fread(magic, 1, sizeof(magic), fp) != sizeof(magic)
+        || memcmp(magic, BBV_MAGIC, sizeof(magic)) != 0
+        || fread(hdr, 1, sizeof(hdr), fp) != sizeof(hdr)
+        || hdr[0] != BBV_VERSION
+        || fread(hdr64, 1, sizeof(hdr64), fp) != sizeof(hdr64)) {
+        fclose(fp);
+        return "Wrong basic block vectors header";
+    }
+    long pos0 = ftell(fp);
+    fseek(fp, 0, SEEK_END);
+    unsigned sz = static_cast<unsigned>(ftell(fp) - pos0);
+    fseek(fp, pos0, SEEK_SET);
+    uint8_t *buf = new uint8_t[sz + 1];
+    sz = static_cast<unsigned>(fread(buf, 1, sz, fp));
+    fclose(fp);
+
+    interval_ = hdr64[0];
+    unsigned entries = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        unsigned pos = 0;
+        unsigned blocks = 0;
+        unsigned total = 0;
+        unsigned ecnt = 0;
+        uint64_t step = hdr64[1];
+        uint64_t v, n, idx, cnt;
+        while (pos < sz) {
+            uint8_t type = buf[pos++];
+            if (type == BbvRecord_Block) {
+                if (!bbv_get_varint(buf, sz, &pos, &v)) {
+                    break;
+                }
+                blocks++;
+            } else if (type == BbvRecord_Interval) {
+                if (!bbv_get_varint(buf, sz, &pos, &v)
+                    || !bbv_get_varint(buf, sz, &pos, &n)) {
+                    break;
+                }
+                uint64_t i = 0;
+                for (; i < n; i++) {
+                    if (!bbv_get_varint(buf, sz, &pos, &idx)
+                        || !bbv_get_varint(buf, sz, &pos, &cnt)
+                        || idx >= blocks) {
+                        break;
+                    }
+                    if (pass == 1) {
+                        idx_[ecnt + i] = static_cast<unsigned>(idx);
+                        cnt_[ecnt + i] = cnt;
+                    }
+                }
+                if (i != n) {
+                    break;
+                }
+                if (pass == 1) {
+                    start_[total] = step;
+                    steps_[total] = v;
+                    offset_[total] = ecnt;
+                }
+                ecnt += static_cast<unsigned>(n);
+                step += v;
+                total++;
+                if (pass == 1 && total == total_) {
+                    break;
+                }
+            } else {
+                break;
+            }
+        }
+        if (pass == 0) {
+            total_ = total;
+            blocks_ = blocks;
+            entries = ecnt;
+            start_ = new uint64_t[total + 1];
+            steps_ = new uint64_t[total + 1];
+            offset_ = new unsigned[total + 1];
+            idx_ = new unsigned[entries + 1];
+            cnt_ = new uint64_t[entries + 1];
+        }
+    }
+    offset_[total_] = entries;
+    delete [] buf;
+    if (total_ == 0) {
+        return "No intervals in basic block vectors file";
+    }
+    return 0;
+}
+
+}  // namespace debugger
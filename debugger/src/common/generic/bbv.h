@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_COMMON_GENERIC_BBV_H__
+#define __DEBUGGER_COMMON_GENERIC_BBV_H__
+
+#include <stdio.h>
+#include <inttypes.h>
+
+namespace debugger {
+
+/**
+ * Basic block vectors file:
+ *   header:  "RVBBV\0\0\0", uint32 version, uint32 reserved,
+ *            uint64 interval length, uint64 step of the first interval;
+ *   records: uint8 type and fields, 'varint' is LEB128:
+ *     BbvRecord_Block:     varint pc. Blocks are numbered from 0 in the
+ *                          order of their records;
+ *     BbvRecord_Interval:  varint executed steps, varint entries total,
+ *                          entries of varint block index and varint number
+ *                          of instructions executed in this block.
+ * Block is the sequence of instructions executed without control transfer
+ * and it's identified by the address of its first instruction. The last
+ * interval can be shorter than the interval length.
+ */
+static const char BBV_MAGIC[8] = {'R', 'V', 'B', 'B', 'V', 0, 0, 0};
+static const uint32_t BBV_VERSION = 1;
+
+enum EBbvRecord {
+    BbvRecord_Block = 1,
+    BbvRecord_Interval
+};
+
+/**
+ * @brief Basic block vectors writer.
+ *
+ * Called by CPU thread on each control transfer. The instruction counters
+ * are collected until the interval boundary is crossed, so the intervals
+ * boundaries are exact regardless of the blocks length.
+ */
+class BbvWriter {
+ public:
+    BbvWriter();
+    ~BbvWriter();
+
+    bool open(const char *filename, uint64_t interval, uint64_t step);
+    /** Write the last incomplete interval and close file */
+    void close(uint64_t step);
+
+    /** Account instructions of steps [start, end) executed from 'pc' */
+    void addRun(uint64_t pc, uint64_t start, uint64_t end) {
+        while (end >= nextStep_) {
+            addCount(pc, nextStep_ - start);
+            start = nextStep_;
+            writeInterval(start);
+        }
+        addCount(pc, end - start);
+    }
+
+ private:
+    void addCount(uint64_t pc, uint64_t cnt);
+    unsigned blockIndex(uint64_t pc);
+    void writeInterval(uint64_t step);
+    void putVarint(uint64_t v);
+
+ private:
+    FILE *fp_;
+    uint64_t interval_;
+    uint64_t startStep_;            // first step of the current interval
+    uint64_t nextStep_;             // first step of the next interval
+
+    // Open addressing table pc -> block index
+    uint64_t *hashPc_;
+    unsigned *hashIdx_;
+    unsigned hashSize_;             // power of 2
+    unsigned blocks_;
+
+    uint64_t *counts_;              // [block index] of the current interval
+    unsigned countsMax_;
+    unsigned *touched_;             // blocks with non-zero counters
+    unsigned touchedCnt_;
+};
+
+/**
+ * @brief Basic block vectors file loaded into memory.
+ */
+class BbvReader {
+ public:
+    BbvReader();
+    ~BbvReader();
+
+    /** @return NULL on success or error description */
+    const char *load(const char *filename);
+
+    uint64_t intervalLength() { return interval_; }
+    unsigned blocks() { return blocks_; }
+    unsigned intervals() { return total_; }
+    uint64_t startStep(unsigned i) { return start_[i]; }
+    uint64_t steps(unsigned i) { return steps_[i]; }
+    /** Entries of interval 'i' are [entryBegin(i), entryBegin(i + 1)) */
+    unsigned entryBegin(unsigned i) { return offset_[i]; }
+    unsigned entryBlock(unsigned e) { return idx_[e]; }
+    uint64_t entryCount(unsigned e) { return cnt_[e]; }
+
+ private:
+    void clear();
+
+ private:
+    uint64_t interval_;
+    unsigned blocks_;
+    unsigned total_;
+    uint64_t *start_;
+    uint64_t *steps_;
+    unsigned *offset_;              // [total_ + 1]
+    unsigned *idx_;
+    uint64_t *cnt_;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_GENERIC_BBV_H__
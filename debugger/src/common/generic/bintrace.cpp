@@ -0,0 +1,533 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include "bintrace.h"
+
+namespace debugger {
+
+/**
+ * Block compression: LZ77 sequences of literals and matches in the 64 KB
+ * window. Token is [7:4] literals length, [3:0] match length - 4, the
+ * value 15 is extended by the following bytes until byte != 255. The last
+ * sequence contains literals only.
+ */
+static const int LZ_MIN_MATCH = 4;
+static const int LZ_HASH_BITS = 12;
+static const unsigned LZ_WINDOW = 0xFFFF;
+
+static unsigned lz_read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static bool lz_put_length(uint8_t *dst, unsigned *pos, unsigned max,
+                          unsigned len) {
+    while (len >= 255) {
+        if (*pos >= max) {
+            return false;
+        }
+        dst[(*pos)++] = 255;
+        len -= 255;
+    }
+    if (*pos >= max) {
+        return false;
+    }
+    dst[(*pos)++] = static_cast<uint8_t>(len);
+    return true;
+}
+
+static bool lz_put_sequence(uint8_t *dst, unsigned *pos, unsigned max,
+                            const uint8_t *lit, unsigned litlen,
+                            unsigned offset, unsigned mlen) {
+    unsigned ml = mlen ? mlen - LZ_MIN_MATCH : 0;
+    if (*pos >= max) {
+        return false;
+    }
+    dst[(*pos)++] = static_cast<uint8_t>(((litlen < 15 ? litlen : 15) << 4)
+                                         | (ml < 15 ? ml : 15));
+    if (litlen >= 15 && !lz_put_length(dst, pos, max, litlen - 15)) {
+        return false;
+    }
+    if (*pos + litlen > max) {
+        return false;
+    }
+    memcpy(&dst[*pos], lit, litlen);
+    *pos += litlen;
+    if (mlen == 0) {
+        return true;
+    }
+    if (*pos + 2 > max) {
+        return false;
+    }
+    dst[(*pos)++] = static_cast<uint8_t>(offset);
+    dst[(*pos)++] = static_cast<uint8_t>(offset >> 8);
+    if (ml >= 15 && !lz_put_length(dst, pos, max, ml - 15)) {
+        return false;
+    }
+    return true;
+}
+
+/** @return compressed size or 0 if data isn't compressible */
+static unsigned lz_compress(const uint8_t *src, unsigned sz,
+                            uint8_t *dst, unsigned max) {
+    int htbl[1 << LZ_HASH_BITS];
+    unsigned pos = 0;
+    unsigned anchor = 0;
+    unsigned i = 0;
+    memset(htbl, 0xFF, sizeof(htbl));
+    while (i + LZ_MIN_MATCH < sz) {
+        uint32_t v = lz_read32(&src[i]);
+        unsigned h = (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+        int ref = htbl[h];
+        htbl[h] = static_cast<int>(i);
+        if (ref < 0 || i - ref > LZ_WINDOW || lz_read32(&src[ref]) != v) {
+            i++;
+            continue;
+        }
+        unsigned mlen = LZ_MIN_MATCH;
+        while (i + mlen < sz && src[ref + mlen] == src[i + mlen]) {
+            mlen++;
+        }
+        if (!lz_put_sequence(dst, &pos, max, &src[anchor], i - anchor,
+                             i - ref, mlen)) {
+            return 0;
+        }
+        i += mlen;
+        anchor = i;
+    }
+    if (!lz_put_sequence(dst, &pos, max, &src[anchor], sz - anchor, 0, 0)) {
+        return 0;
+    }
+    return pos;
+}
+
+static bool lz_get_length(const uint8_t *src, unsigned *pos, unsigned sz,
+                          unsigned *len) {
+    uint8_t t;
+    do {
+        if (*pos >= sz) {
+            return false;
+        }
+        t = src[(*pos)++];
+        *len += t;
+    } while (t == 255);
+    return true;
+}
+
+static bool lz_decompress(const uint8_t *src, unsigned sz,
+                          uint8_t *dst, unsigned rawsz) {
+    unsigned pos = 0;
+    unsigned out = 0;
+    while (pos < sz) {
+        uint8_t token = src[pos++];
+        unsigned litlen = token >> 4;
+        if (litlen == 15 && !lz_get_length(src, &pos, sz, &litlen)) {
+            return false;
+        }
+        if (pos + litlen > sz || out + litlen > rawsz) {
+            return false;
+        }
+        memcpy(&dst[out], &src[pos], litlen);
+        pos += litlen;
+        out += litlen;
+        if (pos == sz) {
+            break;
+        }
+        if (pos + 2 > sz) {
+            return false;
+        }
+        unsigned offset = src[pos] | (src[pos + 1] << 8);
+        pos += 2;
+        unsigned mlen = token & 0xF;
+        if (mlen == 15 && !lz_get_length(src, &pos, sz, &mlen)) {
+            return false;
+        }
+        mlen += LZ_MIN_MATCH;
+        if (offset == 0 || offset > out || out + mlen > rawsz) {
+            return false;
+        }
+        // Overlapped copy is allowed
+        for (unsigned i = 0; i < mlen; i++, out++) {
+            dst[out] = dst[out - offset];
+        }
+    }
+    return out == rawsz;
+}
+
+BinTraceWriter::BinTraceWriter(IFace *parent) : IThread() {
+    parent_ = parent;
+    fp_ = 0;
+    compress_ = false;
+    regTotal_ = 0;
+    for (unsigned i = 0; i < BLOCK_TOTAL; i++) {
+        blocks_[i] = 0;
+        blockSize_[i] = 0;
+    }
+    wrIdx_ = 0;
+    rdIdx_ = 0;
+    wrbuf_ = 0;
+    fill_ = 0;
+    lastStep_ = 0;
+    lastPc_ = 0;
+    packbuf_ = 0;
+    AttributeType t1;
+    RISCV_generate_name(&t1);
+    RISCV_event_create(&eventData_, t1.to_string());
+}
+
+BinTraceWriter::~BinTraceWriter() {
+    close();
+    RISCV_event_close(&eventData_);
+}
+
+bool BinTraceWriter::open(const char *filename, bool compress,
+                          const char *const *regnames, int regtotal) {
+    if (regtotal > BINTRACE_REGS_MAX) {
+        RISCV_error("Too many registers in trace: %d", regtotal);
+        return false;
+    }
+    fp_ = fopen(filename, "wb");
+    if (fp_ == 0) {
+        RISCV_error("Can't open trace file %s", filename);
+        return false;
+    }
+    compress_ = compress;
+    regTotal_ = regtotal;
+
+    uint32_t hdr[3];
+    hdr[0] = BINTRACE_VERSION;
+    hdr[1] = compress ? BINTRACE_FLAG_COMPRESS : 0;
+    hdr[2] = static_cast<uint32_t>(regtotal);
+    fwrite(BINTRACE_MAGIC, 1, sizeof(BINTRACE_MAGIC), fp_);
+    fwrite(hdr, 1, sizeof(hdr), fp_);
+    for (int i = 0; i < regtotal; i++) {
+        fwrite(regnames[i], 1, strlen(regnames[i]) + 1, fp_);
+    }
+
+    for (unsigned i = 0; i < BLOCK_TOTAL; i++) {
+        blocks_[i] = new uint8_t[BLOCK_SIZE];
+    }
+    packbuf_ = new uint8_t[BLOCK_SIZE];
+    wrbuf_ = blocks_[0];
+    fill_ = 0;
+    if (!run()) {
+        RISCV_error("Can't create trace thread", NULL);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void BinTraceWriter::close() {
+    if (fp_ == 0) {
+        return;
+    }
+    publish();
+    stop();
+    // Thread wasn't started or was stopped before draining the blocks
+    while (rdIdx_ != wrIdx_) {
+        unsigned idx = rdIdx_ % BLOCK_TOTAL;
+        writeBlock(blocks_[idx], blockSize_[idx]);
+        rdIdx_ = rdIdx_ + 1;
+    }
+    fclose(fp_);
+    fp_ = 0;
+    for (unsigned i = 0; i < BLOCK_TOTAL; i++) {
+        delete [] blocks_[i];
+        blocks_[i] = 0;
+    }
+    delete [] packbuf_;
+    packbuf_ = 0;
+    wrbuf_ = 0;
+}
+
+void BinTraceWriter::traceRegs(uint64_t step, uint64_t pc,
+                               uint64_t *saved, const uint64_t *cur) {
+    uint64_t mask = 0;
+    for (int i = 0; i < regTotal_; i++) {
+        if (saved[i] != cur[i]) {
+            mask |= 1ull << i;
+        }
+    }
+    uint8_t *p = reserve(RECORD_SIZE_MAX);
+    p[fill_++] = BinTrace_Regs;
+    putDelta(step, pc);
+    putVarint(mask);
+    for (int i = 0; mask; i++, mask >>= 1) {
+        if (mask & 0x1) {
+            memcpy(&p[fill_], &cur[i], sizeof(uint64_t));
+            fill_ += sizeof(uint64_t);
+            saved[i] = cur[i];
+        }
+    }
+}
+
+void BinTraceWriter::traceMem(uint64_t step, uint64_t pc,
+                              Axi4TransactionType *tr) {
+    uint64_t data;
+    uint8_t *p = reserve(RECORD_SIZE_MAX);
+    if (tr->action == MemAction_Read) {
+        p[fill_++] = BinTrace_MemRead;
+        data = tr->rpayload.b64[0];
+    } else {
+        p[fill_++] = BinTrace_MemWrite;
+        data = tr->wpayload.b64[0];
+    }
+    // Bytes above the access size aren't defined
+    if (tr->xsize < 8) {
+        data &= (1ull << (8 * tr->xsize)) - 1;
+    }
+    putDelta(step, pc);
+    putVarint(tr->addr);
+    p[fill_++] = static_cast<uint8_t>(tr->xsize);
+    putVarint(data);
+}
+
+uint8_t *BinTraceWriter::reserve(unsigned sz) {
+    if (fill_ + sz > BLOCK_SIZE) {
+        publish();
+    }
+    return wrbuf_;
+}
+
+void BinTraceWriter::publish() {
+    if (fill_ == 0) {
+        return;
+    }
+    blockSize_[wrIdx_ % BLOCK_TOTAL] = fill_;
+    RISCV_memory_barrier();
+    wrIdx_ = wrIdx_ + 1;
+    RISCV_event_set(&eventData_);
+
+    // Wait while writer releases the next block
+    while (wrIdx_ - rdIdx_ >= BLOCK_TOTAL) {
+        RISCV_sleep_ms(1);
+    }
+    wrbuf_ = blocks_[wrIdx_ % BLOCK_TOTAL];
+    fill_ = 0;
+}
+
+bool BinTraceWriter::run() {
+    // Loop must be enabled before the thread starts otherwise it may exit
+    // immediately and the CPU thread would wait for free blocks forever
+    RISCV_event_set(&loopEnable_);
+    IThread::run();
+    if (!threadInit_.Handle) {
+        RISCV_event_clear(&loopEnable_);
+        return false;
+    }
+    return true;
+}
+
+void BinTraceWriter::busyLoop() {
+    while (isEnabled() || rdIdx_ != wrIdx_) {
+        if (rdIdx_ == wrIdx_) {
+            RISCV_event_wait_ms(&eventData_, 10);
+            RISCV_event_clear(&eventData_);
+            continue;
+        }
+        RISCV_memory_barrier();
+        unsigned idx = rdIdx_ % BLOCK_TOTAL;
+        writeBlock(blocks_[idx], blockSize_[idx]);
+        RISCV_memory_barrier();
+        rdIdx_ = rdIdx_ + 1;
+    }
+}
+
+void BinTraceWriter::writeBlock(const uint8_t *buf, unsigned sz) {
+    uint32_t hdr[2];
+    const uint8_t *data = buf;
+    hdr[0] = sz;
+    hdr[1] = sz;
+    if (compress_) {
+        unsigned packed = lz_compress(buf, sz, packbuf_, sz - 1);
+        if (packed) {
+            hdr[1] = packed;
+            data = packbuf_;
+        }
+    }
+    fwrite(hdr, 1, sizeof(hdr), fp_);
+    fwrite(data, 1, hdr[1], fp_);
+}
+
+static bool get_varint(const uint8_t *buf, unsigned sz, unsigned *pos,
+                       uint64_t *v) {
+    int shift = 0;
+    *v = 0;
+    while (*pos < sz && shift < 64) {
+        uint8_t t = buf[(*pos)++];
+        *v |= static_cast<uint64_t>(t & 0x7F) << shift;
+        if ((t & 0x80) == 0) {
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+const char *convertBinTrace(const char *binfile, const char *regfile,
+                            const char *memfile) {
+    const char *err = 0;
+    char regnames[BINTRACE_REGS_MAX][16];
+    char magic[sizeof(BINTRACE_MAGIC)];
+    uint32_t hdr[3];
+    FILE *fr = 0;
+    FILE *fm = 0;
+    uint8_t *raw = 0;
+    uint8_t *packed = 0;
+    uint64_t step = 0;
+    uint64_t pc = 0;
+    char tstr[2048];
+    int sz;
+
+    FILE *fp = fopen(binfile, "rb");
+    if (fp == 0) {
+        return "Can't open binary trace file";
+    }
+    if (fread(magic, 1, sizeof(magic), fp) != sizeof(magic)
+        || memcmp(magic, BINTRACE_MAGIC, sizeof(magic)) != 0
+        || fread(hdr, 1, sizeof(hdr), fp) != sizeof(hdr)
+        || hdr[0] != BINTRACE_VERSION
+        || hdr[2] > static_cast<uint32_t>(BINTRACE_REGS_MAX)) {
+        fclose(fp);
+        return "Wrong binary trace header";
+    }
+    for (uint32_t i = 0; i < hdr[2]; i++) {
+        int c;
+        unsigned n = 0;
+        while ((c = fgetc(fp)) > 0) {
+            if (n < sizeof(regnames[i]) - 1) {
+                regnames[i][n++] = static_cast<char>(c);
+            }
+        }
+        regnames[i][n] = '\0';
+        if (c < 0) {
+            fclose(fp);
+            return "Wrong binary trace header";
+        }
+    }
+
+    if (regfile && (fr = fopen(regfile, "w")) == 0) {
+        err = "Can't create registers trace file";
+    }
+    if (!err && memfile && (fm = fopen(memfile, "w")) == 0) {
+        err = "Can't create memory trace file";
+    }
+
+    uint32_t blk[2];
+    unsigned rawmax = 0;
+    while (!err && fread(blk, 1, sizeof(blk), fp) == sizeof(blk)) {
+        if (blk[1] > blk[0] || blk[0] > (1u << 30)) {
+            err = "Wrong block size";
+            break;
+        }
+        if (blk[0] > rawmax) {
+            delete [] raw;
+            delete [] packed;
+            rawmax = blk[0];
+            raw = new uint8_t[rawmax];
+            packed = new uint8_t[rawmax];
+        }
+        if (blk[1] == blk[0]) {
+            if (fread(raw, 1, blk[0], fp) != blk[0]) {
+                err = "Unexpected end of file";
+                break;
+            }
+        } else if (fread(packed, 1, blk[1], fp) != blk[1]
+                || !lz_decompress(packed, blk[1], raw, blk[0])) {
+            err = "Can't decompress block";
+            break;
+        }
+
+        unsigned pos = 0;
+        uint64_t dstep, dpc, addr, mask, data;
+        while (!err && pos < blk[0]) {
+            uint8_t tag = raw[pos++];
+            if (!get_varint(raw, blk[0], &pos, &dstep)
+                || !get_varint(raw, blk[0], &pos, &dpc)) {
+                err = "Wrong record";
+                break;
+            }
+            step += dstep;
+            pc += (dpc >> 1) ^ (~(dpc & 1) + 1);
+
+            if (tag == BinTrace_Regs) {
+                if (!get_varint(raw, blk[0], &pos, &mask)) {
+                    err = "Wrong record";
+                    break;
+                }
+                sz = RISCV_sprintf(tstr, sizeof(tstr), "%8I64d [%08x]: ",
+                                   step, static_cast<uint32_t>(pc));
+                if (mask == 0) {
+                    sz += RISCV_sprintf(&tstr[sz], sizeof(tstr) - sz,
+                                        "-", NULL);
+                }
+                for (uint32_t i = 0; mask; i++, mask >>= 1) {
+                    if ((mask & 0x1) == 0) {
+                        continue;
+                    }
+                    if (i >= hdr[2] || pos + sizeof(uint64_t) > blk[0]) {
+                        err = "Wrong register record";
+                        break;
+                    }
+                    memcpy(&data, &raw[pos], sizeof(uint64_t));
+                    pos += sizeof(uint64_t);
+                    sz += RISCV_sprintf(&tstr[sz], sizeof(tstr) - sz,
+                                        "%3s <= %016I64x", regnames[i], data);
+                }
+                if (fr) {
+                    fprintf(fr, "%s\n", tstr);
+                }
+            } else if (tag == BinTrace_MemRead || tag == BinTrace_MemWrite) {
+                if (!get_varint(raw, blk[0], &pos, &addr)
+                    || pos >= blk[0]) {
+                    err = "Wrong memory record";
+                    break;
+                }
+                pos++;      // access size isn't used in the text format
+                if (!get_varint(raw, blk[0], &pos, &data)) {
+                    err = "Wrong memory record";
+                    break;
+                }
+                if (fm) {
+                    fprintf(fm, "%08x %08x: [%08x] %s %016" RV_PRI64 "x\n",
+                            static_cast<int>(step),
+                            static_cast<uint32_t>(pc),
+                            static_cast<int>(addr),
+                            tag == BinTrace_MemRead ? "=>" : "<=",
+                            data);
+                }
+            } else {
+                err = "Unknown record";
+            }
+        }
+    }
+
+    delete [] raw;
+    delete [] packed;
+    if (fr) {
+        fclose(fr);
+    }
+    if (fm) {
+        fclose(fm);
+    }
+    fclose(fp);
+    return err;
+}
+
+}  // namespace debugger
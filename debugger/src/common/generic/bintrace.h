@@ -0,0 +1,138 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_COMMON_GENERIC_BINTRACE_H__
+#define __DEBUGGER_COMMON_GENERIC_BINTRACE_H__
+
+#include <stdio.h>
+#include <api_core.h>
+#include <iservice.h>
+#include "coreservices/ithread.h"
+#include "coreservices/imemop.h"
+
+namespace debugger {
+
+/**
+ * Binary trace file:
+ *   header:  "RVTRACE\0", uint32 version, uint32 flags, uint32 regs total,
+ *            zero-terminated register names;
+ *   blocks:  uint32 raw size, uint32 stored size, data. Block is compressed
+ *            when the stored size is less than the raw size.
+ * Records never cross the block boundary. All values are little-endian,
+ * 'varint' is LEB128, step and pc are delta-encoded relative to the
+ * previous record (pc delta is zigzag-encoded):
+ *   BinTrace_Regs:     varint step, varint pc, varint changed regs mask,
+ *                      uint64 value of each changed register;
+ *   BinTrace_MemRead,
+ *   BinTrace_MemWrite: varint step, varint pc, varint addr, uint8 size,
+ *                      varint data.
+ */
+static const char BINTRACE_MAGIC[8] = {'R', 'V', 'T', 'R', 'A', 'C', 'E', 0};
+static const uint32_t BINTRACE_VERSION = 1;
+static const uint32_t BINTRACE_FLAG_COMPRESS = 0x1;
+static const int BINTRACE_REGS_MAX = 64;
+
+enum EBinTraceRecord {
+    BinTrace_Regs = 1,
+    BinTrace_MemRead,
+    BinTrace_MemWrite
+};
+
+/**
+ * @brief Binary trace writer.
+ *
+ * CPU thread puts records into the ring of blocks without locking, the
+ * own thread compresses and writes the filled blocks into the file.
+ */
+class BinTraceWriter : public IThread {
+ public:
+    explicit BinTraceWriter(IFace *parent);
+    virtual ~BinTraceWriter();
+
+    bool open(const char *filename, bool compress,
+              const char *const *regnames, int regtotal);
+    /** Flush all records and close file */
+    void close();
+
+    /** Write registers changed since the previous call and update 'saved' */
+    void traceRegs(uint64_t step, uint64_t pc,
+                   uint64_t *saved, const uint64_t *cur);
+    void traceMem(uint64_t step, uint64_t pc, Axi4TransactionType *tr);
+
+    IFace *getInterface(const char *name) { return parent_; }
+
+ protected:
+    /** IThread interface */
+    virtual bool run();
+    virtual void busyLoop();
+
+ private:
+    uint8_t *reserve(unsigned sz);
+    void publish();
+    void writeBlock(const uint8_t *buf, unsigned sz);
+
+    void putVarint(uint64_t v) {
+        while (v >= 0x80) {
+            wrbuf_[fill_++] = static_cast<uint8_t>(v | 0x80);
+            v >>= 7;
+        }
+        wrbuf_[fill_++] = static_cast<uint8_t>(v);
+    }
+    void putDelta(uint64_t step, uint64_t pc) {
+        int64_t dpc = static_cast<int64_t>(pc - lastPc_);
+        putVarint(step - lastStep_);
+        putVarint((static_cast<uint64_t>(dpc) << 1)
+                 ^ static_cast<uint64_t>(dpc >> 63));
+        lastStep_ = step;
+        lastPc_ = pc;
+    }
+
+ private:
+    static const unsigned BLOCK_SIZE = 1 << 18;
+    static const unsigned BLOCK_TOTAL = 16;
+    static const unsigned RECORD_SIZE_MAX = 32 + 8*BINTRACE_REGS_MAX;
+
+    IFace *parent_;
+    FILE *fp_;
+    bool compress_;
+    int regTotal_;
+
+    uint8_t *blocks_[BLOCK_TOTAL];
+    unsigned blockSize_[BLOCK_TOTAL];
+    volatile unsigned wrIdx_;       // modified only by CPU thread
+    volatile unsigned rdIdx_;       // modified only by writer thread
+    event_def eventData_;
+
+    uint8_t *wrbuf_;                // currently filled block
+    unsigned fill_;
+    uint64_t lastStep_;
+    uint64_t lastPc_;
+    uint8_t *packbuf_;
+};
+
+/**
+ * Convert binary trace into the text files generated by the attributes
+ * GenerateRegTraceFile and GenerateMemTraceFile. Output file name can be
+ * NULL to skip records.
+ *
+ * @return NULL on success or error description
+ */
+const char *convertBinTrace(const char *binfile, const char *regfile,
+                            const char *memfile);
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_GENERIC_BINTRACE_H__
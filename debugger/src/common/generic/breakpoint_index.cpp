@@ -0,0 +1,108 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <string.h>
+#include "breakpoint_index.h"
+
+namespace debugger {
+
+BreakpointIndex::BreakpointIndex() {
+    addr_ = 0;
+    cnt_ = max_ = 0;
+    hash_ = 0;
+    hashMax_ = 0;
+    memset(filter_, 0, sizeof(filter_));
+}
+
+BreakpointIndex::~BreakpointIndex() {
+    delete [] addr_;
+    delete [] hash_;
+}
+
+void BreakpointIndex::clear() {
+    cnt_ = 0;
+    rebuild();
+}
+
+int BreakpointIndex::find(uint64_t addr) {
+    if (cnt_ == 0) {
+        return -1;
+    }
+    unsigned h = slot(addr);
+    while (hash_[h] >= 0) {
+        if (addr_[hash_[h]] == addr) {
+            return hash_[h];
+        }
+        h = (h + 1) & (hashMax_ - 1);
+    }
+    return -1;
+}
+
+bool BreakpointIndex::add(uint64_t addr) {
+    if (contains(addr)) {
+        return false;
+    }
+    if (cnt_ == max_) {
+        max_ = max_ ? 2 * max_ : 64;
+        uint64_t *t = new uint64_t[max_];
+        if (addr_) {
+            memcpy(t, addr_, cnt_ * sizeof(uint64_t));
+            delete [] addr_;
+        }
+        addr_ = t;
+    }
+    addr_[cnt_++] = addr;
+    rebuild();
+    return true;
+}
+
+bool BreakpointIndex::remove(uint64_t addr) {
+    int idx = contains(addr) ? find(addr) : -1;
+    if (idx < 0) {
+        return false;
+    }
+    addr_[idx] = addr_[--cnt_];
+    rebuild();
+    return true;
+}
+
+void BreakpointIndex::rebuild() {
+    memset(filter_, 0, sizeof(filter_));
+    if (2 * cnt_ > hashMax_) {
+        delete [] hash_;
+        hashMax_ = hashMax_ ? hashMax_ : 128;
+        while (2 * cnt_ > hashMax_) {
+            hashMax_ *= 2;
+        }
+        hash_ = new int[hashMax_];
+    }
+    if (hash_) {
+        memset(hash_, 0xFF, hashMax_ * sizeof(int));
+    }
+    for (unsigned i = 0; i < cnt_; i++) {
+        unsigned f = pageHash(addr_[i]);
+        filter_[f >> 5] |= 1u << (f & 0x1F);
+
+        unsigned h = slot(addr_[i]);
+        while (hash_[h] >= 0) {
+            h = (h + 1) & (hashMax_ - 1);
+        }
+        hash_[h] = static_cast<int>(i);
+    }
+}
+
+}  // namespace debugger
@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef __DEBUGGER_COMMON_GENERIC_BREAKPOINT_INDEX_H__
+#define __DEBUGGER_COMMON_GENERIC_BREAKPOINT_INDEX_H__
+
+#include <inttypes.h>
+
+namespace debugger {
+
+/**
+ * @brief Set of breakpoint addresses.
+ *
+ * Bitmap of hashed 4 KB pages filters out addresses without breakpoints
+ * with a single bit test, only addresses on armed pages are looked up in
+ * the hash table. Both are rebuilt on each add/remove that are rare
+ * operations comparing with checks.
+ */
+class BreakpointIndex {
+ public:
+    BreakpointIndex();
+    ~BreakpointIndex();
+
+    unsigned size() { return cnt_; }
+    /** Return false if address is already in the set */
+    bool add(uint64_t addr);
+    /** Return false if address wasn't found */
+    bool remove(uint64_t addr);
+    void clear();
+
+    /** Return false if there's no breakpoints on the page of address */
+    bool isPageArmed(uint64_t addr) {
+        unsigned h = pageHash(addr);
+        return ((filter_[h >> 5] >> (h & 0x1F)) & 0x1) != 0;
+    }
+
+    bool contains(uint64_t addr) {
+        return isPageArmed(addr) && find(addr) >= 0;
+    }
+
+ private:
+    static const int PAGE_SHIFT = 12;
+    static const unsigned FILTER_BITS = 1 << 16;
+
+    static unsigned pageHash(uint64_t addr) {
+        uint64_t pg = addr >> PAGE_SHIFT;
+        return static_cast<unsigned>(pg ^ (pg >> 16) ^ (pg >> 32))
+                & (FILTER_BITS - 1);
+    }
+    unsigned slot(uint64_t addr) {
+        return static_cast<unsigned>((addr * 0x9E3779B97F4A7C15ull) >> 32)
+                & (hashMax_ - 1);
+    }
+    int find(uint64_t addr);
+    void rebuild();
+
+ private:
+    uint32_t filter_[FILTER_BITS / 32];
+    uint64_t *addr_;
+    unsigned cnt_;
+    unsigned max_;
+    int *hash_;                 // index in addr_ or -1
+    unsigned hashMax_;          // power of 2
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_GENERIC_BREAKPOINT_INDEX_H__
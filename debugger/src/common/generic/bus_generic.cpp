@@ -28,17 +28,31 @@ BusGeneric::BusGeneric(const char *name) : IService(name),
             sizeof(DsuMapType::local_regs_type::\
                    local_region_type::mst_bus_util_type)) {
     registerInterface(static_cast<IMemoryOperation *>(this));
-    registerAttribute("UseHash", static_cast<IAttribute *>(&useHash_));
-    RISCV_mutex_init(&mutexBAccess_);
-    RISCV_mutex_init(&mutexNBAccess_);
+    RISCV_mutex_init(&mutexMap_);
     RISCV_register_hap(static_cast<IHap *>(this));
     busUtil_.setPriority(10);     // Overmap DSU registers
-    imaphash_ = 0;
+    decode_ = 0;
+    locks_ = 0;
+    locksCnt_ = 0;
+    locksMax_ = 0;
 }
 
 BusGeneric::~BusGeneric() {
-    RISCV_mutex_destroy(&mutexBAccess_);
-    RISCV_mutex_destroy(&mutexNBAccess_);
+    DecodeTableType *p;
+    while (decode_) {
+        p = decode_;
+        decode_ = p->prev;
+        delete [] p->regions;
+        delete p;
+    }
+    for (unsigned i = 0; i < locksCnt_; i++) {
+        RISCV_mutex_destroy(&locks_[i]->mutex);
+        delete locks_[i];
+    }
+    if (locks_) {
+        delete [] locks_;
+    }
+    RISCV_mutex_destroy(&mutexMap_);
 }
 
 void BusGeneric::postinitService() {
@@ -70,73 +84,56 @@ void BusGeneric::postinitService() {
     }
 }
 
-/** We need correctly mapped device list to compute hash, postinit
-    doesn't allow to guarantee order of initialization. */
+/** Device address attributes may be changed during postinit, so the
+    decoding table is rebuilt when the configuration is done. */
 void BusGeneric::hapTriggered(IFace *isrc,
                                  EHapType type,
                                  const char *descr) {
-    if (!useHash_.to_bool()) {
-        return;
-    }
-
-    IMemoryOperation *imem;
-    for (unsigned i = 0; i < imap_.size(); i++) {
-        imem = static_cast<IMemoryOperation *>(imap_[i].to_iface());
-        maphash(imem);
-    }
+    buildDecodeTable();
 }
 
 ETransStatus BusGeneric::b_transport(Axi4TransactionType *trans) {
     ETransStatus ret = TRANS_OK;
-    uint32_t sz;
-    IMemoryOperation *memdev = 0;
-
-    RISCV_mutex_lock(&mutexBAccess_);
 
     if (itranslator_) {
         itranslator_->translate(trans);
     }
 
-    getMapedDevice(trans, &memdev, &sz);
+    DecodeRegionType *r = getDecodeRegion(trans->addr);
 
-    if (memdev == 0) {
+    if (r == 0 || r->imem == 0) {
         RISCV_error("Blocking request to unmapped address "
                     "%08" RV_PRI64 "x", trans->addr);
         memset(trans->rpayload.b8, 0xFF, trans->xsize);
         ret = TRANS_ERROR;
     } else {
-        memdev->b_transport(trans);
+        if (r->lock->enabled) {
+            RISCV_mutex_lock(&r->lock->mutex);
+            r->imem->b_transport(trans);
+            RISCV_mutex_unlock(&r->lock->mutex);
+        } else {
+            r->imem->b_transport(trans);
+        }
         RISCV_debug("[%08" RV_PRI64 "x] => [%08x %08x]",
             trans->addr,
             trans->rpayload.b32[1], trans->rpayload.b32[0]);
     }
 
-    // Update Bus utilization counters:
-    if (trans->source_idx >= 0 && trans->source_idx < 8) {
-        if (trans->action == MemAction_Read) {
-            busUtil_.getpR64()[2*trans->source_idx + 1]++;
-        } else if (trans->action == MemAction_Write) {
-            busUtil_.getpR64()[2*trans->source_idx]++;
-        }
-    }
-    RISCV_mutex_unlock(&mutexBAccess_);
+    updateBusUtil(trans);
     return ret;
 }
 
 ETransStatus BusGeneric::nb_transport(Axi4TransactionType *trans,
                                IAxi4NbResponse *cb) {
     ETransStatus ret = TRANS_OK;
-    IMemoryOperation *memdev = 0;
-    uint32_t sz;
-
-    RISCV_mutex_lock(&mutexNBAccess_);
 
     if (itranslator_) {
         itranslator_->translate(trans);
     }
-    getMapedDevice(trans, &memdev, &sz);
 
-    if (memdev == 0) {
+    DecodeRegionType *r = getDecodeRegion(trans->addr);
+
+    if (r == 0 || r->imem == 0) {
         RISCV_error("Non-blocking request to unmapped address "
                     "%08" RV_PRI64 "x", trans->addr);
         memset(trans->rpayload.b8, 0xFF, trans->xsize);
@@ -144,47 +141,196 @@ ETransStatus BusGeneric::nb_transport(Axi4TransactionType *trans,
         cb->nb_response(trans);
         ret = TRANS_ERROR;
     } else {
-        memdev->nb_transport(trans, cb);
+        if (r->lock->enabled) {
+            RISCV_mutex_lock(&r->lock->mutex);
+            r->imem->nb_transport(trans, cb);
+            RISCV_mutex_unlock(&r->lock->mutex);
+        } else {
+            r->imem->nb_transport(trans, cb);
+        }
         RISCV_debug("Non-blocking request to [%08" RV_PRI64 "x]",
                     trans->addr);
     }
 
-    // Update Bus utilization counters:
-    if (trans->source_idx >= 0 && trans->source_idx < 8) {
-        if (trans->action == MemAction_Read) {
-            busUtil_.getpR64()[2*trans->source_idx + 1]++;
-        } else if (trans->action == MemAction_Write) {
-            busUtil_.getpR64()[2*trans->source_idx]++;
+    updateBusUtil(trans);
+    return ret;
+}
+
+void BusGeneric::updateBusUtil(Axi4TransactionType *trans) {
+    if (trans->source_idx < 0 || trans->source_idx >= 8) {
+        return;
+    }
+    if (trans->action == MemAction_Read) {
+        RISCV_atomic_add64(&busUtil_.getpR64()[2*trans->source_idx + 1], 1);
+    } else if (trans->action == MemAction_Write) {
+        RISCV_atomic_add64(&busUtil_.getpR64()[2*trans->source_idx], 1);
+    }
+}
+
+bool BusGeneric::getDmiPointer(Axi4TransactionType *trans,
+                               DmiRegionType *dmi) {
+    dmi->length = 0;
+    dmi->ptr = 0;
+    dmi->access = 0;
+    dmi->util = 0;
+    dmi->dirty = 0;
+    dmi->pagebase = 0;
+    if (itranslator_) {
+        return false;
+    }
+
+    DecodeRegionType *r = getDecodeRegion(trans->addr);
+    if (r == 0 || r->imem == 0) {
+        return false;
+    }
+
+    // Decoding region excludes areas overmapped by other devices
+    uint64_t lo = r[0].addr;
+    uint64_t hi = r[1].addr;
+    if (r->imem->getDmiPointer(trans, dmi)) {
+        if (dmi->addr > lo) {
+            lo = dmi->addr;
         }
+        if (dmi->addr + dmi->length < hi) {
+            hi = dmi->addr + dmi->length;
+        }
+        dmi->ptr += lo - dmi->addr;
+    } else {
+        dmi->ptr = 0;
+        dmi->access = 0;
     }
-    RISCV_mutex_unlock(&mutexNBAccess_);
-    return ret;
+    dmi->addr = lo;
+    dmi->length = hi - lo;
+
+    if (trans->source_idx >= 0 && trans->source_idx < 8) {
+        dmi->util = &busUtil_.getpR64()[2*trans->source_idx];
+    }
+    return dmi->access != 0;
+}
+
+void BusGeneric::map(IMemoryOperation *imemop) {
+    RISCV_mutex_lock(&mutexMap_);
+    IMemoryOperation::map(imemop);
+    buildDecodeTable();
+    RISCV_mutex_unlock(&mutexMap_);
+    RISCV_trigger_hap(static_cast<IService *>(this), HAP_MemoryMap,
+                      "Memory map changed");
 }
 
-void BusGeneric::getMapedDevice(Axi4TransactionType *trans,
-                         IMemoryOperation **pdev, uint32_t *sz) {
+void BusGeneric::buildDecodeTable() {
     IMemoryOperation *imem;
-    *pdev = 0;
-    *sz = 0;
-    if (useHash_.to_bool()) {
-        imem = getHashedDevice(trans->addr);
-        if (imem) {
-            *pdev = imem;
-            return;
+    RISCV_mutex_lock(&mutexMap_);
+    unsigned total = imap_.size();
+    uint64_t *bnd = new uint64_t[2*total + 1];
+    int bndcnt = 0;
+    uint64_t t;
+
+    // Sorted list of unique devices boundaries
+    for (unsigned i = 0; i < total; i++) {
+        imem = static_cast<IMemoryOperation *>(imap_[i].to_iface());
+        if (imem->getLength() == 0) {
+            continue;
+        }
+        bnd[bndcnt++] = imem->getBaseAddress();
+        bnd[bndcnt++] = imem->getBaseAddress() + imem->getLength();
+    }
+    for (int i = 1; i < bndcnt; i++) {
+        t = bnd[i];
+        int k = i;
+        while (k > 0 && bnd[k - 1] > t) {
+            bnd[k] = bnd[k - 1];
+            k--;
+        }
+        bnd[k] = t;
+    }
+
+    // Elementary interval belongs to the device with the highest priority,
+    // neighbouring intervals of the same device are merged.
+    DecodeTableType *tbl = new DecodeTableType;
+    tbl->regions = new DecodeRegionType[bndcnt + 1];
+    tbl->cnt = 0;
+    tbl->prev = decode_;
+    DecodeRegionType *r = tbl->regions;
+    for (int i = 0; i < bndcnt; i++) {
+        if (i > 0 && bnd[i] == bnd[i - 1]) {
+            continue;
+        }
+        imem = findDevice(bnd[i]);
+        if (tbl->cnt > 0 && r[tbl->cnt - 1].imem == imem) {
+            continue;
         }
+        r[tbl->cnt].addr = bnd[i];
+        r[tbl->cnt].imem = imem;
+        r[tbl->cnt].lock = imem ? getDeviceLock(imem) : 0;
+        tbl->cnt++;
     }
+    delete [] bnd;
 
+    RISCV_memory_barrier();
+    decode_ = tbl;
+    RISCV_mutex_unlock(&mutexMap_);
+}
+
+IMemoryOperation *BusGeneric::findDevice(uint64_t addr) {
+    IMemoryOperation *imem;
+    IMemoryOperation *ret = 0;
     uint64_t bar, barsz;
     for (unsigned i = 0; i < imap_.size(); i++) {
         imem = static_cast<IMemoryOperation *>(imap_[i].to_iface());
         bar = imem->getBaseAddress();
         barsz = imem->getLength();
-        if (bar <= trans->addr && trans->addr < (bar + barsz)) {
-            if (!(*pdev) || imem->getPriority() > (*pdev)->getPriority()) {
-                *pdev = imem;
+        if (bar <= addr && addr < (bar + barsz)) {
+            if (!ret || imem->getPriority() > ret->getPriority()) {
+                ret = imem;
             }
         }
     }
+    return ret;
+}
+
+/** The same lock object is used by all decoding tables */
+BusGeneric::DeviceLockType *BusGeneric::getDeviceLock(IMemoryOperation *imem) {
+    for (unsigned i = 0; i < locksCnt_; i++) {
+        if (locks_[i]->imem == imem) {
+            return locks_[i];
+        }
+    }
+    if (locksCnt_ == locksMax_) {
+        locksMax_ = locksMax_ ? 2*locksMax_ : 16;
+        DeviceLockType **t = new DeviceLockType *[locksMax_];
+        for (unsigned i = 0; i < locksCnt_; i++) {
+            t[i] = locks_[i];
+        }
+        if (locks_) {
+            delete [] locks_;
+        }
+        locks_ = t;
+    }
+    DeviceLockType *p = new DeviceLockType;
+    p->imem = imem;
+    p->enabled = !imem->isThreadSafe();
+    RISCV_mutex_init(&p->mutex);
+    locks_[locksCnt_++] = p;
+    return p;
+}
+
+BusGeneric::DecodeRegionType *BusGeneric::getDecodeRegion(uint64_t addr) {
+    DecodeTableType *tbl = decode_;
+    if (tbl == 0 || tbl->cnt == 0 || addr < tbl->regions[0].addr) {
+        return 0;
+    }
+    int lo = 0;
+    int hi = tbl->cnt - 1;
+    int mid;
+    while (lo < hi) {
+        mid = (lo + hi + 1) / 2;
+        if (tbl->regions[mid].addr <= addr) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return &tbl->regions[lo];
 }
 
 }  // namespace debugger
@@ -39,27 +39,56 @@ class BusGeneric : public IService,
     virtual ETransStatus b_transport(Axi4TransactionType *trans);
     virtual ETransStatus nb_transport(Axi4TransactionType *trans,
                                       IAxi4NbResponse *cb);
+    virtual bool getDmiPointer(Axi4TransactionType *trans,
+                               DmiRegionType *dmi);
+    virtual void map(IMemoryOperation *imemop);
+    virtual bool isThreadSafe() { return true; }
 
     /** IHap */
     virtual void hapTriggered(IFace *isrc, EHapType type, const char *descr);
 
  protected:
-    /** Speed-optimized mapping */
-    virtual uint64_t adr_hash(uint64_t adr) { return adr; }
-    virtual void maphash(IMemoryOperation *imemop) {}
-    virtual IMemoryOperation *getHashedDevice(uint64_t addr) { return 0; }
-    void getMapedDevice(Axi4TransactionType *trans,
-                        IMemoryOperation **pdev, uint32_t *sz);
+    /** Serialization of the transactions to the device */
+    struct DeviceLockType {
+        IMemoryOperation *imem;
+        bool enabled;               // device isn't thread-safe
+        mutex_def mutex;
+    };
 
- protected:
-    AttributeType useHash_;
-    mutex_def mutexBAccess_;
-    mutex_def mutexNBAccess_;
-    Axi4TransactionType b_tr_;
-    Axi4TransactionType nb_tr_;
+    /**
+     * Sorted list of non-overlapped address regions. Region ends at the
+     * start address of the next one, the last region is always unmapped.
+     */
+    struct DecodeRegionType {
+        uint64_t addr;
+        IMemoryOperation *imem;     // device with the highest priority
+        DeviceLockType *lock;
+    };
+
+    struct DecodeTableType {
+        DecodeRegionType *regions;
+        int cnt;
+        DecodeTableType *prev;      // replaced table, released with the bus
+    };
 
+    /** Rebuild address decoding table from the list of mapped devices */
+    void buildDecodeTable();
+    /** Resolve device by priority. Used to build the decoding table */
+    IMemoryOperation *findDevice(uint64_t addr);
+    DeviceLockType *getDeviceLock(IMemoryOperation *imem);
+    /** Decoding region containing address or 0 */
+    DecodeRegionType *getDecodeRegion(uint64_t addr);
+    void updateBusUtil(Axi4TransactionType *trans);
+
+ protected:
+    mutex_def mutexMap_;
     GenericReg64Bank busUtil_;    // per master read/write access statistic
-    IMemoryOperation **imaphash_;
+    /** Transactions don't lock the bus, the current table is replaced
+        atomically and previous tables are kept until the bus destroyed. */
+    DecodeTableType * volatile decode_;
+    DeviceLockType **locks_;
+    unsigned locksCnt_;
+    unsigned locksMax_;
 };
 
 DECLARE_CLASS(BusGeneric)
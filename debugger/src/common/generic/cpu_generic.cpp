@@ -21,7 +21,7 @@
 namespace debugger {
 
 CpuGeneric::CpuGeneric(const char *name)  
-    : IService(name), IHap(HAP_ConfigDone),
+    : IService(name), IHap(HAP_All),
     pc_(this, "pc", DSUREG(ureg.v.pc)),
     npc_(this, "npc", DSUREG(ureg.v.npc)),
     status_(this, "status", DSUREG(udbg.v.control)),
@@ -42,6 +42,9 @@ CpuGeneric::CpuGeneric(const char *name)
     registerInterface(static_cast<ICpuFunctional *>(this));
     registerInterface(static_cast<IResetListener *>(this));
     registerInterface(static_cast<IHap *>(this));
+    registerInterface(static_cast<ISnapshot *>(this));
+    registerInterface(static_cast<ICoverageTracker *>(this));
+    registerInterface(static_cast<IInstrMix *>(this));
     registerAttribute("Enable", &isEnable_);
     registerAttribute("SysBus", &sysBus_);
     registerAttribute("DbgBus", &dbgBus_);
@@ -54,6 +57,15 @@ CpuGeneric::CpuGeneric(const char *name)
     registerAttribute("FreqHz", &freqHz_);
     registerAttribute("GenerateRegTraceFile", &generateRegTraceFile_);
     registerAttribute("GenerateMemTraceFile", &generateMemTraceFile_);
+    registerAttribute("BinaryTraceFile", &binaryTraceFile_);
+    registerAttribute("BinaryTraceCompress", &binaryTraceCompress_);
+    registerAttribute("BbvFile", &bbvFile_);
+    registerAttribute("BbvInterval", &bbvInterval_);
+    registerAttribute("ICacheModel", &icacheModel_);
+    registerAttribute("DCacheModel", &dcacheModel_);
+    registerAttribute("BranchPredictor", &branchPredictor_);
+    registerAttribute("InstrLatency", &instrLatency_);
+    registerAttribute("InstrMix", &instrMix_);
     registerAttribute("ResetVector", &resetVector_);
     registerAttribute("SysBusMasterID", &sysBusMasterID_);
     registerAttribute("CacheBaseAddress", &cacheBaseAddr_);
@@ -74,19 +86,43 @@ CpuGeneric::CpuGeneric(const char *name)
     sw_breakpoint_ = false;
     hw_breakpoint_ = false;
     skip_sw_breakpoint_ = false;
-    hwBreakpoints_.make_list(0);
     do_not_cache_ = false;
+    dmiCnt_ = 0;
+    dmiNext_ = 0;
 
     dport_.valid = 0;
     reg_trace_file = 0;
     mem_trace_file = 0;
+    binTrace_ = 0;
+    binTraceRegs_ = false;
+    binTraceMem_ = false;
+    binaryTraceFile_.make_string("");
+    binaryTraceCompress_.make_boolean(false);
+    bbv_ = 0;
+    bbvPc_ = 0;
+    bbvStep_ = 0;
+    bbvFile_.make_string("");
+    bbvInterval_.make_uint64(10000000);
+    timing_ = 0;
+    icacheModel_.make_list(0);
+    dcacheModel_.make_list(0);
+    branchPredictor_.make_list(0);
+    instrLatency_.make_list(0);
+    instrMix_.make_boolean(false);
+    memset(mixData_, 0, sizeof(mixData_));
+    pmix_ = &mixData_[0];
     memcache_ = 0;
     memcache_flag_ = 0;
     memcache_sz_ = 0;
     cache_offset_ = 0;
     cachable_pc_ = false;
+    cache_gen_ = 0;
     CACHE_BASE_ADDR_ = 0;
     CACHE_MASK_ = 0;
+    covmap_ = 0;
+    edgemap_ = 0;
+    edgeCoverage_ = false;
+    edgePrevPc_ = 0;
     oplen_ = 0;
     RISCV_set_default_clock(static_cast<IClock *>(this));
 }
@@ -100,6 +136,12 @@ CpuGeneric::~CpuGeneric() {
     if (memcache_flag_) {
         delete [] memcache_flag_;
     }
+    if (covmap_) {
+        delete [] covmap_;
+    }
+    if (edgemap_) {
+        delete [] edgemap_;
+    }
     if (reg_trace_file) {
         reg_trace_file->close();
         delete reg_trace_file;
@@ -108,6 +150,17 @@ CpuGeneric::~CpuGeneric() {
         mem_trace_file->close();
         delete mem_trace_file;
     }
+    if (binTrace_) {
+        delete binTrace_;
+    }
+    if (bbv_) {
+        trackBbv();
+        bbv_->close(step_cnt_);
+        delete bbv_;
+    }
+    if (timing_) {
+        delete timing_;
+    }
 }
 
 void CpuGeneric::postinitService() {
@@ -151,6 +204,7 @@ void CpuGeneric::postinitService() {
     }
 
     stackTraceBuf_.setRegTotal(2 * stackTraceSize_.to_int());
+    enableInstrMix(instrMix_.to_bool());
 
     CACHE_BASE_ADDR_ = cacheBaseAddr_.to_uint64();
     CACHE_MASK_ = ~cacheAddrMask_.to_uint64();
@@ -159,6 +213,8 @@ void CpuGeneric::postinitService() {
         memcache_ = new uint8_t[memcache_sz_];
         memcache_flag_ = new uint8_t[memcache_sz_];
         memset(memcache_flag_, 0, memcache_sz_);
+        covmap_ = new uint8_t[memcache_sz_ / 2];
+        memset(covmap_, 0, memcache_sz_ / 2);
     }
 
     // Get global settings:
@@ -168,18 +224,253 @@ void CpuGeneric::postinitService() {
             RISCV_error("Can't create thread.", NULL);
             return;
         }
-        if (generateRegTraceFile_.to_bool()) {
-            reg_trace_file = new std::ofstream("river_func_regs.log");
+        if (binaryTraceFile_.size()
+            && (generateRegTraceFile_.to_bool()
+                || generateMemTraceFile_.to_bool())) {
+            int regtotal;
+            const char *const *regnames = getTraceRegNames(&regtotal);
+            binTrace_ = new BinTraceWriter(getInterface(IFACE_SERVICE));
+            if (binTrace_->open(binaryTraceFile_.to_string(),
+                                binaryTraceCompress_.to_bool(),
+                                regnames, regtotal)) {
+                binTraceRegs_ = generateRegTraceFile_.to_bool();
+                binTraceMem_ = generateMemTraceFile_.to_bool();
+            } else {
+                delete binTrace_;
+                binTrace_ = 0;
+            }
+        } else {
+            if (generateRegTraceFile_.to_bool()) {
+                reg_trace_file = new std::ofstream("river_func_regs.log");
+            }
+            if (generateMemTraceFile_.to_bool()) {
+                mem_trace_file = new std::ofstream("river_func_mem.log");
+            }
+        }
+        if (bbvFile_.size()) {
+            bbv_ = new BbvWriter();
+            if (bbv_->open(bbvFile_.to_string(), bbvInterval_.to_uint64(),
+                           step_cnt_)) {
+                bbvPc_ = getResetAddress();
+                bbvStep_ = step_cnt_;
+            } else {
+                RISCV_error("Can't open basic block vectors file %s",
+                            bbvFile_.to_string());
+                delete bbv_;
+                bbv_ = 0;
+            }
         }
-        if (generateMemTraceFile_.to_bool()) {
-            mem_trace_file = new std::ofstream("river_func_mem.log");
+        if (icacheModel_.size() || dcacheModel_.size()
+            || branchPredictor_.size() || instrLatency_.size()) {
+            timing_ = new TimingModel();
+            const char *err = timing_->init(icacheModel_, dcacheModel_,
+                                            branchPredictor_, instrLatency_);
+            if (err) {
+                RISCV_error("%s", err);
+                delete timing_;
+                timing_ = 0;
+            }
         }
     }
 }
 
 void CpuGeneric::hapTriggered(IFace *isrc, EHapType type,
                                        const char *descr) {
-    RISCV_event_set(&eventConfigDone_);
+    if (type == HAP_ConfigDone) {
+        dmiCnt_ = 0;
+        RISCV_event_set(&eventConfigDone_);
+    } else if (type == HAP_MemoryMap) {
+        dmiCnt_ = 0;
+    }
+}
+
+/**
+ * Clock queue callbacks are saved with the names of the services that
+ * registered them as IClockListener interface or as the port named by
+ * this CPU (per CPU listeners of the multi-hart devices). Other callbacks
+ * are lost.
+ */
+void CpuGeneric::saveState(AutoBuffer *buf) {
+    uint64_t st[6];
+    st[0] = step_cnt_;
+    st[1] = pc_.getValue().val;
+    st[2] = npc_.getValue().val;
+    st[3] = interrupt_pending_[0];
+    st[4] = interrupt_pending_[1];
+    st[5] = cur_prv_level;
+    buf->write_bin(reinterpret_cast<char *>(st), sizeof(st));
+
+    uint64_t cnt = stackTraceCnt_.getValue().val;
+    buf->write_bin(reinterpret_cast<char *>(&cnt), sizeof(cnt));
+    saveBank(buf, &stackTraceBuf_);
+
+    AttributeType listeners;
+    AttributeType services;
+    RISCV_get_services_with_iface(IFACE_CLOCK_LISTENER, &listeners);
+    RISCV_get_services_with_iface(IFACE_SERVICE, &services);
+    int cnt_offset = buf->size();
+    uint32_t total = 0;
+    buf->write_bin(reinterpret_cast<char *>(&total), sizeof(total));
+    for (int i = 0; i < queue_.size(); i++) {
+        uint64_t t;
+        IFace *cb;
+        IService *iserv = 0;
+        const char *port = "";
+        queue_.getItem(i, &t, &cb);
+        for (unsigned n = 0; n < listeners.size(); n++) {
+            IService *p = static_cast<IService *>(listeners[n].to_iface());
+            if (p->getInterface(IFACE_CLOCK_LISTENER) == cb) {
+                iserv = p;
+                break;
+            }
+        }
+        for (unsigned n = 0; !iserv && n < services.size(); n++) {
+            IService *p = static_cast<IService *>(services[n].to_iface());
+            if (p->getPortInterface(getObjName(),
+                                    IFACE_CLOCK_LISTENER) == cb) {
+                iserv = p;
+                port = getObjName();
+            }
+        }
+        if (!iserv) {
+            RISCV_error("Clock callback at %" RV_PRI64 "d isn't saved", t);
+            continue;
+        }
+        buf->write_bin(reinterpret_cast<char *>(&t), sizeof(t));
+        buf->write_bin(iserv->getObjName(),
+                       static_cast<int>(strlen(iserv->getObjName())) + 1);
+        buf->write_bin(port, static_cast<int>(strlen(port)) + 1);
+        total++;
+    }
+    memcpy(&buf->getBuffer()[cnt_offset], &total, sizeof(total));
+}
+
+bool CpuGeneric::restoreState(SnapshotReader *rd) {
+    uint64_t st[6];
+    uint64_t cnt;
+    uint32_t total;
+    if (!rd->read(st, sizeof(st)) || !rd->read(&cnt, sizeof(cnt))
+        || !restoreBank(rd, &stackTraceBuf_)
+        || !rd->read(&total, sizeof(total))) {
+        return false;
+    }
+    if (bbv_) {
+        // Intervals of the file must follow each other
+        trackBbv();
+        bbv_->close(step_cnt_);
+        delete bbv_;
+        bbv_ = 0;
+        RISCV_info("Basic block vectors recording stopped", NULL);
+    }
+    step_cnt_ = st[0];
+    pc_.setValue(st[1]);
+    npc_.setValue(st[2]);
+    interrupt_pending_[0] = st[3];
+    interrupt_pending_[1] = st[4];
+    cur_prv_level = st[5];
+    stackTraceCnt_.setValue(cnt);
+
+    queue_.hardReset();
+    for (uint32_t i = 0; i < total; i++) {
+        uint64_t t;
+        const char *name;
+        const char *port;
+        if (!rd->read(&t, sizeof(t)) || (name = rd->readString()) == 0
+            || (port = rd->readString()) == 0) {
+            return false;
+        }
+        IFace *cb;
+        if (port[0]) {
+            cb = RISCV_get_service_port_iface(name, port,
+                                              IFACE_CLOCK_LISTENER);
+        } else {
+            cb = RISCV_get_service_iface(name, IFACE_CLOCK_LISTENER);
+        }
+        if (!cb) {
+            RISCV_error("Clock listener '%s' not found", name);
+            continue;
+        }
+        queue_.put(t, cb);
+    }
+    queue_.pushPreQueued();
+
+    hw_breakpoint_ = false;
+    sw_breakpoint_ = false;
+    flush(~0ull);
+    return true;
+}
+
+void CpuGeneric::getCoverageRegion(uint64_t *base, uint64_t *size) {
+    *base = CACHE_BASE_ADDR_;
+    *size = static_cast<uint64_t>(memcache_sz_);
+}
+
+bool CpuGeneric::isCovered(uint64_t addr) {
+    if (covmap_ == 0 || (addr & CACHE_MASK_) != CACHE_BASE_ADDR_) {
+        return false;
+    }
+    return covmap_[(addr - CACHE_BASE_ADDR_) >> 1] != 0;
+}
+
+uint64_t CpuGeneric::coveredTotal() {
+    uint64_t ret = 0;
+    for (int i = 0; i < memcache_sz_ / 2; i++) {
+        ret += covmap_[i];
+    }
+    return ret;
+}
+
+void CpuGeneric::enableEdgeCoverage(bool en) {
+    if (en && edgemap_ == 0) {
+        edgemap_ = new uint8_t[EDGE_MAP_SIZE];
+        memset(edgemap_, 0, EDGE_MAP_SIZE);
+    }
+    edgePrevPc_ = pc_.getValue().val;
+    edgeCoverage_ = en;
+}
+
+unsigned CpuGeneric::edgeTotal() {
+    unsigned ret = 0;
+    for (unsigned i = 0; edgemap_ && i < EDGE_MAP_SIZE; i++) {
+        ret += edgemap_[i];
+    }
+    return ret;
+}
+
+void CpuGeneric::resetCoverage() {
+    if (covmap_) {
+        memset(covmap_, 0, memcache_sz_ / 2);
+    }
+    if (edgemap_) {
+        memset(edgemap_, 0, EDGE_MAP_SIZE);
+    }
+    flush(~0ull);
+}
+
+void CpuGeneric::enableInstrMix(bool en) {
+    pmix_ = &mixData_[en ? 1 : 0];
+}
+
+void CpuGeneric::getInstrMix(InstrMixType *mix) {
+    *mix = mixData_[1];
+}
+
+void CpuGeneric::resetInstrMix() {
+    memset(&mixData_[1], 0, sizeof(InstrMixType));
+}
+
+void CpuGeneric::saveBank(AutoBuffer *buf, GenericReg64Bank *bank) {
+    uint32_t sz = static_cast<uint32_t>(bank->getLength());
+    buf->write_bin(reinterpret_cast<char *>(&sz), sizeof(sz));
+    buf->write_bin(reinterpret_cast<char *>(bank->getp()), sz);
+}
+
+bool CpuGeneric::restoreBank(SnapshotReader *rd, GenericReg64Bank *bank) {
+    uint32_t sz;
+    if (!rd->read(&sz, sizeof(sz)) || sz != bank->getLength()) {
+        return false;
+    }
+    return rd->read(bank->getp(), sz);
 }
 
 void CpuGeneric::busyLoop() {
@@ -211,11 +502,18 @@ void CpuGeneric::updatePipeline() {
         trackContextStart();
         if (instr_) {
             oplen_ = instr_->exec(cacheline_);
+            trackInstrMix();
         } else {
+            pmix_->instr[InstrMix_Illegal]++;
             generateIllegalOpcode();
         }
         trackContextEnd();
 
+        if (timing_) {
+            uint64_t pc = pc_.getValue().val;
+            timing_->instruction(pc, instr_, oplen_,
+                                 branch_ ? npc_.getValue().val : pc + oplen_);
+        }
         pc_z_ = pc_.getValue();
     }
 
@@ -226,6 +524,13 @@ void CpuGeneric::updatePipeline() {
     updateQueue();
 
     handleTrap();
+
+    // Taken branch may target the next instruction, traps change npc
+    // without branch flag
+    if (bbv_ && (branch_
+        || npc_.getValue().val != pc_.getValue().val + oplen_)) {
+        trackBbv();
+    }
 }
 
 bool CpuGeneric::updateState() {
@@ -252,7 +557,6 @@ bool CpuGeneric::updateState() {
 
 void CpuGeneric::updateQueue() {
     IFace *cb;
-    queue_.initProc();
     queue_.pushPreQueued();
 
     while ((cb = queue_.getNext(step_cnt_)) != 0) {
@@ -294,18 +598,41 @@ void CpuGeneric::flush(uint64_t addr) {
         /** SW breakpoint manager must call this flush operation */
         memcache_flag_[addr - CACHE_BASE_ADDR_] = 0;
     }
+    cache_gen_++;
+}
+
+void CpuGeneric::invalidateCache(uint64_t addr, unsigned sz) {
+    if (memcache_flag_ == 0) {
+        return;
+    }
+    // Instruction may start up to 3 bytes before the modified address
+    uint64_t start = addr > 3 ? addr - 3 : 0;
+    uint64_t end = addr + sz;
+    for (uint64_t a = start; a < end; a++) {
+        if ((a & CACHE_MASK_) == CACHE_BASE_ADDR_
+            && memcache_flag_[a - CACHE_BASE_ADDR_]) {
+            memcache_flag_[a - CACHE_BASE_ADDR_] = 0;
+            cache_gen_++;
+        }
+    }
 }
 
 void CpuGeneric::trackContextEnd() {
+    if (cachable_pc_) {
+        covmap_[cache_offset_ >> 1] = 1;
+    }
+    if (edgeCoverage_) {
+        uint64_t pc = pc_.getValue().val;
+        uint64_t h = (pc ^ (edgePrevPc_ >> 1)) * 0x9E3779B97F4A7C15ull;
+        edgemap_[h >> 48] = 1;
+        edgePrevPc_ = pc;
+    }
     if (do_not_cache_) {
-        if (cachable_pc_) {
+        if (cachable_pc_ && memcache_flag_[cache_offset_]) {
             memcache_flag_[cache_offset_] = 0;
+            cache_gen_++;
         }
     } else {
-        //if (icovtracker_) {
-        //    icovtracker_->markAddress(pc_.getValue().val,
-        //                              static_cast<uint8_t>(oplen_));
-        //}
         if (cachable_pc_) {
             memcache_flag_[cache_offset_] = oplen_;
             *reinterpret_cast<uint32_t *>(&memcache_[cache_offset_]) =
@@ -354,10 +681,26 @@ void CpuGeneric::popStackTrace() {
     }
 }
 
+unsigned CpuGeneric::getCallStack(uint64_t *calls, unsigned max) {
+    unsigned cnt = static_cast<unsigned>(stackTraceCnt_.getValue().val);
+    if (cnt > max) {
+        cnt = max;
+    }
+    for (unsigned i = 0; i < cnt; i++) {
+        calls[i] = stackTraceBuf_.read(2*i).val;
+    }
+    return cnt;
+}
+
 void CpuGeneric::dma_memop(Axi4TransactionType *tr) {
     tr->source_idx = sysBusMasterID_.to_int();
+    if (tr->action == MemAction_Write) {
+        invalidateCache(tr->addr, tr->xsize);
+    }
     if (tr->xsize <= sysBusWidthBytes_.to_uint32()) {
-        isysbus_->b_transport(tr);
+        if (!dmiAccess(tr)) {
+            isysbus_->b_transport(tr);
+        }
     } else {
         // 1-byte access for HC08
         Axi4TransactionType tr1 = *tr;
@@ -375,6 +718,14 @@ void CpuGeneric::dma_memop(Axi4TransactionType *tr) {
             }
         }
     }
+    if (timing_ && tr != &trans_) {
+        // Not an instruction fetch
+        timing_->dataAccess(tr->addr);
+    }
+    if (binTraceMem_) {
+        binTrace_->traceMem(step_cnt_, pc_.getValue().val, tr);
+        return;
+    }
     if (!mem_trace_file) {
     //if (!reg_trace_file) {
         return;
@@ -411,6 +762,68 @@ void CpuGeneric::dma_memop(Axi4TransactionType *tr) {
     mem_trace_file->flush();
 }
 
+bool CpuGeneric::dmiAccess(Axi4TransactionType *tr) {
+    DmiRegionType *p = 0;
+    for (unsigned i = 0; i < dmiCnt_; i++) {
+        if ((tr->addr - dmi_[i].addr) < dmi_[i].length) {
+            p = &dmi_[i];
+            break;
+        }
+    }
+    if (p == 0) {
+        DmiRegionType region;
+        region.length = 0;
+        region.dirty = 0;
+        isysbus_->getDmiPointer(tr, &region);
+        if (region.length == 0) {
+            return false;
+        }
+        p = &dmi_[dmiNext_];
+        *p = region;
+        dmiNext_ = (dmiNext_ + 1) % DMI_REGIONS_MAX;
+        if (dmiCnt_ < DMI_REGIONS_MAX) {
+            dmiCnt_++;
+        }
+    }
+
+    uint64_t off = tr->addr - p->addr;
+    if (off + tr->xsize > p->length) {
+        return false;
+    }
+    if (tr->action == MemAction_Read) {
+        if ((p->access & DMI_ACCESS_READ) == 0) {
+            return false;
+        }
+        memcpy(tr->rpayload.b8, &p->ptr[off], tr->xsize);
+    } else {
+        if ((p->access & DMI_ACCESS_WRITE) == 0) {
+            return false;
+        }
+        if (p->dirty) {
+            uint64_t pgoff = static_cast<uint64_t>(&p->ptr[off] - p->pagebase);
+            if (!p->dirty[pgoff >> DMI_PAGE_SHIFT]
+                || !p->dirty[(pgoff + tr->xsize - 1) >> DMI_PAGE_SHIFT]) {
+                return false;
+            }
+        }
+        if (((1ul << tr->xsize) - 1) == tr->wstrb) {
+            memcpy(&p->ptr[off], tr->wpayload.b8, tr->xsize);
+        } else {
+            for (unsigned i = 0; i < tr->xsize; i++) {
+                if ((tr->wstrb >> i) & 0x1) {
+                    p->ptr[off + i] = tr->wpayload.b8[i];
+                }
+            }
+        }
+    }
+    tr->response = MemResp_Valid;
+    if (p->util) {
+        int ridx = tr->action == MemAction_Read ? 1 : 0;
+        RISCV_atomic_add64(&p->util[ridx], 1);
+    }
+    return true;
+}
+
 void CpuGeneric::go() {
     if (estate_ == CORE_OFF) {
         RISCV_error("CPU is turned-off", 0);
@@ -466,6 +879,9 @@ void CpuGeneric::reset(bool active) {
     stackTraceCnt_.reset(active);
     pc_.setValue(getResetAddress());
     npc_.setValue(getResetAddress());
+    if (bbv_) {
+        trackBbv();
+    }
     if (!active && estate_ == CORE_OFF) {
         // Turn ON:
         estate_ = CORE_Halted;//CORE_Normal;
@@ -510,25 +926,16 @@ void CpuGeneric::nb_transport_debug_port(DebugPortTransactionType *trans,
 }
 
 void CpuGeneric::addHwBreakpoint(uint64_t addr) {
-    AttributeType item;
-    item.make_uint64(addr);
-    hwBreakpoints_.add_to_list(&item);
-    hwBreakpoints_.sort();
-    for (unsigned i = 0; i < hwBreakpoints_.size(); i++) {
+    if (hwBreakpoints_.add(addr)) {
         RISCV_debug("Breakpoint[%d]: 0x%04" RV_PRI64 "x",
-                    i, hwBreakpoints_[i].to_uint64());
+                    hwBreakpoints_.size() - 1, addr);
     }
+    // Invalidate cached blocks containing this address
     flush(addr);
 }
 
 void CpuGeneric::removeHwBreakpoint(uint64_t addr) {
-    for (unsigned i = 0; i < hwBreakpoints_.size(); i++) {
-        if (addr == hwBreakpoints_[i].to_uint64()) {
-            hwBreakpoints_.remove_from_list(i);
-            hwBreakpoints_.sort();
-            return;
-        }
-    }
+    hwBreakpoints_.remove(addr);
     flush(addr);
 }
 
@@ -540,18 +947,11 @@ bool CpuGeneric::checkHwBreakpoint() {
     }
     hw_breakpoint_ = false;
 
-    for (unsigned i = 0; i < hwBreakpoints_.size(); i++) {
-        uint64_t bradr = hwBreakpoints_[i].to_uint64();
-        if (pc < bradr) {
-            // Sorted list
-            break;
-        }
-        if (pc == bradr) {
-            hw_break_addr_ = pc;
-            hw_breakpoint_ = true;
-            halt("Hw breakpoint");
-            return true;
-        }
+    if (hwBreakpoints_.contains(pc)) {
+        hw_break_addr_ = pc;
+        hw_breakpoint_ = true;
+        halt("Hw breakpoint");
+        return true;
     }
     return false;
 }
@@ -609,6 +1009,11 @@ uint64_t StepCounterType::aboutToRead(uint64_t cur_val) {
     return pcpu->getStepCounter();
 }
 
+uint64_t ClockCounterType::aboutToRead(uint64_t cur_val) {
+    CpuGeneric *pcpu = static_cast<CpuGeneric *>(parent_);
+    return pcpu->getClockCounter();
+}
+
 uint64_t FlushAddressType::aboutToWrite(uint64_t new_val) {
     CpuGeneric *pcpu = static_cast<CpuGeneric *>(parent_);
     pcpu->flush(new_val);
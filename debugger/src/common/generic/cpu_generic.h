@@ -30,7 +30,14 @@
 #include "coreservices/isrccode.h"
 #include "coreservices/icmdexec.h"
 #include "coreservices/itap.h"
+#include "coreservices/isnapshot.h"
+#include "coreservices/icoverage.h"
+#include "coreservices/iinstrmix.h"
 #include "generic/mapreg.h"
+#include "generic/bintrace.h"
+#include "generic/bbv.h"
+#include "generic/timing_model.h"
+#include "generic/breakpoint_index.h"
 #include <fstream>
 
 namespace debugger {
@@ -81,6 +88,15 @@ class StepCounterType : public MappedReg64Type {
     virtual uint64_t aboutToRead(uint64_t cur_val) override;
 };
 
+class ClockCounterType : public MappedReg64Type {
+ public:
+    ClockCounterType(IService *parent, const char *name, uint64_t addr)
+        : MappedReg64Type(parent, name, addr) {
+    }
+ protected:
+    virtual uint64_t aboutToRead(uint64_t cur_val) override;
+};
+
 class FlushAddressType : public MappedReg64Type {
  public:
     FlushAddressType(IService *parent, const char *name, uint64_t addr)
@@ -96,7 +112,10 @@ class CpuGeneric : public IService,
                    public ICpuFunctional,
                    public IClock,
                    public IResetListener,
-                   public IHap {
+                   public IHap,
+                   public ISnapshot,
+                   public ICoverageTracker,
+                   public IInstrMix {
  public:
     explicit CpuGeneric(const char *name);
     virtual ~CpuGeneric();
@@ -115,6 +134,7 @@ class CpuGeneric : public IService,
     virtual void setBranch(uint64_t npc);
     virtual void pushStackTrace();
     virtual void popStackTrace();
+    virtual unsigned getCallStack(uint64_t *calls, unsigned max);
     virtual uint64_t getPrvLevel() { return cur_prv_level; }
     virtual void setPrvLevel(uint64_t lvl) { cur_prv_level = lvl; }
     virtual void dma_memop(Axi4TransactionType *tr);
@@ -144,6 +164,10 @@ class CpuGeneric : public IService,
     virtual uint64_t getStepCounter() { return step_cnt_; }
     virtual void registerStepCallback(IClockListener *cb, uint64_t t);
     virtual bool moveStepCallback(IClockListener *cb, uint64_t t);
+    /** Estimated by the timing models or equal to the step counter */
+    uint64_t getClockCounter() {
+        return timing_ ? step_cnt_ + timing_->getStallCycles() : step_cnt_;
+    }
     virtual double getFreqHz() {
         if (freqHz_.is_floating()) {
             return freqHz_.to_float();
@@ -158,6 +182,24 @@ class CpuGeneric : public IService,
     /** IHap */
     virtual void hapTriggered(IFace *isrc, EHapType type, const char *descr);
 
+    /** ISnapshot */
+    virtual void saveState(AutoBuffer *buf);
+    virtual bool restoreState(SnapshotReader *rd);
+
+    /** ICoverageTracker */
+    virtual void getCoverageRegion(uint64_t *base, uint64_t *size);
+    virtual bool isCovered(uint64_t addr);
+    virtual uint64_t coveredTotal();
+    virtual void enableEdgeCoverage(bool en);
+    virtual unsigned edgeTotal();
+    virtual void resetCoverage();
+
+    /** IInstrMix */
+    virtual void enableInstrMix(bool en);
+    virtual bool isInstrMixEnabled() { return pmix_ != &mixData_[0]; }
+    virtual void getInstrMix(InstrMixType *mix);
+    virtual void resetInstrMix();
+
  protected:
     /** IThread interface */
     virtual void busyLoop();
@@ -168,6 +210,32 @@ class CpuGeneric : public IService,
     virtual void updateDebugPort();
     virtual void updateQueue();
     virtual bool checkHwBreakpoint();
+    /** Drop cached instructions overlapped by CPU write access */
+    void invalidateCache(uint64_t addr, unsigned sz);
+    /** Register names written into the binary trace header */
+    virtual const char *const *getTraceRegNames(int *total) {
+        *total = 0;
+        return 0;
+    }
+    /** Account instructions executed since the last control transfer */
+    void trackBbv() {
+        bbv_->addRun(bbvPc_, bbvStep_, step_cnt_);
+        bbvPc_ = npc_.getValue().val;
+        bbvStep_ = step_cnt_;
+    }
+    /** Count executed instruction. Disabled statistic goes to scratch */
+    void trackInstrMix() {
+        pmix_->instr[instr_->mixType(branch_)]++;
+        pmix_->oplen[(oplen_ >> 2) & 1]++;
+    }
+    void trackTrap(unsigned irq, unsigned code) {
+        pmix_->trap[irq & 1][code & (TRAP_CODE_TOTAL - 1)]++;
+    }
+    /** Access memory by the host pointer. Return false if DMI not allowed */
+    bool dmiAccess(Axi4TransactionType *tr);
+    /** Registers bank checkpoint used by the derived models */
+    void saveBank(AutoBuffer *buf, GenericReg64Bank *bank);
+    bool restoreBank(SnapshotReader *rd, GenericReg64Bank *bank);
 
  protected:
     AttributeType isEnable_;
@@ -181,9 +249,17 @@ class CpuGeneric : public IService,
     AttributeType stackTraceSize_;
     AttributeType generateRegTraceFile_;
     AttributeType generateMemTraceFile_;
+    AttributeType binaryTraceFile_;
+    AttributeType binaryTraceCompress_;
+    AttributeType bbvFile_;
+    AttributeType bbvInterval_;
+    AttributeType icacheModel_;
+    AttributeType dcacheModel_;
+    AttributeType branchPredictor_;
+    AttributeType instrLatency_;
+    AttributeType instrMix_;
     AttributeType resetVector_;
     AttributeType sysBusMasterID_;
-    AttributeType hwBreakpoints_;
     AttributeType cacheBaseAddr_;
     AttributeType cacheAddrMask_;
 
@@ -193,6 +269,7 @@ class CpuGeneric : public IService,
     IMemoryOperation *isysbus_;
     IMemoryOperation *idbgbus_;
     GenericInstruction *instr_;
+    BreakpointIndex hwBreakpoints_;
 
     uint64_t step_cnt_;
     uint64_t hw_stepping_break_;
@@ -202,7 +279,7 @@ class CpuGeneric : public IService,
     MappedReg64Type npc_;
     GenericStatusType status_;
     MappedReg64Type stepping_cnt_;
-    StepCounterType clock_cnt_;
+    ClockCounterType clock_cnt_;
     StepCounterType executed_cnt_;
     MappedReg64Type stackTraceCnt_;         // Hardware stack trace buffer
     GenericReg64Bank stackTraceBuf_;        // [[from,to],*]
@@ -241,6 +318,23 @@ class CpuGeneric : public IService,
     uint64_t CACHE_MASK_;
     uint64_t cache_offset_;         // instruction pointer - CACHE_BASE_ADDR
     bool cachable_pc_;              // fetched_pc hit into cachable region
+    uint64_t cache_gen_;            // incremented on each cache invalidation
+    /**
+     * Executed instructions of the cached region, byte per halfword. Blocks
+     * of cached instructions aren't marked because they were marked when
+     * cached, so coverage reset also flushes the cache.
+     */
+    uint8_t *covmap_;
+    static const unsigned EDGE_MAP_SIZE = 1 << 16;
+    uint8_t *edgemap_;              // hashed (previous pc, pc) pairs
+    bool edgeCoverage_;             // disables cached instructions blocks
+    uint64_t edgePrevPc_;
+
+    // Direct memory regions of the system bus: dropped on map change
+    static const unsigned DMI_REGIONS_MAX = 4;
+    DmiRegionType dmi_[DMI_REGIONS_MAX];
+    unsigned dmiCnt_;
+    unsigned dmiNext_;              // next replaced region
 
     struct DebugPortType {
         bool valid;
@@ -252,6 +346,15 @@ class CpuGeneric : public IService,
 
     std::ofstream *reg_trace_file;
     std::ofstream *mem_trace_file;
+    BinTraceWriter *binTrace_;      // replaces text files when enabled
+    bool binTraceRegs_;
+    bool binTraceMem_;
+    BbvWriter *bbv_;                // basic block vectors recording
+    uint64_t bbvPc_;                // first instruction of the current block
+    uint64_t bbvStep_;              // step of the block first instruction
+    TimingModel *timing_;           // enabled by any of the timing models
+    InstrMixType mixData_[2];       // [0] is scratch of disabled statistic
+    InstrMixType *pmix_;
 };
 
 }  // namespace debugger
@@ -16,37 +16,124 @@
 
 #include "api_core.h"
 #include "mem_generic.h"
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
 
 namespace debugger {
 
 MemoryGeneric::MemoryGeneric(const char *name)  : IService(name) {
     registerInterface(static_cast<IMemoryOperation *>(this));
+    registerInterface(static_cast<ISnapshot *>(this));
     registerAttribute("ReadOnly", &readOnly_);
 
     readOnly_.make_boolean(false);
     mem_ = NULL;
+    dirty_ = NULL;
+    pages_ = NULL;
+    pageTotal_ = 0;
+    cowActive_ = false;
+    RISCV_mutex_init(&mutexPage_);
 }
 
 MemoryGeneric::~MemoryGeneric() {
     if (mem_) {
-        delete mem_;
+#if defined(_WIN32)
+        VirtualFree(mem_, 0, MEM_RELEASE);
+#else
+        munmap(mem_, static_cast<size_t>(length_.to_uint64()));
+#endif
     }
+    if (pages_) {
+        for (uint64_t i = 0; i < pageTotal_; i++) {
+            delete [] pages_[i];
+        }
+        delete [] pages_;
+    }
+    delete [] dirty_;
+    RISCV_mutex_destroy(&mutexPage_);
 }
 
+/**
+ * On POSIX only virtual address range is reserved: host pages are zeroed
+ * and committed by OS on the first access, so the large memory windows
+ * cost as much as the firmware touches. Windows path commits the whole
+ * window (charged against the commit limit), only physical pages are
+ * still allocated on the first access.
+ */
 void MemoryGeneric::postinitService() {
-    mem_ = new uint8_t[static_cast<unsigned>(length_.to_uint64())];
+    size_t sz = static_cast<size_t>(length_.to_uint64());
+#if defined(_WIN32)
+    mem_ = static_cast<uint8_t *>(VirtualAlloc(NULL, sz,
+                                  MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+#else
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_NORESERVE)
+    flags |= MAP_NORESERVE;
+#endif
+    void *p = mmap(NULL, sz, PROT_READ | PROT_WRITE, flags, -1, 0);
+    mem_ = p != MAP_FAILED ? static_cast<uint8_t *>(p) : NULL;
+#endif
+    if (mem_ == NULL) {
+        RISCV_error("Can't allocate %" RV_PRI64 "d bytes",
+                    length_.to_uint64());
+        return;
+    }
+    pageTotal_ = (length_.to_uint64() + PAGE_SIZE - 1) >> PAGE_SHIFT;
+    dirty_ = new uint8_t[static_cast<size_t>(pageTotal_)];
+    memset(const_cast<uint8_t *>(dirty_), 1,
+           static_cast<size_t>(pageTotal_));
+}
+
+bool MemoryGeneric::mapFile(const char *filename) {
+#if defined(_WIN32)
+    return false;
+#else
+    if (mem_ == NULL) {
+        return false;
+    }
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    uint64_t sz = static_cast<uint64_t>(st.st_size);
+    if (sz > length_.to_uint64()) {
+        sz = length_.to_uint64();
+    }
+    // Replace reserved pages; private mapping never modifies the file
+    void *p = mmap(mem_, static_cast<size_t>(sz), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_FIXED, fd, 0);
+    close(fd);
+    return p != MAP_FAILED;
+#endif
 }
 
 ETransStatus MemoryGeneric::b_transport(Axi4TransactionType *trans) {
-    uint64_t off = (trans->addr - getBaseAddress()) % length_.to_int();
+    uint64_t off = (trans->addr - getBaseAddress()) % length_.to_uint64();
+    if (mem_ == NULL) {
+        trans->response = MemResp_Error;
+        return TRANS_ERROR;
+    }
     trans->response = MemResp_Valid;
     if (trans->action == MemAction_Write) {
         if (readOnly_.to_bool()) {
             RISCV_error("Write to READ ONLY memory", NULL);
             trans->response = MemResp_Error;
         } else if (((1ul << trans->xsize) - 1) == trans->wstrb) {
+            markDirty(off, trans->xsize);
             memcpy(&mem_[off], trans->wpayload.b8, trans->xsize);
         } else {
+            markDirty(off, trans->xsize);
             for (uint64_t i = 0; i < trans->xsize; i++) {
                 if (((trans->wstrb >> i) & 0x1) == 0) {
                     continue;
@@ -67,4 +154,100 @@ ETransStatus MemoryGeneric::b_transport(Axi4TransactionType *trans) {
     return TRANS_OK;
 }
 
+bool MemoryGeneric::getDmiPointer(Axi4TransactionType *trans,
+                                  DmiRegionType *dmi) {
+    if (mem_ == NULL) {
+        return false;
+    }
+    dmi->addr = getBaseAddress();
+    dmi->length = getLength();
+    dmi->ptr = mem_;
+    dmi->access = DMI_ACCESS_READ;
+    if (!readOnly_.to_bool()) {
+        dmi->access |= DMI_ACCESS_WRITE;
+    }
+    dmi->dirty = dirty_;
+    dmi->pagebase = mem_;
+    return true;
+}
+
+/**
+ * Length is stored as 64-bit value, but AutoBuffer has int size and
+ * its capacity is a power of 2 int, so it is limited by 1 GB. Larger memory
+ * isn't truncated: zero length is saved instead and restoreState() fails
+ * on the length check.
+ */
+void MemoryGeneric::saveState(AutoBuffer *buf) {
+    uint64_t sz = getLength();
+    uint64_t used = static_cast<uint64_t>(buf->size()) + sizeof(sz) + 1;
+    if (used + sz > 0x40000000ull) {
+        RISCV_error("Memory size %" RV_PRI64 "d exceeds checkpoint limit",
+                    sz);
+        sz = 0;
+    }
+    buf->write_bin(reinterpret_cast<char *>(&sz), sizeof(sz));
+    if (sz) {
+        buf->write_bin(reinterpret_cast<char *>(mem_), static_cast<int>(sz));
+    }
+}
+
+bool MemoryGeneric::restoreState(SnapshotReader *rd) {
+    uint64_t sz;
+    if (!rd->read(&sz, sizeof(sz)) || sz != getLength() || rd->left() < sz) {
+        return false;
+    }
+    // Keep in-memory snapshot valid
+    markDirty(0, sz);
+    return rd->read(mem_, static_cast<unsigned>(sz));
+}
+
+void MemoryGeneric::takeSnapshot() {
+    if (mem_ == NULL) {
+        return;
+    }
+    if (pages_ == NULL) {
+        // Page copies are allocated on the first write after snapshot
+        pages_ = new uint8_t *[static_cast<size_t>(pageTotal_)];
+        memset(pages_, 0, static_cast<size_t>(pageTotal_) * sizeof(uint8_t *));
+    }
+    memset(const_cast<uint8_t *>(dirty_), 0, static_cast<size_t>(pageTotal_));
+    cowActive_ = true;
+}
+
+bool MemoryGeneric::rewindSnapshot() {
+    if (!cowActive_) {
+        return false;
+    }
+    uint64_t cnt = 0;
+    for (uint64_t pg = 0; pg < pageTotal_; pg++) {
+        if (!dirty_[pg]) {
+            continue;
+        }
+        uint64_t off = pg << PAGE_SHIFT;
+        uint64_t sz = getLength() - off < PAGE_SIZE ? getLength() - off
+                                                     : PAGE_SIZE;
+        memcpy(&mem_[off], pages_[pg], static_cast<size_t>(sz));
+        dirty_[pg] = 0;
+        cnt++;
+    }
+    RISCV_info("Rewound %" RV_PRI64 "d pages", cnt);
+    return true;
+}
+
+void MemoryGeneric::copyPage(uint64_t pg) {
+    RISCV_mutex_lock(&mutexPage_);
+    if (!dirty_[pg]) {
+        uint64_t off = pg << PAGE_SHIFT;
+        uint64_t sz = getLength() - off < PAGE_SIZE ? getLength() - off
+                                                     : PAGE_SIZE;
+        if (pages_[pg] == NULL) {
+            pages_[pg] = new uint8_t[PAGE_SIZE];
+        }
+        memcpy(pages_[pg], &mem_[off], static_cast<size_t>(sz));
+        RISCV_memory_barrier();
+        dirty_[pg] = 1;
+    }
+    RISCV_mutex_unlock(&mutexPage_);
+}
+
 }  // namespace debugger
@@ -20,11 +20,21 @@
 #include "iclass.h"
 #include "iservice.h"
 #include "coreservices/imemop.h"
+#include "coreservices/isnapshot.h"
 
 namespace debugger {
 
+/**
+ * @brief Generic RAM/ROM device.
+ *
+ * In-memory snapshot is copy-on-write: takeSnapshot() only clears the map
+ * of dirty pages and each page is copied on the first write after that, so
+ * the snapshot and rewind cost is proportional to the number of modified
+ * pages. Until the first snapshot all pages are dirty.
+ */
 class MemoryGeneric : public IService, 
-                      public IMemoryOperation {
+                      public IMemoryOperation,
+                      public ISnapshot {
  public:
     MemoryGeneric(const char *name);
     ~MemoryGeneric();
@@ -34,10 +44,48 @@ class MemoryGeneric : public IService,
 
     /** IMemoryOperation */
     virtual ETransStatus b_transport(Axi4TransactionType *trans);
+    virtual bool getDmiPointer(Axi4TransactionType *trans,
+                               DmiRegionType *dmi);
+    virtual bool isThreadSafe() { return true; }
+
+    /** ISnapshot */
+    virtual void saveState(AutoBuffer *buf);
+    virtual bool restoreState(SnapshotReader *rd);
+    virtual void takeSnapshot();
+    virtual bool hasSnapshot() { return cowActive_; }
+    virtual bool rewindSnapshot();
+
+ protected:
+    /** Copy pages of the range [off, off + sz) before modification */
+    void markDirty(uint64_t off, uint64_t sz) {
+        uint64_t pg = off >> PAGE_SHIFT;
+        uint64_t pgend = (off + sz - 1) >> PAGE_SHIFT;
+        for (; pg <= pgend; pg++) {
+            if (!dirty_[pg]) {
+                copyPage(pg);
+            }
+        }
+    }
+    void copyPage(uint64_t pg);
+
+    /**
+     * Map binary file copy-on-write at the beginning of the memory.
+     * Return false if file can't be mapped.
+     */
+    bool mapFile(const char *filename);
 
  protected:
+    static const int PAGE_SHIFT = DMI_PAGE_SHIFT;
+    static const unsigned PAGE_SIZE = 1u << PAGE_SHIFT;
+
     AttributeType readOnly_;
     uint8_t *mem_;
+
+    volatile uint8_t *dirty_;   // page was modified after the snapshot
+    uint8_t **pages_;           // copy of the modified pages
+    uint64_t pageTotal_;
+    bool cowActive_;            // takeSnapshot() was called
+    mutex_def mutexPage_;
 };
 
 }  // namespace debugger
@@ -0,0 +1,262 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "symbol_index.h"
+#include "coreservices/isrccode.h"
+
+namespace debugger {
+
+/** Sorting items; index makes the order of equal keys deterministic */
+struct SymbolAddrKeyType {
+    uint64_t addr;
+    unsigned idx;
+};
+
+struct SymbolNameKeyType {
+    const char *name;
+    unsigned idx;
+};
+
+static int cmpAddr(const void *a, const void *b) {
+    const SymbolAddrKeyType *x = static_cast<const SymbolAddrKeyType *>(a);
+    const SymbolAddrKeyType *y = static_cast<const SymbolAddrKeyType *>(b);
+    if (x->addr != y->addr) {
+        return x->addr < y->addr ? -1 : 1;
+    }
+    return x->idx < y->idx ? -1 : x->idx > y->idx;
+}
+
+static int cmpName(const void *a, const void *b) {
+    const SymbolNameKeyType *x = static_cast<const SymbolNameKeyType *>(a);
+    const SymbolNameKeyType *y = static_cast<const SymbolNameKeyType *>(b);
+    int ret = strcmp(x->name, y->name);
+    if (ret != 0) {
+        return ret;
+    }
+    return x->idx < y->idx ? -1 : x->idx > y->idx;
+}
+
+/** FNV-1a */
+static unsigned hashString(const char *s) {
+    unsigned h = 2166136261u;
+    while (*s) {
+        h = (h ^ static_cast<uint8_t>(*s++)) * 16777619u;
+    }
+    return h;
+}
+
+SymbolIndex::SymbolIndex() {
+    rec_ = NULL;
+    cnt_ = max_ = 0;
+    pool_ = NULL;
+    poolCnt_ = poolMax_ = 0;
+    hash_ = NULL;
+    hashMax_ = 0;
+    byAddr_ = NULL;
+    byName_ = NULL;
+    sorted_ = true;
+}
+
+SymbolIndex::~SymbolIndex() {
+    clear();
+}
+
+void SymbolIndex::clear() {
+    delete [] rec_;
+    delete [] pool_;
+    delete [] hash_;
+    delete [] byAddr_;
+    delete [] byName_;
+    rec_ = NULL;
+    cnt_ = max_ = 0;
+    pool_ = NULL;
+    poolCnt_ = poolMax_ = 0;
+    hash_ = NULL;
+    hashMax_ = 0;
+    byAddr_ = NULL;
+    byName_ = NULL;
+    sorted_ = true;
+}
+
+int SymbolIndex::lookup(const char *name) {
+    if (hashMax_ == 0) {
+        return -1;
+    }
+    unsigned h = hashString(name) & (hashMax_ - 1);
+    while (hash_[h] >= 0) {
+        if (strcmp(&pool_[rec_[hash_[h]].name], name) == 0) {
+            return hash_[h];
+        }
+        h = (h + 1) & (hashMax_ - 1);
+    }
+    return -1;
+}
+
+void SymbolIndex::addHash(unsigned idx) {
+    if (2 * (cnt_ + 1) > hashMax_) {
+        // Keep load factor below 1/2
+        delete [] hash_;
+        hashMax_ = hashMax_ ? 2 * hashMax_ : 1024;
+        hash_ = new int[hashMax_];
+        memset(hash_, 0xFF, hashMax_ * sizeof(int));
+        for (unsigned i = 0; i < idx; i++) {
+            if (lookup(&pool_[rec_[i].name]) < 0) {
+                addHash(i);
+            }
+        }
+    }
+    unsigned h = hashString(&pool_[rec_[idx].name]) & (hashMax_ - 1);
+    while (hash_[h] >= 0) {
+        h = (h + 1) & (hashMax_ - 1);
+    }
+    hash_[h] = static_cast<int>(idx);
+}
+
+void SymbolIndex::add(const char *name, uint64_t addr, uint64_t sz,
+                      uint64_t type) {
+    if (cnt_ == max_) {
+        max_ = max_ ? 2 * max_ : 1024;
+        SymbolRecordType *t = new SymbolRecordType[max_];
+        if (rec_) {
+            memcpy(t, rec_, cnt_ * sizeof(SymbolRecordType));
+            delete [] rec_;
+        }
+        rec_ = t;
+    }
+    SymbolRecordType &r = rec_[cnt_];
+    r.addr = addr;
+    r.size = sz;
+    r.type = type;
+
+    // The first symbol with the same name is used by find()
+    int same = lookup(name);
+    if (same >= 0) {
+        r.name = rec_[same].name;
+        cnt_++;
+    } else {
+        unsigned len = static_cast<unsigned>(strlen(name)) + 1;
+        if (poolCnt_ + len > poolMax_) {
+            poolMax_ = poolMax_ ? 2 * poolMax_ : 16384;
+            while (poolCnt_ + len > poolMax_) {
+                poolMax_ *= 2;
+            }
+            char *t = new char[poolMax_];
+            if (pool_) {
+                memcpy(t, pool_, poolCnt_);
+                delete [] pool_;
+            }
+            pool_ = t;
+        }
+        memcpy(&pool_[poolCnt_], name, len);
+        r.name = poolCnt_;
+        poolCnt_ += len;
+        addHash(cnt_);
+        cnt_++;
+    }
+    sorted_ = false;
+}
+
+void SymbolIndex::add(AttributeType *list) {
+    for (unsigned i = 0; i < list->size(); i++) {
+        AttributeType &item = (*list)[i];
+        uint64_t type = 0;
+        if (item.size() > static_cast<unsigned>(Symbol_Type)) {
+            type = item[Symbol_Type].to_uint64();
+        }
+        add(item[Symbol_Name].to_string(), item[Symbol_Addr].to_uint64(),
+            item[Symbol_Size].to_uint64(), type);
+    }
+}
+
+void SymbolIndex::build() {
+    delete [] byAddr_;
+    delete [] byName_;
+    byAddr_ = new unsigned[cnt_ + 1];
+    byName_ = new unsigned[cnt_ + 1];
+
+    SymbolAddrKeyType *akey = new SymbolAddrKeyType[cnt_ + 1];
+    SymbolNameKeyType *nkey = new SymbolNameKeyType[cnt_ + 1];
+    for (unsigned i = 0; i < cnt_; i++) {
+        akey[i].addr = rec_[i].addr;
+        akey[i].idx = i;
+        nkey[i].name = &pool_[rec_[i].name];
+        nkey[i].idx = i;
+    }
+    qsort(akey, cnt_, sizeof(SymbolAddrKeyType), cmpAddr);
+    qsort(nkey, cnt_, sizeof(SymbolNameKeyType), cmpName);
+    for (unsigned i = 0; i < cnt_; i++) {
+        byAddr_[i] = akey[i].idx;
+        byName_[i] = nkey[i].idx;
+    }
+    delete [] akey;
+    delete [] nkey;
+    sorted_ = true;
+}
+
+int SymbolIndex::find(const char *name, uint64_t *addr) {
+    int idx = lookup(name);
+    if (idx < 0) {
+        return -1;
+    }
+    *addr = rec_[idx].addr;
+    return 0;
+}
+
+const char *SymbolIndex::findAddress(uint64_t addr, uint64_t *offset) {
+    if (!sorted_) {
+        build();
+    }
+    // Last symbol with start address <= addr
+    unsigned lo = 0, hi = cnt_;
+    while (lo < hi) {
+        unsigned mid = (lo + hi) / 2;
+        if (rec_[byAddr_[mid]].addr <= addr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) {
+        return NULL;
+    }
+    SymbolRecordType &r = rec_[byAddr_[lo - 1]];
+    if (lo == cnt_ && addr >= r.addr + r.size) {
+        return NULL;
+    }
+    *offset = addr - r.addr;
+    return &pool_[r.name];
+}
+
+void SymbolIndex::getList(AttributeType *list) {
+    if (!sorted_) {
+        build();
+    }
+    list->make_list(cnt_);
+    for (unsigned i = 0; i < cnt_; i++) {
+        SymbolRecordType &r = rec_[byName_[i]];
+        AttributeType &item = (*list)[i];
+        item.make_list(Symbol_Total);
+        item[Symbol_Name].make_string(&pool_[r.name]);
+        item[Symbol_Addr].make_uint64(r.addr);
+        item[Symbol_Size].make_uint64(r.size);
+        item[Symbol_Type].make_uint64(r.type);
+    }
+}
+
+}  // namespace debugger
@@ -0,0 +1,80 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef __DEBUGGER_COMMON_GENERIC_SYMBOL_INDEX_H__
+#define __DEBUGGER_COMMON_GENERIC_SYMBOL_INDEX_H__
+
+#include <inttypes.h>
+#include <attribute.h>
+
+namespace debugger {
+
+/**
+ * @brief Table of the debug symbols.
+ *
+ * Symbols are stored as plain records with the names interned into the
+ * single string pool. Names are looked up via hash table, addresses via
+ * binary search in the array sorted by address where each symbol covers
+ * range up to the next symbol. Sorted arrays are rebuilt once on the first
+ * request after new symbols were added.
+ */
+class SymbolIndex {
+ public:
+    SymbolIndex();
+    ~SymbolIndex();
+
+    void clear();
+    void add(const char *name, uint64_t addr, uint64_t sz, uint64_t type);
+    /** Add list of [name, addr, size, type] items */
+    void add(AttributeType *list);
+
+    /** Return 0 if symbol was found */
+    int find(const char *name, uint64_t *addr);
+    /** Return name of symbol containing address or NULL */
+    const char *findAddress(uint64_t addr, uint64_t *offset);
+    /** Get list of [name, addr, size, type] items sorted by name */
+    void getList(AttributeType *list);
+
+ private:
+    struct SymbolRecordType {
+        unsigned name;          // offset in the string pool
+        uint64_t addr;
+        uint64_t size;
+        uint64_t type;
+    };
+
+    int lookup(const char *name);
+    void addHash(unsigned idx);
+    void build();
+
+ private:
+    SymbolRecordType *rec_;     // in order of adding
+    unsigned cnt_;
+    unsigned max_;
+    char *pool_;
+    unsigned poolCnt_;
+    unsigned poolMax_;
+    int *hash_;                 // record index or -1
+    unsigned hashMax_;          // power of 2
+    unsigned *byAddr_;
+    unsigned *byName_;
+    bool sorted_;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_GENERIC_SYMBOL_INDEX_H__
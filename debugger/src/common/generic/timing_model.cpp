@@ -0,0 +1,175 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include "timing_model.h"
+
+namespace debugger {
+
+static bool timing_is_pow2(uint32_t v) {
+    return v != 0 && (v & (v - 1)) == 0;
+}
+
+/**
+ * Disabled cache never misses: all addresses below 2^63 have the same
+ * line index 0 that is equal to the last accessed line.
+ */
+CacheModel::CacheModel() {
+    tags_ = 0;
+    sets_ = 0;
+    ways_ = 0;
+    lineShift_ = 63;
+    penalty_ = 0;
+    lastLine_ = 0;
+}
+
+CacheModel::~CacheModel() {
+    delete [] tags_;
+}
+
+bool CacheModel::init(uint32_t size, uint32_t ways, uint32_t line,
+                      uint32_t penalty) {
+    if (!timing_is_pow2(size) || !timing_is_pow2(ways)
+        || !timing_is_pow2(line) || size < ways * line) {
+        return false;
+    }
+    ways_ = ways;
+    sets_ = size / (ways * line);
+    lineShift_ = 0;
+    while ((1u << lineShift_) < line) {
+        lineShift_++;
+    }
+    penalty_ = penalty;
+    tags_ = new uint64_t[sets_ * ways_];
+    memset(tags_, 0xFF, sets_ * ways_ * sizeof(uint64_t));
+    lastLine_ = ~0ull;
+    return true;
+}
+
+uint32_t CacheModel::lookup(uint64_t line) {
+    if (tags_ == 0) {
+        return 0;
+    }
+    uint64_t *set = &tags_[(line & (sets_ - 1)) * ways_];
+    uint32_t i = 0;
+    while (i < ways_ - 1 && set[i] != line) {
+        i++;
+    }
+    uint32_t ret = set[i] == line ? 0 : penalty_;
+    // Move to front, the last way is replaced on miss
+    for (; i > 0; i--) {
+        set[i] = set[i - 1];
+    }
+    set[0] = line;
+    return ret;
+}
+
+
+BranchPredictorModel::BranchPredictorModel() {
+    btb_ = 0;
+    btbMask_ = 0;
+    counters_ = 0;
+    cntMask_ = 0;
+    penalty_ = 0;
+}
+
+BranchPredictorModel::~BranchPredictorModel() {
+    delete [] btb_;
+    delete [] counters_;
+}
+
+bool BranchPredictorModel::init(uint32_t btb, uint32_t counters,
+                                uint32_t penalty) {
+    if (!timing_is_pow2(btb) || !timing_is_pow2(counters)) {
+        return false;
+    }
+    btb_ = new BtbEntryType[btb];
+    for (uint32_t i = 0; i < btb; i++) {
+        btb_[i].pc = ~0ull;
+        btb_[i].target = 0;
+    }
+    btbMask_ = btb - 1;
+    counters_ = new uint8_t[counters];
+    memset(counters_, 1, counters);     // weakly not taken
+    cntMask_ = counters - 1;
+    penalty_ = penalty;
+    return true;
+}
+
+
+TimingModel::TimingModel() {
+    for (unsigned i = 0; i < LAT_CACHE_SIZE; i++) {
+        latCache_[i].instr = 0;
+        latCache_[i].cycles = 0;
+    }
+    bpEnabled_ = false;
+    latency_.make_list(0);
+    stalls_ = 0;
+}
+
+const char *TimingModel::init(const AttributeType &icache,
+                              const AttributeType &dcache,
+                              const AttributeType &bp,
+                              const AttributeType &latency) {
+    if (icache.is_list() && icache.size() == 4) {
+        if (!icache_.init(icache[0u].to_uint32(), icache[1].to_uint32(),
+                          icache[2].to_uint32(), icache[3].to_uint32())) {
+            return "Wrong instruction cache geometry";
+        }
+    } else if (icache.size()) {
+        return "Wrong instruction cache settings";
+    }
+    if (dcache.is_list() && dcache.size() == 4) {
+        if (!dcache_.init(dcache[0u].to_uint32(), dcache[1].to_uint32(),
+                          dcache[2].to_uint32(), dcache[3].to_uint32())) {
+            return "Wrong data cache geometry";
+        }
+    } else if (dcache.size()) {
+        return "Wrong data cache settings";
+    }
+    if (bp.is_list() && bp.size() == 3) {
+        if (!bp_.init(bp[0u].to_uint32(), bp[1].to_uint32(),
+                      bp[2].to_uint32())) {
+            return "Wrong branch predictor settings";
+        }
+        bpEnabled_ = true;
+    } else if (bp.size()) {
+        return "Wrong branch predictor settings";
+    }
+    for (unsigned i = 0; i < latency.size(); i++) {
+        const AttributeType &item = latency[i];
+        if (!item.is_list() || item.size() != 2 || !item[0u].is_string()) {
+            return "Wrong instruction latency settings";
+        }
+    }
+    latency_ = latency;
+    return 0;
+}
+
+uint32_t TimingModel::findLatency(GenericInstruction *instr) {
+    if (instr == 0) {
+        return 0;
+    }
+    const char *name = instr->name();
+    for (unsigned i = 0; i < latency_.size(); i++) {
+        if (strcmp(latency_[i][0u].to_string(), name) == 0) {
+            return latency_[i][1].to_uint32();
+        }
+    }
+    return 0;
+}
+
+}  // namespace debugger
@@ -0,0 +1,172 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_COMMON_GENERIC_TIMING_MODEL_H__
+#define __DEBUGGER_COMMON_GENERIC_TIMING_MODEL_H__
+
+#include <inttypes.h>
+#include <attribute.h>
+#include "coreservices/icpufunctional.h"
+
+namespace debugger {
+
+/**
+ * @brief Set-associative cache with LRU replacement.
+ *
+ * Only tags are modelled: each miss costs the fixed penalty, writes
+ * allocate lines and write-back traffic isn't counted.
+ */
+class CacheModel {
+ public:
+    CacheModel();
+    ~CacheModel();
+
+    /** Sizes must be power of 2. Return false on wrong geometry */
+    bool init(uint32_t size, uint32_t ways, uint32_t line, uint32_t penalty);
+
+    /** Return stall cycles of the access */
+    uint32_t access(uint64_t addr) {
+        uint64_t line = addr >> lineShift_;
+        if (line == lastLine_) {
+            // The most recently used line of its set
+            return 0;
+        }
+        lastLine_ = line;
+        return lookup(line);
+    }
+
+ private:
+    uint32_t lookup(uint64_t line);
+
+ private:
+    uint64_t *tags_;            // [set][way], the first way is MRU
+    uint32_t sets_;
+    uint32_t ways_;
+    int lineShift_;
+    uint32_t penalty_;
+    uint64_t lastLine_;
+};
+
+/**
+ * @brief Branch target buffer with the bimodal 2-bit counters.
+ *
+ * Instructions are identified as branches when they transfer control at
+ * least once, so the model doesn't depend on ISA. Taken prediction
+ * requires BTB hit, the wrong target is counted as misprediction.
+ */
+class BranchPredictorModel {
+ public:
+    BranchPredictorModel();
+    ~BranchPredictorModel();
+
+    /** Sizes must be power of 2. Return false on wrong settings */
+    bool init(uint32_t btb, uint32_t counters, uint32_t penalty);
+
+    /** Return stall cycles after instruction at 'pc' with the next 'npc' */
+    uint32_t update(uint64_t pc, unsigned oplen, uint64_t npc) {
+        BtbEntryType &e = btb_[(pc >> 1) & btbMask_];
+        uint8_t &cnt = counters_[(pc >> 1) & cntMask_];
+        uint64_t seq = pc + oplen;
+        bool hit = e.pc == pc;
+        uint64_t predicted = hit && cnt >= 2 ? e.target : seq;
+        if (npc != seq) {
+            e.pc = pc;
+            e.target = npc;
+            if (cnt < 3) {
+                cnt++;
+            }
+        } else if (hit && cnt > 0) {
+            cnt--;
+        }
+        return predicted == npc ? 0 : penalty_;
+    }
+
+ private:
+    struct BtbEntryType {
+        uint64_t pc;
+        uint64_t target;
+    };
+    BtbEntryType *btb_;
+    uint64_t btbMask_;
+    uint8_t *counters_;
+    uint64_t cntMask_;
+    uint32_t penalty_;
+};
+
+/**
+ * @brief Timing models of the functional CPU.
+ *
+ * Every executed instruction takes one clock plus the stall cycles of
+ * the enabled models: instruction cache, branch predictor and additional
+ * latency of the instruction. Data cache stalls are added on each memory
+ * access of the instruction.
+ */
+class TimingModel {
+ public:
+    TimingModel();
+
+    /**
+     * Settings are the CPU attributes:
+     *   icache, dcache:    [size, ways, line size, miss penalty] or [];
+     *   bp:                [BTB entries, counters, miss penalty] or [];
+     *   latency:           [[instruction name, additional cycles], *].
+     *
+     * @return NULL on success or error description
+     */
+    const char *init(const AttributeType &icache, const AttributeType &dcache,
+                     const AttributeType &bp, const AttributeType &latency);
+
+    void instruction(uint64_t pc, GenericInstruction *instr, unsigned oplen,
+                     uint64_t npc) {
+        LatencyCacheType &e = latCache_[(reinterpret_cast<uintptr_t>(instr)
+                                         >> 4) & (LAT_CACHE_SIZE - 1)];
+        if (e.instr != instr) {
+            e.instr = instr;
+            e.cycles = findLatency(instr);
+        }
+        stalls_ += e.cycles + icache_.access(pc);
+        if (bpEnabled_) {
+            stalls_ += bp_.update(pc, oplen, npc);
+        }
+    }
+
+    void dataAccess(uint64_t addr) {
+        stalls_ += dcache_.access(addr);
+    }
+
+    uint64_t getStallCycles() { return stalls_; }
+
+ private:
+    uint32_t findLatency(GenericInstruction *instr);
+
+ private:
+    static const unsigned LAT_CACHE_SIZE = 256;
+    struct LatencyCacheType {
+        GenericInstruction *instr;
+        uint32_t cycles;
+    } latCache_[LAT_CACHE_SIZE];
+
+    CacheModel icache_;
+    CacheModel dcache_;
+    BranchPredictorModel bp_;
+    bool bpEnabled_;
+    AttributeType latency_;
+    uint64_t stalls_;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_GENERIC_TIMING_MODEL_H__
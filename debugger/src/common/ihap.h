@@ -30,7 +30,8 @@ enum EHapType {
     HAP_Halt,
     HAP_BreakSimulation,
     HAP_CpuTurnON,
-    HAP_CpuTurnOFF
+    HAP_CpuTurnOFF,
+    HAP_MemoryMap
 };
 
 class IHap : public IFace {
@@ -148,6 +148,12 @@ class IService : public IFace {
 
     virtual const char *getObjName() { return obj_name_.to_string(); }
 
+    /**
+     * Current level is read inline by RISCV_log() without the attribute
+     * or interface lookup
+     */
+    int getLogLevel() { return logLevel_.to_int(); }
+
     virtual AttributeType getConfiguration() {
         AttributeType ret(Attr_Dict);
         ret["Name"] = AttributeType(getObjName());
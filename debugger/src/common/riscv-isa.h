@@ -502,6 +502,8 @@ static const uint16_t CSR_mcause        = 0x342;
 static const uint16_t CSR_mbadaddr      = 0x343;
 /** Machine interrupt pending */
 static const uint16_t CSR_mip           = 0x344;
+/** Debug control and status, bits[1:0] privilege level. Debug port only */
+static const uint16_t CSR_dcsr          = 0x7b0;
 /// @}
 
 /** Exceptions */
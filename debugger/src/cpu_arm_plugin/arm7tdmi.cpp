@@ -1407,6 +1407,42 @@ void CpuCortex_Functional::addArm7tmdiIsa() {
     isaTableArmV7_[ARMV7_SDIV] = new SDIV(this);
     isaTableArmV7_[ARMV7_BFC] = new BFC(this);
     isaTableArmV7_[ARMV7_BFI] = new BFI(this);
+
+    // Instruction mix classes, all others are counted as ALU:
+    isaTableArmV7_[ARMV7_B]->setMixType(InstrMix_BranchNotTaken,
+                                        InstrMix_BranchTaken);
+    isaTableArmV7_[ARMV7_BX]->setMixType(InstrMix_BranchNotTaken,
+                                         InstrMix_BranchTaken);
+    isaTableArmV7_[ARMV7_BL]->setMixType(InstrMix_BranchNotTaken,
+                                         InstrMix_BranchTaken);
+    isaTableArmV7_[ARMV7_BLX]->setMixType(InstrMix_BranchNotTaken,
+                                          InstrMix_BranchTaken);
+    const EIsaArmV7 LOADS[] = {
+        ARMV7_LDR, ARMV7_LDRB, ARMV7_LDRH, ARMV7_LDRSB, ARMV7_LDRSH,
+        ARMV7_LDM, ARMV7_LDRD
+    };
+    for (unsigned i = 0; i < sizeof(LOADS) / sizeof(LOADS[0]); i++) {
+        isaTableArmV7_[LOADS[i]]->setMixType(InstrMix_Load);
+    }
+    const EIsaArmV7 STORES[] = {
+        ARMV7_STR, ARMV7_STRB, ARMV7_STRH, ARMV7_STM, ARMV7_STRD
+    };
+    for (unsigned i = 0; i < sizeof(STORES) / sizeof(STORES[0]); i++) {
+        isaTableArmV7_[STORES[i]]->setMixType(InstrMix_Store);
+    }
+    const EIsaArmV7 MULDIV[] = {
+        ARMV7_MUL, ARMV7_MLA, ARMV7_UMULL, ARMV7_UMLAL, ARMV7_SMULL,
+        ARMV7_SMLAL, ARMV7_UDIV, ARMV7_SDIV
+    };
+    for (unsigned i = 0; i < sizeof(MULDIV) / sizeof(MULDIV[0]); i++) {
+        isaTableArmV7_[MULDIV[i]]->setMixType(InstrMix_MulDiv);
+    }
+    isaTableArmV7_[ARMV7_SWP]->setMixType(InstrMix_Atomic);
+    isaTableArmV7_[ARMV7_MRS]->setMixType(InstrMix_Csr);
+    isaTableArmV7_[ARMV7_MSR]->setMixType(InstrMix_Csr);
+    isaTableArmV7_[ARMV7_MRC]->setMixType(InstrMix_Csr);
+    isaTableArmV7_[ARMV7_MCR]->setMixType(InstrMix_Csr);
+    isaTableArmV7_[ARMV7_SWI]->setMixType(InstrMix_System);
 }
 
 }  // namespace debugger
@@ -69,6 +69,10 @@ void CpuCortex_Functional::predeleteService() {
 
 void CpuCortex_Functional::hapTriggered(IFace *isrc, EHapType type,
                                         const char *descr) {
+    if (type != HAP_ConfigDone) {
+        CpuGeneric::hapTriggered(isrc, type, descr);
+        return;
+    }
     AttributeType srvlist;
     RISCV_get_services_with_iface(IFACE_RESET, &srvlist);
     IService *iserv;
@@ -103,6 +107,8 @@ void CpuCortex_Functional::handleTrap() {
             halt("SWI Breakpoint");
             return;
         }
+        // Counted by the exception vector index: SWI uses 0x08
+        trackTrap(0, 2);
     }
     npc_.setValue(0 + 4*0);
     interrupt_pending_[0] = 0;
@@ -117,6 +123,15 @@ void CpuCortex_Functional::reset(bool active) {
     estate_ = CORE_Halted;
 }
 
+void CpuCortex_Functional::saveState(AutoBuffer *buf) {
+    CpuGeneric::saveState(buf);
+    saveBank(buf, &portRegs_);
+}
+
+bool CpuCortex_Functional::restoreState(SnapshotReader *rd) {
+    return CpuGeneric::restoreState(rd) && restoreBank(rd, &portRegs_);
+}
+
 GenericInstruction *CpuCortex_Functional::decodeInstruction(Reg64Type *cache) {
     ArmInstruction *instr = NULL;
     uint32_t ti = cacheline_[0].buf32[0];
@@ -158,6 +173,11 @@ void CpuCortex_Functional::trackContextStart() {
 void CpuCortex_Functional::trackContextEnd() {
     CpuGeneric::trackContextEnd();
 
+    if (binTraceRegs_) {
+        binTrace_->traceRegs(step_cnt_, pc_.getValue().val,
+                             portSavedRegs_.getpR64(), portRegs_.getpR64());
+        return;
+    }
     if (reg_trace_file == 0) {
         return;
     }
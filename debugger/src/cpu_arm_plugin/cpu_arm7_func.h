@@ -43,6 +43,10 @@ class CpuCortex_Functional : public CpuGeneric,
     /** IResetListener interface */
     virtual void reset(bool active);
 
+    /** ISnapshot */
+    virtual void saveState(AutoBuffer *buf);
+    virtual bool restoreState(SnapshotReader *rd);
+
     /** ICpuGeneric interface */
     virtual void raiseSignal(int idx);
     virtual void lowerSignal(int idx);
@@ -80,6 +84,10 @@ class CpuCortex_Functional : public CpuGeneric,
     virtual void trackContextStart();
     /** // Stop tracking and write trace file */
     virtual void trackContextEnd() override;
+    virtual const char *const *getTraceRegNames(int *total) {
+        *total = Reg_spsr + 1;
+        return IREGS_NAMES;
+    }
 
     void addArm7tmdiIsa();
     unsigned addSupportedInstruction(ArmInstruction *instr);
@@ -20,6 +20,8 @@
 #include <iclass.h>
 #include <iservice.h>
 #include "coreservices/isrccode.h"
+#include "generic/symbol_index.h"
+#include "generic/breakpoint_index.h"
 
 namespace debugger {
 
@@ -44,7 +46,7 @@ class ArmSourceService : public IService,
     virtual void clearSymbols();
 
     virtual void getSymbols(AttributeType *list) {
-        *list = symbolListSortByName_;
+        symbols_.getList(list);
     }
 
     virtual void addressToSymbol(uint64_t addr, AttributeType *info);
@@ -108,8 +110,8 @@ class ArmSourceService : public IService,
  private:
     AttributeType endianess_;
     AttributeType brList_;
-    AttributeType symbolListSortByName_;
-    AttributeType symbolListSortByAddr_;
+    BreakpointIndex brIndex_;       // fast check of brList_ addresses
+    SymbolIndex symbols_;
 };
 
 DECLARE_CLASS(ArmSourceService)
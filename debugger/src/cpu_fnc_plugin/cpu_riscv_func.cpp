@@ -20,6 +20,89 @@
 
 namespace debugger {
 
+/** Instruction mix classes by the ISA table name */
+struct MixNameType {
+    const char *name;
+    EInstrMixType type;
+};
+static const MixNameType MIX_EXACT[] = {
+    {"LD", InstrMix_Load}, {"LW", InstrMix_Load}, {"LWU", InstrMix_Load},
+    {"LH", InstrMix_Load}, {"LHU", InstrMix_Load}, {"LB", InstrMix_Load},
+    {"LBU", InstrMix_Load}, {"C_LD", InstrMix_Load},
+    {"C_LDSP", InstrMix_Load}, {"C_LW", InstrMix_Load},
+    {"C_LWSP", InstrMix_Load},
+    {"SD", InstrMix_Store}, {"SW", InstrMix_Store},
+    {"SH", InstrMix_Store}, {"SB", InstrMix_Store},
+    {"C_SD", InstrMix_Store}, {"C_SDSP", InstrMix_Store},
+    {"C_SW", InstrMix_Store}, {"C_SWSP", InstrMix_Store},
+    {"JAL", InstrMix_Jump}, {"JALR", InstrMix_Jump},
+    {"C_J", InstrMix_Jump}, {"C_JAL", InstrMix_Jump},
+    {"C_JALR", InstrMix_Jump}, {"C_JR", InstrMix_Jump},
+    {"ECALL", InstrMix_System}, {"EBREAK", InstrMix_System},
+    {"C_EBREAK", InstrMix_System}, {"URET", InstrMix_System},
+    {"SRET", InstrMix_System}, {"HRET", InstrMix_System},
+    {"MRET", InstrMix_System}, {"FENCE", InstrMix_System},
+    {"FENCE_I", InstrMix_System},
+};
+static const MixNameType MIX_PREFIX[] = {
+    {"CSRR", InstrMix_Csr}, {"MUL", InstrMix_MulDiv},
+    {"DIV", InstrMix_MulDiv}, {"REM", InstrMix_MulDiv},
+    {"F", InstrMix_Fpu},
+};
+static const char *const MIX_BRANCH[] = {
+    "BEQ", "BNE", "BLT", "BLTU", "BGE", "BGEU", "C_BEQZ", "C_BNEZ"
+};
+
+static void riscv_set_mix_type(RiscvInstruction *instr) {
+    const char *name = instr->name();
+    for (unsigned i = 0; i < sizeof(MIX_BRANCH) / sizeof(MIX_BRANCH[0]); i++) {
+        if (strcmp(name, MIX_BRANCH[i]) == 0) {
+            instr->setMixType(InstrMix_BranchNotTaken, InstrMix_BranchTaken);
+            return;
+        }
+    }
+    for (unsigned i = 0; i < sizeof(MIX_EXACT) / sizeof(MIX_EXACT[0]); i++) {
+        if (strcmp(name, MIX_EXACT[i].name) == 0) {
+            instr->setMixType(MIX_EXACT[i].type);
+            return;
+        }
+    }
+    for (unsigned i = 0; i < sizeof(MIX_PREFIX) / sizeof(MIX_PREFIX[0]); i++) {
+        if (strncmp(name, MIX_PREFIX[i].name,
+                    strlen(MIX_PREFIX[i].name)) == 0) {
+            instr->setMixType(MIX_PREFIX[i].type);
+            return;
+        }
+    }
+    instr->setMixType(InstrMix_Alu);
+}
+
+/** Return the first name of the mix tables missing in the ISA table */
+static const char *riscv_check_mix_names(RiscvDecoder *decoder) {
+    for (unsigned i = 0; i < sizeof(MIX_BRANCH) / sizeof(MIX_BRANCH[0]); i++) {
+        if (decoder->index(MIX_BRANCH[i]) < 0) {
+            return MIX_BRANCH[i];
+        }
+    }
+    for (unsigned i = 0; i < sizeof(MIX_EXACT) / sizeof(MIX_EXACT[0]); i++) {
+        if (decoder->index(MIX_EXACT[i].name) < 0) {
+            return MIX_EXACT[i].name;
+        }
+    }
+    for (unsigned i = 0; i < sizeof(MIX_PREFIX) / sizeof(MIX_PREFIX[0]); i++) {
+        size_t len = strlen(MIX_PREFIX[i].name);
+        int n = 0;
+        while (n < decoder->size()
+            && strncmp(decoder->name(n), MIX_PREFIX[i].name, len) != 0) {
+            n++;
+        }
+        if (n == decoder->size()) {
+            return MIX_PREFIX[i].name;
+        }
+    }
+    return 0;
+}
+
 CpuRiver_Functional::CpuRiver_Functional(const char *name) :
     CpuGeneric(name),
     portRegs_(this, "regs", DSUREG(ureg.v.iregs), Reg_Total),
@@ -28,17 +111,39 @@ CpuRiver_Functional::CpuRiver_Functional(const char *name) :
     registerInterface(static_cast<ICpuRiscV *>(this));
     registerAttribute("ListExtISA", &listExtISA_);
     registerAttribute("VendorID", &vendorID_);
+    registerAttribute("HartID", &hartID_);
     registerAttribute("VectorTable", &vectorTable_);
+    registerAttribute("BlockExecution", &blockExecution_);
+    registerAttribute("Jit", &jitEnable_);
+    hartID_.make_uint64(0);
+    decoder_ = RiscvDecoder::instance();
+    isaInstr_ = new RiscvInstruction *[decoder_->size()];
+    memset(isaInstr_, 0, decoder_->size() * sizeof(RiscvInstruction *));
+    decodedCache_ = 0;
+    blocks_ = 0;
+    jit_ = 0;
 }
 
 CpuRiver_Functional::~CpuRiver_Functional() {
+    delete [] isaInstr_;
+    if (decodedCache_) {
+        delete [] decodedCache_;
+    }
+    if (blocks_) {
+        delete [] blocks_;
+    }
+    if (jit_) {
+        delete jit_;
+    }
 }
 
 void CpuRiver_Functional::postinitService() {
-    // Supported instruction sets:
-    for (int i = 0; i < INSTR_HASH_TABLE_SIZE; i++) {
-        listInstr_[i].make_list(0);
+    const char *unknown = riscv_check_mix_names(decoder_);
+    if (unknown) {
+        RISCV_error("Instruction mix name %s isn't in ISA table", unknown);
     }
+
+    // Supported instruction sets:
     addIsaUserRV64I();
     addIsaPrivilegedRV64I();
     for (unsigned i = 0; i < listExtISA_.size(); i++) {
@@ -58,6 +163,33 @@ void CpuRiver_Functional::postinitService() {
 
     CpuGeneric::postinitService();
 
+    // Log timestamps are taken from the hart 0 independently of the
+    // services creation order
+    if (hartID_.to_uint64() == 0) {
+        RISCV_set_default_clock(static_cast<IClock *>(this));
+    }
+
+    if (memcache_sz_) {
+        decodedCache_ = new RiscvInstruction *[memcache_sz_];
+        memset(decodedCache_, 0, memcache_sz_ * sizeof(RiscvInstruction *));
+        if (blockExecution_.to_bool() || jitEnable_.to_bool()) {
+            blocks_ = new BlockType[BLOCK_TABLE_SIZE];
+            for (int i = 0; i < BLOCK_TABLE_SIZE; i++) {
+                blocks_[i].pc = ~0ull;
+                blocks_[i].len = 0;
+            }
+        }
+        // Translated sequences don't account timing of each instruction
+        if (jitEnable_.to_bool() && !timing_) {
+            jit_ = new JitX64();
+            if (!jit_->isEnabled()) {
+                RISCV_error("JIT isn't supported on this host", NULL);
+                delete jit_;
+                jit_ = 0;
+            }
+        }
+    }
+
     pcmd_br_ = new CmdBrRiscv(itap_);
     icmdexec_->registerCommand(static_cast<ICommand *>(pcmd_br_));
 
@@ -86,8 +218,12 @@ void CpuRiver_Functional::predeleteService() {
 
 unsigned CpuRiver_Functional::addSupportedInstruction(
                                     RiscvInstruction *instr) {
-    AttributeType tmp(instr);
-    listInstr_[instr->hash()].add_to_list(&tmp);
+    if (instr->isaIndex() < 0) {
+        RISCV_error("Instruction %s isn't in ISA table", instr->name());
+        return 1;
+    }
+    riscv_set_mix_type(instr);
+    isaInstr_[instr->isaIndex()] = instr;
     return 0;
 }
 
@@ -117,6 +253,9 @@ void CpuRiver_Functional::handleTrap() {
         }
     }
 
+    trackTrap(static_cast<unsigned>(mcause.bits.irq),
+              static_cast<unsigned>(mcause.bits.code));
+
     // All traps handle via machine mode while CSR mdelegate
     // doesn't setup other.
     // @todo delegating
@@ -143,35 +282,208 @@ void CpuRiver_Functional::reset(bool active) {
     portRegs_.reset();
     portCSR_.reset();
     portCSR_.write(CSR_mvendorid, vendorID_.to_uint64());
+    portCSR_.write(CSR_mhartid, hartID_.to_uint64());
     portCSR_.write(CSR_mtvec, vectorTable_.to_uint64());
 
     cur_prv_level = PRV_M;           // Current privilege level
 }
 
+void CpuRiver_Functional::saveState(AutoBuffer *buf) {
+    CpuGeneric::saveState(buf);
+    saveBank(buf, &portRegs_);
+    saveBank(buf, &portCSR_);
+}
+
+bool CpuRiver_Functional::restoreState(SnapshotReader *rd) {
+    return CpuGeneric::restoreState(rd)
+        && restoreBank(rd, &portRegs_)
+        && restoreBank(rd, &portCSR_);
+}
+
 GenericInstruction *CpuRiver_Functional::decodeInstruction(Reg64Type *cache) {
     RiscvInstruction *instr = NULL;
-    int hash_idx = hash32(cacheline_[0].buf32[0]);
-    for (unsigned i = 0; i < listInstr_[hash_idx].size(); i++) {
-        instr = static_cast<RiscvInstruction *>(
-                        listInstr_[hash_idx][i].to_iface());
-        if (instr->parse(cacheline_[0].buf32)) {
-            break;
+    if (cachable_pc_ && memcache_flag_[cache_offset_]) {
+        // Opcode was taken from memcache_, use previously decoded object
+        return decodedCache_[cache_offset_];
+    }
+    int idx = decoder_->decode(cacheline_[0].buf32[0]);
+    if (idx >= 0) {
+        instr = isaInstr_[idx];
+    }
+    return instr;
+}
+
+void CpuRiver_Functional::updatePipeline() {
+    bool stepping_end = estate_ == CORE_Stepping
+                     && hw_stepping_break_ <= step_cnt_;
+    if (blocks_ == 0 || dport_.valid || stepping_end
+        || (estate_ != CORE_Normal && estate_ != CORE_Stepping)
+        || hw_breakpoint_ || skip_sw_breakpoint_ || edgeCoverage_
+        || reg_trace_file || mem_trace_file || binTrace_) {
+        CpuGeneric::updatePipeline();
+    } else if (!executeBlock()) {
+        CpuGeneric::updatePipeline();
+    }
+}
+
+/**
+ * Execute instructions the same way as CpuGeneric::updatePipeline() does
+ * but without debug port, state and breakpoint checks that are the same
+ * for the whole block. Clock queue is processed only when its next
+ * deadline is reached, stepping mode stops the block on the last step.
+ * Translated sequences are called only when no clock event is scheduled
+ * inside of them.
+ */
+bool CpuRiver_Functional::executeBlock() {
+    uint64_t pc = npc_.getValue().val;
+    BlockType *blk = &blocks_[(pc >> 1) & (BLOCK_TABLE_SIZE - 1)];
+    uint64_t gen = cache_gen_;
+
+    if (blk->pc != pc || blk->gen != gen) {
+        // Build new block from the cached instructions
+        if ((pc & CACHE_MASK_) != CACHE_BASE_ADDR_) {
+            return false;
+        }
+        uint64_t off = pc - CACHE_BASE_ADDR_;
+        uint64_t off_max = static_cast<uint64_t>(memcache_sz_) - 4;
+        int len = 0;
+        // Block ends before the HW breakpoint so that it's checked by the
+        // generic pipeline. Adding/removing breakpoint invalidates blocks.
+        while (len < BLOCK_LENGTH_MAX && off <= off_max
+                && memcache_flag_[off]
+                && !hwBreakpoints_.contains(CACHE_BASE_ADDR_ + off)) {
+            BlockItemType &item = blk->item[len];
+            item.instr = decodedCache_[off];
+            item.opcode = *reinterpret_cast<uint32_t *>(&memcache_[off]);
+            item.oplen = memcache_flag_[off];
+            item.jitcnt = 0;
+            off += item.oplen;
+            len++;
+        }
+        if (len == 0) {
+            return false;
+        }
+        blk->pc = pc;
+        blk->gen = gen;
+        blk->len = len;
+        blk->hits = 0;
+    }
+    if (jit_ && blk->hits < JIT_THRESHOLD && ++blk->hits == JIT_THRESHOLD) {
+        translateBlock(static_cast<int>(blk - blocks_));
+    }
+
+    ECoreState state = estate_;
+    uint64_t step_max = ~0ull;
+    if (state == CORE_Stepping) {
+        step_max = hw_stepping_break_;
+    }
+
+    for (int i = 0; i < blk->len; ) {
+        BlockItemType &item = blk->item[i];
+        if (item.jitcnt && step_cnt_ + item.jitcnt < queue_.getNextTime()
+            && step_cnt_ + item.jitcnt <= step_max) {
+            // Translated instructions cannot branch or raise traps
+            BlockItemType &last = blk->item[i + item.jitcnt - 1];
+            uint64_t npc = npc_.getValue().val + item.jitbytes;
+            item.jit(portRegs_.getpR64());
+            if (isInstrMixEnabled()) {
+                for (int k = i; k < i + item.jitcnt; k++) {
+                    pmix_->instr[blk->item[k].instr->mixType(false)]++;
+                    pmix_->oplen[(blk->item[k].oplen >> 2) & 1]++;
+                }
+            }
+            step_cnt_ += item.jitcnt;
+            i += item.jitcnt;
+            pc_.setValue(npc - last.oplen);
+            npc_.setValue(npc);
+            branch_ = false;
+            cacheline_[0].buf32[0] = last.opcode;
+            instr_ = last.instr;
+            oplen_ = last.oplen;
+        } else {
+            step_cnt_++;
+            i++;
+            pc_.setValue(npc_.getValue());
+            branch_ = false;
+            cacheline_[0].buf32[0] = item.opcode;
+            instr_ = item.instr;
+            oplen_ = instr_->exec(cacheline_);
+            if (!branch_) {
+                npc_.setValue(pc_.getValue().val + oplen_);
+            }
+            trackInstrMix();
+            if (timing_) {
+                timing_->instruction(pc_.getValue().val, instr_, oplen_,
+                                     npc_.getValue().val);
+            }
         }
-        instr = NULL;
-    }
-    // Check compressed instructions:
-    if (instr == NULL) {
-        hash_idx = hash16(cacheline_[0].buf16[0]);
-        for (unsigned i = 0; i < listInstr_[hash_idx].size(); i++) {
-            instr = static_cast<RiscvInstruction *>(
-                            listInstr_[hash_idx][i].to_iface());
-            if (instr->parse(cacheline_[0].buf32)) {
+
+        if (queue_.getNextTime() <= step_cnt_) {
+            updateQueue();
+        }
+        if (interrupt_pending_[0] | interrupt_pending_[1]) {
+            handleTrap();
+            if ((interrupt_pending_[0] | interrupt_pending_[1]) == 0) {
                 break;
             }
-            instr = NULL;
+        }
+        if (branch_ || estate_ != state || step_cnt_ >= step_max
+            || dport_.valid || gen != cache_gen_) {
+            break;
+        }
+    }
+    // Taken branch may target the next instruction, traps change npc
+    // without branch flag
+    if (bbv_ && (branch_
+        || npc_.getValue().val != pc_.getValue().val + oplen_)) {
+        trackBbv();
+    }
+    pc_z_ = pc_.getValue();
+    return true;
+}
+
+/**
+ * Translate sequences of the supported instructions of the hot block into
+ * host code. Sequences shorter than 2 instructions stay in interpreter.
+ */
+void CpuRiver_Functional::translateBlock(int idx) {
+    BlockType *blk = &blocks_[idx];
+    uint64_t pc = blk->pc;
+    int i = 0;
+    while (i < blk->len) {
+        if (!jit_->begin()) {
+            // Buffer is full: drop all translations and start again
+            jit_->flush();
+            for (int n = 0; n < BLOCK_TABLE_SIZE; n++) {
+                blocks_[n].pc = ~0ull;
+            }
+            for (int n = 0; n < blk->len; n++) {
+                blk->item[n].jitcnt = 0;
+            }
+            return;
+        }
+        BlockItemType &head = blk->item[i];
+        uint64_t start_pc = pc;
+        int cnt = 0;
+        while (i < blk->len && jit_->translate(blk->item[i].instr,
+                                               blk->item[i].opcode, pc)) {
+            pc += blk->item[i].oplen;
+            cnt++;
+            i++;
+        }
+        if (cnt >= 2) {
+            head.jit = jit_->end();
+            head.jitcnt = cnt;
+            head.jitbytes = static_cast<unsigned>(pc - start_pc);
+        } else {
+            jit_->cancel();
+        }
+        if (i < blk->len) {
+            // Skip not supported instruction
+            pc += blk->item[i].oplen;
+            i++;
         }
     }
-    return instr;
 }
 
 void CpuRiver_Functional::generateIllegalOpcode() {
@@ -191,7 +503,15 @@ void CpuRiver_Functional::trackContextStart() {
 
 void CpuRiver_Functional::trackContextEnd() {
     CpuGeneric::trackContextEnd();
+    if (cachable_pc_ && memcache_flag_[cache_offset_]) {
+        decodedCache_[cache_offset_] = static_cast<RiscvInstruction *>(instr_);
+    }
 
+    if (binTraceRegs_) {
+        binTrace_->traceRegs(step_cnt_, pc_.getValue().val,
+                             portSavedRegs_.getpR64(), portRegs_.getpR64());
+        return;
+    }
     if (reg_trace_file == 0) {
         return;
     }
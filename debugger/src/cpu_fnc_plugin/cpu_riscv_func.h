@@ -19,6 +19,8 @@
 
 #include <riscv-isa.h>
 #include "instructions.h"
+#include "riscv-decoder.h"
+#include "jit_x64.h"
 #include "generic/cpu_generic.h"
 #include "generic/cmd_br_generic.h"
 #include "cmds/cmd_br_riscv.h"
@@ -42,6 +44,10 @@ class CpuRiver_Functional : public CpuGeneric,
     /** IResetListener itnterface */
     virtual void reset(bool active);
 
+    /** ISnapshot */
+    virtual void saveState(AutoBuffer *buf);
+    virtual bool restoreState(SnapshotReader *rd);
+
     /** ICpuGeneric interface */
     virtual void raiseSignal(int idx);
     virtual void lowerSignal(int idx);
@@ -63,6 +69,11 @@ class CpuRiver_Functional : public CpuGeneric,
     virtual void trackContextStart();
     /** // Stop tracking and write trace file */
     virtual void trackContextEnd() override;
+    virtual const char *const *getTraceRegNames(int *total) {
+        *total = Reg_Total;
+        return IREGS_NAMES;
+    }
+    virtual void updatePipeline() override;
 
     void addIsaUserRV64I();
     void addIsaPrivilegedRV64I();
@@ -71,20 +82,51 @@ class CpuRiver_Functional : public CpuGeneric,
     void addIsaExtensionF();
     void addIsaExtensionM();
     unsigned addSupportedInstruction(RiscvInstruction *instr);
-    uint32_t hash32(uint32_t val) { return (val >> 2) & 0x1f; }
-    /** Compressed instruction */
-    uint32_t hash16(uint16_t val) {
-        uint32_t t1 = val & 0x3;
-        return 0x20 | ((val >> 13) << 2) | t1;
-    }
+    bool executeBlock();
+    void translateBlock(int idx);
 
  private:
     AttributeType listExtISA_;
     AttributeType vendorID_;
+    AttributeType hartID_;
     AttributeType vectorTable_;
-
-    static const int INSTR_HASH_TABLE_SIZE = 1 << 6;
-    AttributeType listInstr_[INSTR_HASH_TABLE_SIZE];
+    AttributeType blockExecution_;
+    AttributeType jitEnable_;
+
+    RiscvDecoder *decoder_;
+    // Supported instructions indexed by the decoder ISA table index
+    RiscvInstruction **isaInstr_;
+    // Decoded instructions indexed like memcache_. Entry is valid only
+    // while the corresponding memcache_flag_ is non-zero.
+    RiscvInstruction **decodedCache_;
+
+    /**
+     * Straight-line sequence of already executed instructions taken from
+     * memcache_. Block is executed without events and breakpoints checking
+     * until branch, trap or the next scheduled clock event. It never
+     * includes the HW breakpoint address, even as the first item: such
+     * instruction is always executed by the generic pipeline.
+     */
+    static const int BLOCK_TABLE_SIZE = 1 << 12;
+    static const int BLOCK_LENGTH_MAX = 32;
+    static const int JIT_THRESHOLD = 16;    // block executions before JIT
+    struct BlockItemType {
+        RiscvInstruction *instr;
+        uint32_t opcode;
+        unsigned oplen;
+        JitFunctionType jit;        // translated items [i, i + jitcnt)
+        int jitcnt;
+        unsigned jitbytes;          // total length of translated items
+    };
+    struct BlockType {
+        uint64_t pc;
+        uint64_t gen;               // memcache generation (cache_gen_)
+        int len;
+        int hits;
+        BlockItemType item[BLOCK_LENGTH_MAX];
+    };
+    BlockType *blocks_;
+    JitX64 *jit_;
 
     GenericReg64Bank portRegs_;
     GenericReg64Bank portSavedRegs_;
@@ -17,31 +17,17 @@
 #include "api_core.h"
 #include "riscv-isa.h"
 #include "instructions.h"
+#include "riscv-decoder.h"
 #include "cpu_riscv_func.h"
 
 namespace debugger {
 
-RiscvInstruction::RiscvInstruction(CpuRiver_Functional *icpu, const char *name,
-                                    const char *bits) {
+RiscvInstruction::RiscvInstruction(CpuRiver_Functional *icpu,
+                                   const char *name) {
     icpu_ = icpu;
     R = icpu->getpRegs();
     name_.make_string(name);
-    mask_ = 0;
-    opcode_ = 0;
-    for (int i = 0; i < 32; i++) {
-        switch (bits[i]) {
-        case '0':
-            break;
-        case '1':
-            opcode_ |= (1 << (31 - i));
-            break;
-        case '?':
-            mask_ |= (1 << (31 - i));
-            break;
-        default:;
-        }
-    }
-    mask_ ^= ~0;
+    isaIndex_ = RiscvDecoder::instance()->index(name);
 }
 
 }  // namespace debugger
@@ -0,0 +1,372 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include "api_core.h"
+#include "riscv-isa.h"
+#include "jit_x64.h"
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+namespace debugger {
+
+/** Host registers numbers used in ModRM encoding */
+static const int HOST_RAX = 0;
+static const int HOST_RCX = 1;
+
+JitX64::JitX64() {
+    code_ = 0;
+    wrcnt_ = 0;
+    start_ = 0;
+#if !defined(RISCV_JIT_X64_ENABLE)
+#elif defined(_WIN32)
+    code_ = static_cast<uint8_t *>(VirtualAlloc(NULL, CODE_BUFFER_SIZE,
+                    MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE));
+#else
+    void *p = mmap(NULL, CODE_BUFFER_SIZE,
+                   PROT_READ | PROT_WRITE | PROT_EXEC,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p != MAP_FAILED) {
+        code_ = static_cast<uint8_t *>(p);
+    }
+#endif
+}
+
+JitX64::~JitX64() {
+    if (code_ == 0) {
+        return;
+    }
+#if defined(_WIN32)
+    VirtualFree(code_, 0, MEM_RELEASE);
+#else
+    munmap(code_, CODE_BUFFER_SIZE);
+#endif
+}
+
+bool JitX64::begin() {
+    if (code_ == 0 || wrcnt_ + 2 * INSTR_SIZE_MAX > CODE_BUFFER_SIZE) {
+        return false;
+    }
+    start_ = wrcnt_;
+    // Keep pointer on registers bank in r11 for any calling convention:
+#if defined(_WIN64) || defined(__CYGWIN__)
+    emit8(0x49); emit8(0x89); emit8(0xCB);      // mov r11, rcx
+#else
+    emit8(0x49); emit8(0x89); emit8(0xFB);      // mov r11, rdi
+#endif
+    return true;
+}
+
+JitFunctionType JitX64::end() {
+    emit8(0xC3);                                // ret
+    JitFunctionType ret = reinterpret_cast<JitFunctionType>(&code_[start_]);
+    start_ = wrcnt_;
+    return ret;
+}
+
+bool JitX64::translate(RiscvInstruction *instr, uint32_t opcode,
+                       uint64_t pc) {
+    if (wrcnt_ + 2 * INSTR_SIZE_MAX > CODE_BUFFER_SIZE) {
+        return false;
+    }
+    /**
+     * Immediate values are computed exactly as in the instructions exec()
+     * methods so that translated code gives the same results.
+     */
+    const char *name = instr->name();
+    if (name[0] != 'C' || name[1] != '_') {
+        ISA_R_type r;
+        ISA_I_type i;
+        ISA_U_type u;
+        r.value = opcode;
+        i.value = opcode;
+        u.value = opcode;
+        uint64_t imm = i.bits.imm;
+        if (imm & 0x800) {
+            imm |= EXT_SIGN_12;
+        }
+        uint32_t shamt = i.bits.imm & 0x3f;
+
+        if (strcmp(name, "ADD") == 0) {
+            emitRegReg(JitOp_Add, r.bits.rd, r.bits.rs1, r.bits.rs2, false);
+        } else if (strcmp(name, "ADDW") == 0) {
+            emitRegReg(JitOp_Add, r.bits.rd, r.bits.rs1, r.bits.rs2, true);
+        } else if (strcmp(name, "SUB") == 0) {
+            emitRegReg(JitOp_Sub, r.bits.rd, r.bits.rs1, r.bits.rs2, false);
+        } else if (strcmp(name, "SUBW") == 0) {
+            emitRegReg(JitOp_Sub, r.bits.rd, r.bits.rs1, r.bits.rs2, true);
+        } else if (strcmp(name, "AND") == 0) {
+            emitRegReg(JitOp_And, r.bits.rd, r.bits.rs1, r.bits.rs2, false);
+        } else if (strcmp(name, "OR") == 0) {
+            emitRegReg(JitOp_Or, r.bits.rd, r.bits.rs1, r.bits.rs2, false);
+        } else if (strcmp(name, "XOR") == 0) {
+            emitRegReg(JitOp_Xor, r.bits.rd, r.bits.rs1, r.bits.rs2, false);
+        } else if (strcmp(name, "SLL") == 0) {
+            emitRegReg(JitOp_Sll, r.bits.rd, r.bits.rs1, r.bits.rs2, false);
+        } else if (strcmp(name, "SRL") == 0) {
+            emitRegReg(JitOp_Srl, r.bits.rd, r.bits.rs1, r.bits.rs2, false);
+        } else if (strcmp(name, "SRA") == 0) {
+            emitRegReg(JitOp_Sra, r.bits.rd, r.bits.rs1, r.bits.rs2, false);
+        } else if (strcmp(name, "SLT") == 0) {
+            emitRegReg(JitOp_Slt, r.bits.rd, r.bits.rs1, r.bits.rs2, false);
+        } else if (strcmp(name, "SLTU") == 0) {
+            emitRegReg(JitOp_Sltu, r.bits.rd, r.bits.rs1, r.bits.rs2, false);
+        } else if (strcmp(name, "MUL") == 0) {
+            emitRegReg(JitOp_Mul, r.bits.rd, r.bits.rs1, r.bits.rs2, false);
+        } else if (strcmp(name, "MULW") == 0) {
+            emitRegReg(JitOp_Mulw, r.bits.rd, r.bits.rs1, r.bits.rs2, true);
+        } else if (strcmp(name, "ADDI") == 0) {
+            emitRegImm(JitOp_Add, i.bits.rd, i.bits.rs1, imm, false);
+        } else if (strcmp(name, "ADDIW") == 0) {
+            emitRegImm(JitOp_Add, i.bits.rd, i.bits.rs1, imm, true);
+        } else if (strcmp(name, "ANDI") == 0) {
+            emitRegImm(JitOp_And, i.bits.rd, i.bits.rs1, imm, false);
+        } else if (strcmp(name, "ORI") == 0) {
+            emitRegImm(JitOp_Or, i.bits.rd, i.bits.rs1, imm, false);
+        } else if (strcmp(name, "XORI") == 0) {
+            emitRegImm(JitOp_Xor, i.bits.rd, i.bits.rs1, imm, false);
+        } else if (strcmp(name, "SLTI") == 0) {
+            emitRegImm(JitOp_Slt, i.bits.rd, i.bits.rs1, imm, false);
+        } else if (strcmp(name, "SLTIU") == 0) {
+            emitRegImm(JitOp_Sltu, i.bits.rd, i.bits.rs1, imm, false);
+        } else if (strcmp(name, "SLLI") == 0) {
+            emitRegImm(JitOp_Sll, i.bits.rd, i.bits.rs1, shamt, false);
+        } else if (strcmp(name, "SRLI") == 0) {
+            emitRegImm(JitOp_Srl, i.bits.rd, i.bits.rs1, shamt, false);
+        } else if (strcmp(name, "SRAI") == 0) {
+            emitRegImm(JitOp_Sra, i.bits.rd, i.bits.rs1, shamt, false);
+        } else if (strcmp(name, "LUI") == 0) {
+            uint64_t tmp = u.bits.imm31_12 << 12;
+            if (tmp & 0x80000000) {
+                tmp |= EXT_SIGN_32;
+            }
+            emitRegImm(JitOp_Li, u.bits.rd, 0, tmp, false);
+        } else if (strcmp(name, "AUIPC") == 0) {
+            uint64_t off = u.bits.imm31_12 << 12;
+            if (off & (1LL << 31)) {
+                off |= EXT_SIGN_32;
+            }
+            emitRegImm(JitOp_Li, u.bits.rd, 0, pc + off, false);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // Compressed instructions:
+    ISA_CR_type cr;
+    ISA_CI_type ci;
+    ISA_CIW_type ciw;
+    ISA_CS_type cs;
+    ISA_CB_type cb;
+    cr.value = static_cast<uint16_t>(opcode);
+    ci.value = static_cast<uint16_t>(opcode);
+    ciw.value = static_cast<uint16_t>(opcode);
+    cs.value = static_cast<uint16_t>(opcode);
+    cb.value = static_cast<uint16_t>(opcode);
+    uint64_t imm = ci.bits.imm;
+    if (ci.bits.imm6) {
+        imm |= EXT_SIGN_6;
+    }
+    uint32_t shamt = (cb.shbits.shamt5 << 5) | cb.shbits.shamt;
+
+    if (strcmp(name, "C_ADD") == 0) {
+        emitRegReg(JitOp_Add, cr.bits.rdrs1, cr.bits.rdrs1, cr.bits.rs2,
+                   false);
+    } else if (strcmp(name, "C_MV") == 0) {
+        emitRegImm(JitOp_Add, cr.bits.rdrs1, cr.bits.rs2, 0, false);
+    } else if (strcmp(name, "C_ADDI") == 0) {
+        emitRegImm(JitOp_Add, ci.bits.rdrs, ci.bits.rdrs, imm, false);
+    } else if (strcmp(name, "C_ADDIW") == 0) {
+        emitRegImm(JitOp_Add, ci.bits.rdrs, ci.bits.rdrs, imm, true);
+    } else if (strcmp(name, "C_LI") == 0) {
+        emitRegImm(JitOp_Li, ci.bits.rdrs, 0, imm, false);
+    } else if (strcmp(name, "C_LUI") == 0) {
+        imm <<= 12;
+        emitRegImm(JitOp_Li, ci.bits.rdrs, 0, imm, false);
+    } else if (strcmp(name, "C_ADDI16SP") == 0) {
+        imm = (ci.spbits.imm8_7 << 3) | (ci.spbits.imm6 << 2)
+            | (ci.spbits.imm5 << 1) | ci.spbits.imm4;
+        if (ci.spbits.imm9) {
+            imm |= EXT_SIGN_6;
+        }
+        imm <<= 4;
+        emitRegImm(JitOp_Add, Reg_sp, Reg_sp, imm, false);
+    } else if (strcmp(name, "C_ADDI4SPN") == 0) {
+        imm = (ciw.bits.imm9_6 << 4) | (ciw.bits.imm5_4 << 2)
+            | (ciw.bits.imm3 << 1) | ciw.bits.imm2;
+        imm <<= 2;
+        emitRegImm(JitOp_Add, 8 + ciw.bits.rd, Reg_sp, imm, false);
+    } else if (strcmp(name, "C_ADDW") == 0) {
+        emitRegReg(JitOp_Add, 8 + cs.bits.rs1, 8 + cs.bits.rs1,
+                   8 + cs.bits.rs2, true);
+    } else if (strcmp(name, "C_SUBW") == 0) {
+        emitRegReg(JitOp_Sub, 8 + cs.bits.rs1, 8 + cs.bits.rs1,
+                   8 + cs.bits.rs2, true);
+    } else if (strcmp(name, "C_SUB") == 0) {
+        emitRegReg(JitOp_Sub, 8 + cs.bits.rs1, 8 + cs.bits.rs1,
+                   8 + cs.bits.rs2, false);
+    } else if (strcmp(name, "C_AND") == 0) {
+        emitRegReg(JitOp_And, 8 + cs.bits.rs1, 8 + cs.bits.rs1,
+                   8 + cs.bits.rs2, false);
+    } else if (strcmp(name, "C_OR") == 0) {
+        emitRegReg(JitOp_Or, 8 + cs.bits.rs1, 8 + cs.bits.rs1,
+                   8 + cs.bits.rs2, false);
+    } else if (strcmp(name, "C_XOR") == 0) {
+        emitRegReg(JitOp_Xor, 8 + cs.bits.rs1, 8 + cs.bits.rs1,
+                   8 + cs.bits.rs2, false);
+    } else if (strcmp(name, "C_ANDI") == 0) {
+        imm = (cb.bits.off7_6 << 3) | (cb.bits.off2_1 << 1)  | cb.bits.off5;
+        if (cb.bits.off8) {
+            imm |= EXT_SIGN_5;
+        }
+        emitRegImm(JitOp_And, 8 + cb.bits.rs1, 8 + cb.bits.rs1, imm, false);
+    } else if (strcmp(name, "C_SLLI") == 0) {
+        int idx = (cb.shbits.funct2 << 3) | cb.shbits.rd;
+        emitRegImm(JitOp_Sll, idx, idx, shamt, false);
+    } else if (strcmp(name, "C_SRLI") == 0) {
+        emitRegImm(JitOp_Srl, 8 + cb.shbits.rd, 8 + cb.shbits.rd, shamt,
+                   false);
+    } else if (strcmp(name, "C_SRAI") == 0) {
+        emitRegImm(JitOp_Sra, 8 + cb.shbits.rd, 8 + cb.shbits.rd, shamt,
+                   false);
+    } else if (strcmp(name, "C_NOP") == 0) {
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void JitX64::emit32(uint32_t v) {
+    memcpy(&code_[wrcnt_], &v, sizeof(v));
+    wrcnt_ += sizeof(v);
+}
+
+void JitX64::emit64(uint64_t v) {
+    memcpy(&code_[wrcnt_], &v, sizeof(v));
+    wrcnt_ += sizeof(v);
+}
+
+/** mov hostreg, [r11 + 8*idx] */
+void JitX64::emitLoad(int hostreg, int idx) {
+    emit8(0x49);
+    emit8(0x8B);
+    emit8(static_cast<uint8_t>(0x83 | (hostreg << 3)));
+    emit32(static_cast<uint32_t>(8 * idx));
+}
+
+/** mov [r11 + 8*idx], rax */
+void JitX64::emitStore(int idx) {
+    emit8(0x49);
+    emit8(0x89);
+    emit8(0x83);
+    emit32(static_cast<uint32_t>(8 * idx));
+}
+
+void JitX64::emitRegReg(EJitOperation op, int rd, int rs1, int rs2,
+                        bool w) {
+    emitLoad(HOST_RAX, rs1);
+    switch (op) {
+    case JitOp_Sll:
+    case JitOp_Srl:
+    case JitOp_Sra:
+        // Shift count is masked by 0x3F the same as in RV64I
+        emitLoad(HOST_RCX, rs2);
+        emit8(0x48);
+        emit8(0xD3);
+        emit8(op == JitOp_Sll ? 0xE0 : op == JitOp_Srl ? 0xE8 : 0xF8);
+        break;
+    case JitOp_Mul:
+        emit8(0x49); emit8(0x0F); emit8(0xAF); emit8(0x83);
+        emit32(static_cast<uint32_t>(8 * rs2));
+        break;
+    case JitOp_Mulw:
+        emit8(0x41); emit8(0x0F); emit8(0xAF); emit8(0x83);
+        emit32(static_cast<uint32_t>(8 * rs2));
+        break;
+    case JitOp_Slt:
+    case JitOp_Sltu:
+        emit8(0x49); emit8(0x3B); emit8(0x83);  // cmp rax, [r11 + 8*rs2]
+        emit32(static_cast<uint32_t>(8 * rs2));
+        emit8(0x0F); emit8(op == JitOp_Slt ? 0x9C : 0x92); emit8(0xC0);
+        emit8(0x0F); emit8(0xB6); emit8(0xC0);  // movzx eax, al
+        break;
+    default:
+        emit8(0x49);
+        emit8(op == JitOp_Add ? 0x03 : op == JitOp_Sub ? 0x2B :
+              op == JitOp_And ? 0x23 : op == JitOp_Or ? 0x0B : 0x33);
+        emit8(0x83);
+        emit32(static_cast<uint32_t>(8 * rs2));
+    }
+    if (w) {
+        emit8(0x48); emit8(0x63); emit8(0xC0);  // movsxd rax, eax
+    }
+    emitStore(rd);
+}
+
+void JitX64::emitRegImm(EJitOperation op, int rd, int rs1, uint64_t imm,
+                        bool w) {
+    if (op == JitOp_Li) {
+        emit8(0x48); emit8(0xB8);               // mov rax, imm64
+        emit64(imm);
+        emitStore(rd);
+        return;
+    }
+    emitLoad(HOST_RAX, rs1);
+    int64_t simm = static_cast<int64_t>(imm);
+    bool imm32 = simm == static_cast<int64_t>(static_cast<int32_t>(simm));
+    uint8_t ext;
+    switch (op) {
+    case JitOp_Sll:
+    case JitOp_Srl:
+    case JitOp_Sra:
+        emit8(0x48);
+        emit8(0xC1);
+        emit8(op == JitOp_Sll ? 0xE0 : op == JitOp_Srl ? 0xE8 : 0xF8);
+        emit8(static_cast<uint8_t>(imm & 0x3F));
+        break;
+    default:
+        switch (op) {
+        case JitOp_Add: ext = 0; break;
+        case JitOp_Or:  ext = 1; break;
+        case JitOp_And: ext = 4; break;
+        case JitOp_Sub: ext = 5; break;
+        case JitOp_Xor: ext = 6; break;
+        default:        ext = 7;                // cmp
+        }
+        if (imm32) {
+            emit8(0x48); emit8(0x81); emit8(0xC0 | (ext << 3));
+            emit32(static_cast<uint32_t>(imm));
+        } else {
+            emit8(0x48); emit8(0xBA);           // mov rdx, imm64
+            emit64(imm);
+            emit8(0x48); emit8(0x01 | (ext << 3)); emit8(0xD0);
+        }
+        if (op == JitOp_Slt || op == JitOp_Sltu) {
+            emit8(0x0F); emit8(op == JitOp_Slt ? 0x9C : 0x92); emit8(0xC0);
+            emit8(0x0F); emit8(0xB6); emit8(0xC0);
+        }
+    }
+    if (w) {
+        emit8(0x48); emit8(0x63); emit8(0xC0);
+    }
+    emitStore(rd);
+}
+
+}  // namespace debugger
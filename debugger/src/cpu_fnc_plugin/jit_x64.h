@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_CPU_RISCV_JIT_X64_H__
+#define __DEBUGGER_CPU_RISCV_JIT_X64_H__
+
+#include <inttypes.h>
+#include "instructions.h"
+
+namespace debugger {
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define RISCV_JIT_X64_ENABLE
+#endif
+
+/** Translated sequence of instructions: void f(uint64_t *R) */
+typedef void (*JitFunctionType)(uint64_t *R);
+
+/**
+ * @brief Translator of the RV64I/M/C integer instructions into x86-64 code.
+ *
+ * Only register-to-register and immediate operations are translated. Guest
+ * registers are accessed directly in the portRegs_ array. Memory accesses,
+ * branches, CSR and privileged instructions stay in the interpreter.
+ */
+class JitX64 {
+ public:
+    JitX64();
+    ~JitX64();
+
+    /** Executable buffer was successfully allocated */
+    bool isEnabled() { return code_ != 0; }
+
+    /** Start new function. Return false if the buffer is full. */
+    bool begin();
+    /** Translate one instruction. Return false if it isn't supported. */
+    bool translate(RiscvInstruction *instr, uint32_t opcode, uint64_t pc);
+    /** Close function started by begin() */
+    JitFunctionType end();
+    /** Drop function started by begin() */
+    void cancel() { wrcnt_ = start_; }
+    /** Release all translated functions */
+    void flush() { wrcnt_ = 0; start_ = 0; }
+
+ private:
+    enum EJitOperation {
+        JitOp_Add,
+        JitOp_Sub,
+        JitOp_And,
+        JitOp_Or,
+        JitOp_Xor,
+        JitOp_Sll,
+        JitOp_Srl,
+        JitOp_Sra,
+        JitOp_Slt,
+        JitOp_Sltu,
+        JitOp_Mul,
+        JitOp_Mulw,
+        JitOp_Li
+    };
+
+    /** rd = rs1 op rs2 */
+    void emitRegReg(EJitOperation op, int rd, int rs1, int rs2, bool w);
+    /** rd = rs1 op imm */
+    void emitRegImm(EJitOperation op, int rd, int rs1, uint64_t imm, bool w);
+    void emitLoad(int hostreg, int idx);
+    void emitStore(int idx);
+    void emit8(uint8_t v) { code_[wrcnt_++] = v; }
+    void emit32(uint32_t v);
+    void emit64(uint64_t v);
+
+ private:
+    static const unsigned CODE_BUFFER_SIZE = 4 << 20;
+    static const unsigned INSTR_SIZE_MAX = 32;
+    uint8_t *code_;
+    unsigned wrcnt_;
+    unsigned start_;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_CPU_RISCV_JIT_X64_H__
@@ -0,0 +1,324 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include "api_core.h"
+#include "riscv-isa.h"
+#include "riscv-decoder.h"
+
+namespace debugger {
+
+/**
+ * Instructions implemented by the functional model. Instruction classes
+ * take their encoding from this table by name.
+ */
+static const RiscvIsaPatternType RISCV_ISA_TABLE[] = {
+    // RV64I user level:
+    {"ADD",       "0000000??????????000?????0110011", 0},
+    {"ADDI",      "?????????????????000?????0010011", 0},
+    {"ADDIW",     "?????????????????000?????0011011", 0},
+    {"ADDW",      "0000000??????????000?????0111011", 0},
+    {"AND",       "0000000??????????111?????0110011", 0},
+    {"ANDI",      "?????????????????111?????0010011", 0},
+    {"AUIPC",     "?????????????????????????0010111", 0},
+    {"BEQ",       "?????????????????000?????1100011", 0},
+    {"BGE",       "?????????????????101?????1100011", 0},
+    {"BGEU",      "?????????????????111?????1100011", 0},
+    {"BLT",       "?????????????????100?????1100011", 0},
+    {"BLTU",      "?????????????????110?????1100011", 0},
+    {"BNE",       "?????????????????001?????1100011", 0},
+    {"JAL",       "?????????????????????????1101111", 0},
+    {"JALR",      "?????????????????000?????1100111", 0},
+    {"LD",        "?????????????????011?????0000011", 0},
+    {"LW",        "?????????????????010?????0000011", 0},
+    {"LWU",       "?????????????????110?????0000011", 0},
+    {"LH",        "?????????????????001?????0000011", 0},
+    {"LHU",       "?????????????????101?????0000011", 0},
+    {"LB",        "?????????????????000?????0000011", 0},
+    {"LBU",       "?????????????????100?????0000011", 0},
+    {"LUI",       "?????????????????????????0110111", 0},
+    {"OR",        "0000000??????????110?????0110011", 0},
+    {"ORI",       "?????????????????110?????0010011", 0},
+    {"SLL",       "0000000??????????001?????0110011", 0},
+    {"SLLI",      "000000???????????001?????0010011", 0},
+    {"SLLIW",     "0000000??????????001?????0011011", 0},
+    {"SLLW",      "0000000??????????001?????0111011", 0},
+    {"SLT",       "0000000??????????010?????0110011", 0},
+    {"SLTI",      "?????????????????010?????0010011", 0},
+    {"SLTU",      "0000000??????????011?????0110011", 0},
+    {"SLTIU",     "?????????????????011?????0010011", 0},
+    {"SRA",       "0100000??????????101?????0110011", 0},
+    {"SRAI",      "010000???????????101?????0010011", 0},
+    {"SRAIW",     "0100000??????????101?????0011011", 0},
+    {"SRAW",      "0100000??????????101?????0111011", 0},
+    {"SRL",       "0000000??????????101?????0110011", 0},
+    {"SRLI",      "000000???????????101?????0010011", 0},
+    {"SRLIW",     "0000000??????????101?????0011011", 0},
+    {"SRLW",      "0000000??????????101?????0111011", 0},
+    {"SUB",       "0100000??????????000?????0110011", 0},
+    {"SUBW",      "0100000??????????000?????0111011", 0},
+    {"SD",        "?????????????????011?????0100011", 0},
+    {"SW",        "?????????????????010?????0100011", 0},
+    {"SH",        "?????????????????001?????0100011", 0},
+    {"SB",        "?????????????????000?????0100011", 0},
+    {"XOR",       "0000000??????????100?????0110011", 0},
+    {"XORI",      "?????????????????100?????0010011", 0},
+    // RV64I privileged:
+    {"CSRRC",     "?????????????????011?????1110011", 0},
+    {"CSRRCI",    "?????????????????111?????1110011", 0},
+    {"CSRRS",     "?????????????????010?????1110011", 0},
+    {"CSRRSI",    "?????????????????110?????1110011", 0},
+    {"CSRRW",     "?????????????????001?????1110011", 0},
+    {"CSRRWI",    "?????????????????101?????1110011", 0},
+    {"URET",      "00000000001000000000000001110011", 0},
+    {"SRET",      "00010000001000000000000001110011", 0},
+    {"HRET",      "00100000001000000000000001110011", 0},
+    {"MRET",      "00110000001000000000000001110011", 0},
+    {"FENCE",     "?????????????????000?????0001111", 0},
+    {"FENCE_I",   "?????????????????001?????0001111", 0},
+    {"ECALL",     "00000000000000000000000001110011", 0},
+    {"EBREAK",    "00000000000100000000000001110011", 0},
+    // M-extension:
+    {"DIV",       "0000001??????????100?????0110011", 0},
+    {"DIVU",      "0000001??????????101?????0110011", 0},
+    {"DIVUW",     "0000001??????????101?????0111011", 0},
+    {"DIVW",      "0000001??????????100?????0111011", 0},
+    {"MUL",       "0000001??????????000?????0110011", 0},
+    {"MULW",      "0000001??????????000?????0111011", 0},
+    {"REM",       "0000001??????????110?????0110011", 0},
+    {"REMU",      "0000001??????????111?????0110011", 0},
+    {"REMW",      "0000001??????????110?????0111011", 0},
+    {"REMUW",     "0000001??????????111?????0111011", 0},
+    // C-extension. Order matters for the overlapped patterns:
+    {"C_ADD", "????????????????1001??????????10",
+        ISA_CHECK_RD_NZ | ISA_CHECK_RS2_NZ},
+    {"C_ADDI",    "????????????????000???????????01", ISA_CHECK_RD_NZ},
+    {"C_ADDI16SP","????????????????011?00010?????01", 0},
+    {"C_ADDI4SPN","????????????????000???????????00", 0},
+    {"C_ADDIW",   "????????????????001???????????01", ISA_CHECK_RD_NZ},
+    {"C_ADDW",    "????????????????100111???01???01", 0},
+    {"C_AND",     "????????????????100011???11???01", 0},
+    {"C_ANDI",    "????????????????100?10????????01", 0},
+    {"C_BEQZ",    "????????????????110???????????01", 0},
+    {"C_BNEZ",    "????????????????111???????????01", 0},
+    {"C_EBREAK",  "????????????????1001000000000010", 0},
+    {"C_J",       "????????????????101???????????01", 0},
+    {"C_JAL",     "????????????????001???????????01", 0},
+    {"C_JALR",    "????????????????1001?????0000010", ISA_CHECK_RD_NZ},
+    {"C_JR",      "????????????????1000?????0000010", ISA_CHECK_RD_NZ},
+    {"C_LD",      "????????????????011???????????00", 0},
+    {"C_LDSP",    "????????????????011???????????10", ISA_CHECK_RD_NZ},
+    {"C_LWSP",    "????????????????010???????????10", ISA_CHECK_RD_NZ},
+    {"C_LI",      "????????????????010???????????01", ISA_CHECK_RD_NZ},
+    {"C_LUI", "????????????????011???????????01",
+        ISA_CHECK_RD_NZ | ISA_CHECK_RD_NSP},
+    {"C_LW",      "????????????????010???????????00", 0},
+    {"C_MV", "????????????????1000??????????10",
+        ISA_CHECK_RD_NZ | ISA_CHECK_RS2_NZ},
+    {"C_NOP",     "????????????????0000000000000001", 0},
+    {"C_OR",      "????????????????100011???10???01", 0},
+    {"C_SD",      "????????????????111???????????00", 0},
+    {"C_SDSP",    "????????????????111???????????10", 0},
+    {"C_SLLI",    "????????????????000???????????10", ISA_CHECK_RD_NZ},
+    {"C_SRAI",    "????????????????100?01????????01", 0},
+    {"C_SRLI",    "????????????????100?00????????01", 0},
+    {"C_SUB",     "????????????????100011???00???01", 0},
+    {"C_SUBW",    "????????????????100111???00???01", 0},
+    {"C_SW",      "????????????????110???????????00", 0},
+    {"C_SWSP",    "????????????????110???????????10", 0},
+    {"C_XOR",     "????????????????100011???01???01", 0},
+    // F-extension:
+    {"FDIV_D",    "0001101??????????????????1010011", 0},
+};
+
+/** Maximum width of the field selected by one tree node */
+static const int DECODE_FIELD_WIDTH_MAX = 8;
+
+RiscvDecoder *RiscvDecoder::instance() {
+    static RiscvDecoder decoder;
+    return &decoder;
+}
+
+RiscvDecoder::RiscvDecoder() {
+    isa_ = RISCV_ISA_TABLE;
+    size_ = static_cast<int>(sizeof(RISCV_ISA_TABLE)
+                           / sizeof(RISCV_ISA_TABLE[0]));
+    mask_ = new uint32_t[size_];
+    value_ = new uint32_t[size_];
+    for (int n = 0; n < size_; n++) {
+        const char *bits = isa_[n].bits;
+        mask_[n] = 0;
+        value_[n] = 0;
+        for (int i = 0; i < 32; i++) {
+            switch (bits[i]) {
+            case '0':
+                break;
+            case '1':
+                value_[n] |= (1u << (31 - i));
+                break;
+            case '?':
+                mask_[n] |= (1u << (31 - i));
+                break;
+            default:;
+            }
+        }
+        mask_[n] ^= ~0u;
+    }
+
+    // Compressed instructions: fully resolved table
+    for (unsigned op = 0; op < (1u << 16); op++) {
+        tbl16_[op] = -1;
+        if ((op & 0x3) == 0x3) {
+            continue;
+        }
+        for (int n = 0; n < size_; n++) {
+            if (match16(n, static_cast<uint16_t>(op))) {
+                tbl16_[op] = static_cast<int16_t>(n);
+                break;
+            }
+        }
+    }
+
+    // 32-bit instructions: tree of the fixed fields lookups
+    int *cand = new int[size_];
+    int cnt = 0;
+    for (int n = 0; n < size_; n++) {
+        if ((value_[n] & 0x3) == 0x3) {
+            cand[cnt++] = n;
+        }
+    }
+    nodes_ = 0;
+    nodesCnt_ = 0;
+    nodesMax_ = 0;
+    buildNode(allocNodes(1), cand, cnt, 0);
+    delete [] cand;
+}
+
+RiscvDecoder::~RiscvDecoder() {
+    delete [] mask_;
+    delete [] value_;
+    delete [] nodes_;
+}
+
+int RiscvDecoder::index(const char *name) {
+    for (int n = 0; n < size_; n++) {
+        if (strcmp(isa_[n].name, name) == 0) {
+            return n;
+        }
+    }
+    return -1;
+}
+
+bool RiscvDecoder::match16(int idx, uint16_t opcode) {
+    ISA_CR_type u;
+    u.value = opcode;
+    if ((value_[idx] & 0x3) == 0x3) {
+        return false;
+    }
+    if ((opcode & mask_[idx]) != value_[idx]) {
+        return false;
+    }
+    if ((isa_[idx].check & ISA_CHECK_RD_NZ) && u.bits.rdrs1 == 0) {
+        return false;
+    }
+    if ((isa_[idx].check & ISA_CHECK_RS2_NZ) && u.bits.rs2 == 0) {
+        return false;
+    }
+    if ((isa_[idx].check & ISA_CHECK_RD_NSP) && u.bits.rdrs1 == Reg_sp) {
+        return false;
+    }
+    return true;
+}
+
+int RiscvDecoder::allocNodes(int cnt) {
+    if (nodesCnt_ + cnt > nodesMax_) {
+        int newmax = 2 * (nodesCnt_ + cnt);
+        DecodeNodeType *t = new DecodeNodeType[newmax];
+        if (nodes_) {
+            memcpy(t, nodes_, nodesCnt_ * sizeof(DecodeNodeType));
+            delete [] nodes_;
+        }
+        nodes_ = t;
+        nodesMax_ = newmax;
+    }
+    int ret = nodesCnt_;
+    nodesCnt_ += cnt;
+    return ret;
+}
+
+/**
+ * Candidates are sorted by priority. Node selects the lowest field that is
+ * fixed in all candidates and wasn't checked yet. If there's no such field
+ * the field fixed in any candidate is used and candidates with don't care
+ * bits are copied into each child.
+ */
+void RiscvDecoder::buildNode(int nidx, int *cand, int cnt, uint32_t used) {
+    uint32_t common = ~used;
+    uint32_t any = 0;
+    for (int i = 0; i < cnt; i++) {
+        common &= mask_[cand[i]];
+        any |= mask_[cand[i]];
+    }
+    any &= ~used;
+
+    nodes_[nidx].fmask = 0;
+    nodes_[nidx].shift = 0;
+    nodes_[nidx].next = 0;
+    if (cnt == 0) {
+        nodes_[nidx].mask = 0;
+        nodes_[nidx].value = 0;
+        nodes_[nidx].idx = -1;
+        return;
+    }
+    if (cnt == 1 || any == 0) {
+        nodes_[nidx].mask = mask_[cand[0]];
+        nodes_[nidx].value = value_[cand[0]];
+        nodes_[nidx].idx = cand[0];
+        return;
+    }
+
+    uint32_t sel = common ? common : any;
+    int shift = 0;
+    while (((sel >> shift) & 0x1) == 0) {
+        shift++;
+    }
+    int width = 0;
+    while (shift + width < 32 && width < DECODE_FIELD_WIDTH_MAX
+        && ((sel >> (shift + width)) & 0x1)) {
+        width++;
+    }
+    uint32_t fmask = (1u << width) - 1;
+    int next = allocNodes(1 << width);
+    nodes_[nidx].fmask = fmask;
+    nodes_[nidx].shift = shift;
+    nodes_[nidx].next = next;
+
+    int *sub = new int[cnt];
+    for (uint32_t k = 0; k <= fmask; k++) {
+        int subcnt = 0;
+        for (int i = 0; i < cnt; i++) {
+            uint32_t t = (value_[cand[i]] ^ (k << shift)) & mask_[cand[i]];
+            if ((t & (fmask << shift)) == 0) {
+                sub[subcnt++] = cand[i];
+            }
+        }
+        buildNode(next + static_cast<int>(k), sub, subcnt,
+                  used | (fmask << shift));
+    }
+    delete [] sub;
+}
+
+}  // namespace debugger
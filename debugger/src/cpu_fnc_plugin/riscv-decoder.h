@@ -0,0 +1,100 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_CPU_RISCV_DECODER_H__
+#define __DEBUGGER_CPU_RISCV_DECODER_H__
+
+#include <inttypes.h>
+
+namespace debugger {
+
+/** Additional checks of the compressed instruction fields */
+static const uint32_t ISA_CHECK_RD_NZ  = 0x1;   // rd/rs1 [11:7] isn't zero
+static const uint32_t ISA_CHECK_RS2_NZ = 0x2;   // rs2 [6:2] isn't zero
+static const uint32_t ISA_CHECK_RD_NSP = 0x4;   // rd/rs1 [11:7] isn't sp
+
+struct RiscvIsaPatternType {
+    const char *name;
+    const char *bits;       // '0', '1' or '?' starting from bit 31
+    uint32_t check;         // ISA_CHECK_* flags
+};
+
+/**
+ * @brief Decoder of the RISC-V instructions into the ISA table index.
+ *
+ * Decoding tables are generated from the bit-pattern strings once per
+ * process: 16-bit opcodes are fully resolved into the direct lookup table
+ * and 32-bit opcodes are resolved by the short tree of field lookups, so
+ * the decoding doesn't depend on the number of instructions. The same
+ * object is used by the functional model and by the disassembler.
+ */
+class RiscvDecoder {
+ public:
+    static RiscvDecoder *instance();
+
+    /** Number of instructions in the ISA table */
+    int size() { return size_; }
+    /** Index of instruction with the specified name or -1 */
+    int index(const char *name);
+    const char *name(int idx) { return isa_[idx].name; }
+
+    /** Return ISA table index or -1 if opcode is illegal */
+    int decode(uint32_t opcode) {
+        if ((opcode & 0x3) != 0x3) {
+            return tbl16_[opcode & 0xFFFF];
+        }
+        const DecodeNodeType *p = nodes_;
+        while (p->fmask) {
+            p = &nodes_[p->next + ((opcode >> p->shift) & p->fmask)];
+        }
+        if ((opcode & p->mask) != p->value) {
+            return -1;
+        }
+        return p->idx;
+    }
+
+ private:
+    RiscvDecoder();
+    ~RiscvDecoder();
+
+    bool match16(int idx, uint16_t opcode);
+    int allocNodes(int cnt);
+    void buildNode(int nidx, int *cand, int cnt, uint32_t used);
+
+ private:
+    /** Tree node. Leaf (fmask = 0) checks all fixed bits of the opcode. */
+    struct DecodeNodeType {
+        uint32_t fmask;     // field mask after shift
+        int shift;
+        int next;           // index of the first child node
+        uint32_t mask;
+        uint32_t value;
+        int idx;            // ISA table index
+    };
+
+    const RiscvIsaPatternType *isa_;
+    int size_;
+    uint32_t *mask_;
+    uint32_t *value_;
+    int16_t tbl16_[1 << 16];
+    DecodeNodeType *nodes_;
+    int nodesCnt_;
+    int nodesMax_;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_CPU_RISCV_DECODER_H__
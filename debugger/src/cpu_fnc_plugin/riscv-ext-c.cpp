@@ -30,15 +30,7 @@ namespace debugger {
  */
 class C_ADD : public RiscvInstruction16 {
 public:
-    C_ADD(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_ADD", "????????????????1001??????????10") {}
-
-    virtual bool parse(uint32_t *payload) {
-        ISA_CR_type u;
-        u.value = static_cast<uint16_t>(payload[0]);
-        return RiscvInstruction::parse(payload)
-                && u.bits.rdrs1 && u.bits.rs2;
-    }
+    C_ADD(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_ADD") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CR_type u;
@@ -59,14 +51,7 @@ public:
  */
 class C_ADDI : public RiscvInstruction16 {
 public:
-    C_ADDI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_ADDI", "????????????????000???????????01") {}
-
-    virtual bool parse(uint32_t *payload) {
-        ISA_CR_type u;
-        u.value = static_cast<uint16_t>(payload[0]);
-        return RiscvInstruction::parse(payload) && u.bits.rdrs1;
-    }
+    C_ADDI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_ADDI") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CI_type u;
@@ -94,7 +79,7 @@ public:
 class C_ADDI16SP : public RiscvInstruction16 {
 public:
     C_ADDI16SP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_ADDI16SP", "????????????????011?00010?????01") {}
+        "C_ADDI16SP") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CI_type u;
@@ -123,7 +108,7 @@ public:
 class C_ADDI4SPN : public RiscvInstruction16 {
 public:
     C_ADDI4SPN(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_ADDI4SPN", "????????????????000???????????00") {}
+        "C_ADDI4SPN") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CIW_type u;
@@ -147,14 +132,7 @@ public:
  */
 class C_ADDIW : public RiscvInstruction16 {
 public:
-    C_ADDIW(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_ADDIW", "????????????????001???????????01") {}
-
-    virtual bool parse(uint32_t *payload) {
-        ISA_CR_type u;
-        u.value = static_cast<uint16_t>(payload[0]);
-        return RiscvInstruction::parse(payload) && u.bits.rdrs1;
-    }
+    C_ADDIW(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_ADDIW") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CI_type u;
@@ -181,8 +159,7 @@ public:
  */
 class C_ADDW : public RiscvInstruction16 {
 public:
-    C_ADDW(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_ADDW", "????????????????100111???01???01") {}
+    C_ADDW(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_ADDW") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CS_type u;
@@ -206,8 +183,7 @@ public:
  */
 class C_AND : public RiscvInstruction16 {
 public:
-    C_AND(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_AND", "????????????????100011???11???01") {}
+    C_AND(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_AND") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CS_type u;
@@ -226,8 +202,7 @@ public:
  */
 class C_ANDI : public RiscvInstruction16 {
 public:
-    C_ANDI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_ANDI", "????????????????100?10????????01") {}
+    C_ANDI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_ANDI") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CB_type u;
@@ -252,8 +227,7 @@ public:
  */
 class C_BEQZ : public RiscvInstruction16 {
 public:
-    C_BEQZ(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_BEQZ", "????????????????110???????????01") {}
+    C_BEQZ(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_BEQZ") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CB_type u;
@@ -281,8 +255,7 @@ public:
  */
 class C_BNEZ : public RiscvInstruction16 {
 public:
-    C_BNEZ(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_BNEZ", "????????????????111???????????01") {}
+    C_BNEZ(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_BNEZ") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CB_type u;
@@ -310,7 +283,7 @@ public:
 class C_EBREAK : public RiscvInstruction16 {
 public:
     C_EBREAK(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_EBREAK", "????????????????1001000000000010") {}
+        "C_EBREAK") {}
 
     virtual int exec(Reg64Type *payload) {
         icpu_->raiseSignal(EXCEPTION_Breakpoint);
@@ -329,8 +302,7 @@ public:
  */
 class C_J : public RiscvInstruction16 {
 public:
-    C_J(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_J", "????????????????101???????????01") {}
+    C_J(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_J") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CJ_type u;
@@ -358,8 +330,7 @@ public:
  */
 class C_JAL : public RiscvInstruction16 {
 public:
-    C_JAL(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_JAL", "????????????????001???????????01") {}
+    C_JAL(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_JAL") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CJ_type u;
@@ -389,14 +360,7 @@ public:
  */
 class C_JALR : public RiscvInstruction16 {
 public:
-    C_JALR(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_JALR", "????????????????1001?????0000010") {}
-
-    virtual bool parse(uint32_t *payload) {
-        ISA_CR_type u;
-        u.value = static_cast<uint16_t>(payload[0]);
-        return RiscvInstruction::parse(payload) && u.bits.rdrs1;
-    }
+    C_JALR(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_JALR") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CR_type u;
@@ -416,14 +380,7 @@ public:
  */
 class C_JR : public RiscvInstruction16 {
 public:
-    C_JR(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_JR", "????????????????1000?????0000010") {}
-
-    virtual bool parse(uint32_t *payload) {
-        ISA_CR_type u;
-        u.value = static_cast<uint16_t>(payload[0]);
-        return RiscvInstruction::parse(payload) && u.bits.rdrs1;
-    }
+    C_JR(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_JR") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CR_type u;
@@ -447,7 +404,7 @@ public:
 class C_LD : public RiscvInstruction16 {
 public:
     C_LD(CpuRiver_Functional *icpu) :
-        RiscvInstruction16(icpu, "C_LD", "????????????????011???????????00") {}
+        RiscvInstruction16(icpu, "C_LD") {}
 
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
@@ -480,14 +437,7 @@ public:
  */ 
 class C_LDSP : public RiscvInstruction16 {
 public:
-    C_LDSP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_LDSP", "????????????????011???????????10") {}
-
-    virtual bool parse(uint32_t *payload) {
-        ISA_CR_type u;
-        u.value = static_cast<uint16_t>(payload[0]);
-        return RiscvInstruction::parse(payload) && u.bits.rdrs1;
-    }
+    C_LDSP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_LDSP") {}
 
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
@@ -518,14 +468,7 @@ public:
  */
 class C_LI : public RiscvInstruction16 {
 public:
-    C_LI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_LI", "????????????????010???????????01") {}
-
-    virtual bool parse(uint32_t *payload) {
-        ISA_CR_type u;
-        u.value = static_cast<uint16_t>(payload[0]);
-        return RiscvInstruction::parse(payload) && u.bits.rdrs1;
-    }
+    C_LI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_LI") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CI_type u;
@@ -550,7 +493,7 @@ public:
 class C_LW : public RiscvInstruction16 {
 public:
     C_LW(CpuRiver_Functional *icpu) :
-        RiscvInstruction16(icpu, "C_LW", "????????????????010???????????00") {}
+        RiscvInstruction16(icpu, "C_LW") {}
 
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
@@ -585,14 +528,7 @@ public:
  */ 
 class C_LWSP : public RiscvInstruction16 {
 public:
-    C_LWSP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_LWSP", "????????????????010???????????10") {}
-
-    virtual bool parse(uint32_t *payload) {
-        ISA_CR_type u;
-        u.value = static_cast<uint16_t>(payload[0]);
-        return RiscvInstruction::parse(payload) && u.bits.rdrs1;
-    }
+    C_LWSP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_LWSP") {}
 
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
@@ -629,15 +565,7 @@ public:
  */
 class C_LUI : public RiscvInstruction16 {
 public:
-    C_LUI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_LUI", "????????????????011???????????01") {}
-
-    virtual bool parse(uint32_t *payload) {
-        ISA_CR_type u;
-        u.value = static_cast<uint16_t>(payload[0]);
-        return RiscvInstruction::parse(payload) && u.bits.rdrs1
-            && u.bits.rdrs1 != Reg_sp;
-    }
+    C_LUI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_LUI") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CI_type u;
@@ -661,15 +589,7 @@ public:
  */
 class C_MV : public RiscvInstruction16 {
 public:
-    C_MV(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_MV", "????????????????1000??????????10") {}
-
-    virtual bool parse(uint32_t *payload) {
-        ISA_CR_type u;
-        u.value = static_cast<uint16_t>(payload[0]);
-        return RiscvInstruction::parse(payload)
-            && u.bits.rs2 && u.bits.rdrs1;
-    }
+    C_MV(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_MV") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CR_type u;
@@ -684,12 +604,7 @@ public:
  */
 class C_NOP : public RiscvInstruction16 {
 public:
-    C_NOP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_NOP", "????????????????0000000000000001") {}
-
-    virtual bool parse(uint32_t *payload) {
-        return RiscvInstruction::parse(payload);
-    }
+    C_NOP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_NOP") {}
 
     virtual int exec(Reg64Type *payload) {
         return 2;
@@ -705,8 +620,7 @@ public:
  */
 class C_OR : public RiscvInstruction16 {
 public:
-    C_OR(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_OR", "????????????????100011???10???01") {}
+    C_OR(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_OR") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CS_type u;
@@ -726,8 +640,7 @@ public:
  */
 class C_SD : public RiscvInstruction16 {
 public:
-    C_SD(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_SD", "????????????????111???????????00") {}
+    C_SD(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_SD") {}
 
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
@@ -759,8 +672,7 @@ public:
  */
 class C_SDSP : public RiscvInstruction16 {
 public:
-    C_SDSP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_SDSP", "????????????????111???????????10") {}
+    C_SDSP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_SDSP") {}
 
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
@@ -795,14 +707,7 @@ public:
  */
 class C_SLLI : public RiscvInstruction16 {
 public:
-    C_SLLI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_SLLI", "????????????????000???????????10") {}
-
-    virtual bool parse(uint32_t *payload) {
-        ISA_CR_type u;
-        u.value = static_cast<uint16_t>(payload[0]);
-        return RiscvInstruction::parse(payload) && u.bits.rdrs1;
-    }
+    C_SLLI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_SLLI") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CB_type u;
@@ -822,8 +727,7 @@ public:
  */
 class C_SRAI : public RiscvInstruction16 {
 public:
-    C_SRAI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_SRAI", "????????????????100?01????????01") {}
+    C_SRAI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_SRAI") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CB_type u;
@@ -848,8 +752,7 @@ public:
  */
 class C_SRLI : public RiscvInstruction16 {
 public:
-    C_SRLI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_SRLI", "????????????????100?00????????01") {}
+    C_SRLI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_SRLI") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CB_type u;
@@ -869,8 +772,7 @@ public:
  */
 class C_SUB : public RiscvInstruction16 {
 public:
-    C_SUB(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_SUB", "????????????????100011???00???01") {}
+    C_SUB(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_SUB") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CS_type u;
@@ -890,8 +792,7 @@ public:
  */
 class C_SUBW : public RiscvInstruction16 {
 public:
-    C_SUBW(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_SUBW", "????????????????100111???00???01") {}
+    C_SUBW(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_SUBW") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CS_type u;
@@ -915,8 +816,7 @@ public:
  */
 class C_SW : public RiscvInstruction16 {
 public:
-    C_SW(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_SW", "????????????????110???????????00") {}
+    C_SW(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_SW") {}
 
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
@@ -947,8 +847,7 @@ public:
  */
 class C_SWSP : public RiscvInstruction16 {
 public:
-    C_SWSP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_SWSP", "????????????????110???????????10") {}
+    C_SWSP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_SWSP") {}
 
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
@@ -978,8 +877,7 @@ public:
  */
 class C_XOR : public RiscvInstruction16 {
 public:
-    C_XOR(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
-        "C_XOR", "????????????????100011???01???01") {}
+    C_XOR(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu, "C_XOR") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_CS_type u;
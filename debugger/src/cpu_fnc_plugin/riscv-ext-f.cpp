@@ -43,8 +43,7 @@ void idiv53(int64_t inDivident,
  */
 class FDIV_D : public RiscvInstruction {
  public:
-    FDIV_D(CpuRiver_Functional *icpu) : RiscvInstruction(icpu,
-        "FDIV_D", "0001101??????????????????1010011") {}
+    FDIV_D(CpuRiver_Functional *icpu) : RiscvInstruction(icpu, "FDIV_D") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_R_type u;
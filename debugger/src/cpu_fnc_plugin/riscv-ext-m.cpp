@@ -28,7 +28,7 @@ namespace debugger {
 class DIV : public RiscvInstruction {
  public:
     DIV(CpuRiver_Functional *icpu)
-        : RiscvInstruction(icpu, "DIV", "0000001??????????100?????0110011") {}
+        : RiscvInstruction(icpu, "DIV") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_R_type u;
@@ -49,7 +49,7 @@ class DIV : public RiscvInstruction {
 class DIVU : public RiscvInstruction {
  public:
     DIVU(CpuRiver_Functional *icpu)
-        : RiscvInstruction(icpu, "DIVU", "0000001??????????101?????0110011") {}
+        : RiscvInstruction(icpu, "DIVU") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_R_type u;
@@ -69,7 +69,7 @@ class DIVU : public RiscvInstruction {
 class DIVUW : public RiscvInstruction {
  public:
     DIVUW(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "DIVUW", "0000001??????????101?????0111011") {}
+        RiscvInstruction(icpu, "DIVUW") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_R_type u;
@@ -91,7 +91,7 @@ class DIVUW : public RiscvInstruction {
 class DIVW : public RiscvInstruction {
  public:
     DIVW(CpuRiver_Functional *icpu)
-        : RiscvInstruction(icpu, "DIVW", "0000001??????????100?????0111011") {}
+        : RiscvInstruction(icpu, "DIVW") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_R_type u;
@@ -116,7 +116,7 @@ class DIVW : public RiscvInstruction {
 class MUL : public RiscvInstruction {
  public:
     MUL(CpuRiver_Functional *icpu)
-        : RiscvInstruction(icpu, "MUL", "0000001??????????000?????0110011") {}
+        : RiscvInstruction(icpu, "MUL") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_R_type u;
@@ -139,7 +139,7 @@ class MUL : public RiscvInstruction {
 class MULW : public RiscvInstruction {
  public:
     MULW(CpuRiver_Functional *icpu)
-        : RiscvInstruction(icpu, "MULW", "0000001??????????000?????0111011") {}
+        : RiscvInstruction(icpu, "MULW") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_R_type u;
@@ -161,7 +161,7 @@ class MULW : public RiscvInstruction {
 class REM : public RiscvInstruction {
 public:
     REM(CpuRiver_Functional *icpu)
-        : RiscvInstruction(icpu, "REM", "0000001??????????110?????0110011") {}
+        : RiscvInstruction(icpu, "REM") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_R_type u;
@@ -178,7 +178,7 @@ public:
 class REMU : public RiscvInstruction {
 public:
     REMU(CpuRiver_Functional *icpu)
-        : RiscvInstruction(icpu, "REMU", "0000001??????????111?????0110011") {}
+        : RiscvInstruction(icpu, "REMU") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_R_type u;
@@ -199,7 +199,7 @@ public:
 class REMW : public RiscvInstruction {
 public:
     REMW(CpuRiver_Functional *icpu)
-        : RiscvInstruction(icpu, "REMW", "0000001??????????110?????0111011") {}
+        : RiscvInstruction(icpu, "REMW") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_R_type u;
@@ -215,7 +215,7 @@ public:
 class REMUW : public RiscvInstruction {
 public:
     REMUW(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "REMUW", "0000001??????????111?????0111011") {}
+        RiscvInstruction(icpu, "REMUW") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_R_type u;
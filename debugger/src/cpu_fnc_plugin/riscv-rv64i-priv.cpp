@@ -34,7 +34,7 @@ namespace debugger {
 class CSRRC : public RiscvInstruction {
 public:
     CSRRC(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "CSRRC", "?????????????????011?????1110011") {}
+        RiscvInstruction(icpu, "CSRRC") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_I_type u;
@@ -60,7 +60,7 @@ public:
 class CSRRCI : public RiscvInstruction {
 public:
     CSRRCI(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "CSRRCI", "?????????????????111?????1110011") {}
+        RiscvInstruction(icpu, "CSRRCI") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_I_type u;
@@ -90,7 +90,7 @@ public:
 class CSRRS : public RiscvInstruction {
 public:
     CSRRS(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "CSRRS", "?????????????????010?????1110011") {}
+        RiscvInstruction(icpu, "CSRRS") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_I_type u;
@@ -116,7 +116,7 @@ public:
 class CSRRSI : public RiscvInstruction {
 public:
     CSRRSI(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "CSRRSI", "?????????????????110?????1110011") {}
+        RiscvInstruction(icpu, "CSRRSI") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_I_type u;
@@ -144,7 +144,7 @@ public:
 class CSRRW : public RiscvInstruction {
 public:
     CSRRW(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "CSRRW", "?????????????????001?????1110011") {}
+        RiscvInstruction(icpu, "CSRRW") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_I_type u;
@@ -169,7 +169,7 @@ public:
 class CSRRWI : public RiscvInstruction {
 public:
     CSRRWI(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "CSRRWI", "?????????????????101?????1110011") {}
+        RiscvInstruction(icpu, "CSRRWI") {}
 
     virtual int exec(Reg64Type *payload) {
         ISA_I_type u;
@@ -201,7 +201,7 @@ public:
 class URET : public RiscvInstruction {
 public:
     URET(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "URET", "00000000001000000000000001110011") {}
+        RiscvInstruction(icpu, "URET") {}
 
     virtual int exec(Reg64Type *payload) {
         if (icpu_->getPrvLevel() != PRV_U) {
@@ -235,7 +235,7 @@ public:
 class SRET : public RiscvInstruction {
 public:
     SRET(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "SRET", "00010000001000000000000001110011") {}
+        RiscvInstruction(icpu, "SRET") {}
 
     virtual int exec(Reg64Type *payload) {
         if (icpu_->getPrvLevel() != PRV_S) {
@@ -264,7 +264,7 @@ public:
 class HRET : public RiscvInstruction {
 public:
     HRET(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "HRET", "00100000001000000000000001110011") {}
+        RiscvInstruction(icpu, "HRET") {}
 
     virtual int exec(Reg64Type *payload) {
         if (icpu_->getPrvLevel() != PRV_H) {
@@ -293,7 +293,7 @@ public:
 class MRET : public RiscvInstruction {
 public:
     MRET(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "MRET", "00110000001000000000000001110011") {}
+        RiscvInstruction(icpu, "MRET") {}
 
     virtual int exec(Reg64Type *payload) {
         if (icpu_->getPrvLevel() != PRV_M) {
@@ -325,7 +325,7 @@ public:
 class FENCE : public RiscvInstruction {
 public:
     FENCE(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "FENCE", "?????????????????000?????0001111") {}
+        RiscvInstruction(icpu, "FENCE") {}
 
     virtual int exec(Reg64Type *payload) {
         return 4;
@@ -340,7 +340,7 @@ public:
 class FENCE_I : public RiscvInstruction {
 public:
     FENCE_I(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "FENCE_I", "?????????????????001?????0001111") {}
+        RiscvInstruction(icpu, "FENCE_I") {}
 
     virtual int exec(Reg64Type *payload) {
         return 4;
@@ -356,7 +356,7 @@ public:
 class EBREAK : public RiscvInstruction {
 public:
     EBREAK(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "EBREAK", "00000000000100000000000001110011") {}
+        RiscvInstruction(icpu, "EBREAK") {}
 
     virtual int exec(Reg64Type *payload) {
         icpu_->raiseSignal(EXCEPTION_Breakpoint);
@@ -376,7 +376,7 @@ public:
 class ECALL : public RiscvInstruction {
 public:
     ECALL(CpuRiver_Functional *icpu) :
-        RiscvInstruction(icpu, "ECALL", "00000000000000000000000001110011") {}
+        RiscvInstruction(icpu, "ECALL") {}
 
     virtual int exec(Reg64Type *payload) {
         switch (icpu_->getPrvLevel()) {
@@ -17,6 +17,7 @@
 #include "srcproc.h"
 #include <iostream>
 #include <riscv-isa.h>
+#include "../riscv-decoder.h"
 
 namespace debugger {
 
@@ -137,8 +138,6 @@ RiscvSourceService::RiscvSourceService(const char *name) : IService(name) {
     tblCompressed_[0x1E] = &C_SDSP;
 
     brList_.make_list(0);
-    symbolListSortByName_.make_list(0);
-    symbolListSortByAddr_.make_list(0);
 }
 
 RiscvSourceService::~RiscvSourceService() {
@@ -149,117 +148,38 @@ void RiscvSourceService::postinitService() {
 
 void RiscvSourceService::addFileSymbol(const char *name, uint64_t addr,
                                        int sz) {
-    AttributeType symb(Attr_List);
-    symb.make_list(Symbol_Total);
-    symb[Symbol_Name].make_string(name);
-    symb[Symbol_Addr].make_uint64(addr);
-    symb[Symbol_Size].make_int64(sz);
-
-    symbolListSortByName_.add_to_list(&symb);
-    symbolListSortByName_.sort(Symbol_Name);
-
-    symbolListSortByAddr_.add_to_list(&symb);
-    symbolListSortByAddr_.sort(Symbol_Addr);
+    symbols_.add(name, addr, sz, SYMBOL_TYPE_FILE);
 }
 
 void RiscvSourceService::addFunctionSymbol(const char *name,
                                       uint64_t addr, int sz) {
-    addFileSymbol(name, addr, sz);
+    symbols_.add(name, addr, sz, SYMBOL_TYPE_FUNCTION);
 }
 
 void RiscvSourceService::addDataSymbol(const char *name, uint64_t addr,
                                        int sz) {
-    addFileSymbol(name, addr, sz);
+    symbols_.add(name, addr, sz, SYMBOL_TYPE_DATA);
 }
 
 void RiscvSourceService::clearSymbols() {
-    symbolListSortByName_.make_list(0);
-    symbolListSortByAddr_.make_list(0);
+    symbols_.clear();
 }
 
 void RiscvSourceService::addSymbols(AttributeType *list) {
-    for (unsigned i = 0; i < list->size(); i++) {
-        AttributeType &item = (*list)[i];
-        symbolListSortByName_.add_to_list(&item);
-        symbolListSortByAddr_.add_to_list(&item);
-    }
-    symbolListSortByName_.sort(Symbol_Name);
-    symbolListSortByAddr_.sort(Symbol_Addr);
+    symbols_.add(list);
 }
 
 void RiscvSourceService::addressToSymbol(uint64_t addr, AttributeType *info) {
-    uint64_t sadr, send;
-    int sz = static_cast<int>(symbolListSortByAddr_.size());
+    uint64_t off = 0;
+    const char *name = symbols_.findAddress(addr, &off);
 
     info->make_list(SymbInfo_Total);
-    (*info)[SymbInfo_Name].make_string("");
-    (*info)[SymbInfo_Address].make_uint64(0);
-    if (sz == 0) {
-        return;
-    }
-    sadr = symbolListSortByAddr_[0u][Symbol_Addr].to_uint64();
-    if (addr < sadr) {
-        return;
-    }
-
-    bool search = true;
-    int dist, pos = sz / 2;
-    dist = pos;
-    while (search) {
-        AttributeType &symb = symbolListSortByAddr_[pos];
-        sadr = symb[Symbol_Addr].to_uint64();
-        if (pos < static_cast<int>(symbolListSortByAddr_.size()) - 1) {
-            send = symbolListSortByAddr_[pos + 1][Symbol_Addr].to_uint64();
-        } else {
-            send = sadr + symb[Symbol_Size].to_uint64();
-        }
-        if (sadr <= addr && addr < send) {
-            (*info)[SymbInfo_Name] = symb[Symbol_Name];
-            (*info)[SymbInfo_Address].make_uint64(addr - sadr);
-            return;
-        }
-        
-        if (addr < sadr) {
-            if (dist == 0 || pos == 0) {
-                search = false;
-            } else if (dist == 1) {
-                dist = 0;
-                pos--;
-            } else {
-                int incr = dist / 2;
-                pos -= incr;
-                dist = (dist / 2) + (dist & 0x1);
-                if (pos < 0) {
-                    pos = 0;
-                }
-            }
-        } else {
-            if (dist == 0 || pos == (sz - 1)) {
-                search = false;
-            } else if (dist == 1) {
-                dist = 0;
-                pos++;
-            } else {
-                int incr = dist / 2;
-                pos += incr;
-                dist = (dist / 2) + (dist & 0x1);
-                if (pos >= sz) {
-                    pos = sz - 1;
-                }
-            }
-        }
-    }
+    (*info)[SymbInfo_Name].make_string(name ? name : "");
+    (*info)[SymbInfo_Address].make_uint64(off);
 }
 
 int RiscvSourceService::symbol2Address(const char *name, uint64_t *addr) {
-    for (unsigned i = 0; i < symbolListSortByName_.size(); i++) {
-        AttributeType &item = symbolListSortByName_[i];
-        if (item[Symbol_Name].is_equal(name)) {
-            *addr = item[Symbol_Addr].to_uint64();
-            return 0;
-        }
-    }
-    return -1;
+    return symbols_.find(name, addr);
 }
 
 void RiscvSourceService::registerBreakpoint(uint64_t addr, uint64_t flags,
@@ -279,6 +199,7 @@ void RiscvSourceService::registerBreakpoint(uint64_t addr, uint64_t flags,
     }
     if (not_found) {
         brList_.add_to_list(&item);
+        brIndex_.add(addr);
     }
 }
 
@@ -290,6 +211,7 @@ int RiscvSourceService::unregisterBreakpoint(uint64_t addr, uint64_t *flags,
             *flags = br[BrkList_flags].to_uint64();
             *instr = br[BrkList_instr].to_uint64();
             brList_.remove_from_list(i);
+            brIndex_.remove(addr);
             return 0;
         }
     }
@@ -314,6 +236,9 @@ void RiscvSourceService::getBreakpointList(AttributeType *list) {
 }
 
 bool RiscvSourceService::isBreakpoint(uint64_t addr, AttributeType *outbr) {
+    if (!brIndex_.contains(addr)) {
+        return false;
+    }
     for (unsigned i = 0; i < brList_.size(); i++) {
         uint64_t bradr = brList_[i][BrkList_address].to_uint64();
         if (addr == bradr) {
@@ -330,10 +255,17 @@ int RiscvSourceService::disasm(uint64_t pc,
                        AttributeType *mnemonic,
                        AttributeType *comment) {
     int oplen;
-    if ((data[offset] & 0x3) < 3) {
+    uint32_t opcode = *reinterpret_cast<uint16_t*>(&data[offset]);
+    if ((opcode & 0x3) == 0x3) {
+        opcode = *reinterpret_cast<uint32_t*>(&data[offset]);
+    }
+    if (RiscvDecoder::instance()->decode(opcode) < 0) {
+        // Not an instruction of the functional model ISA table
+        oplen = (opcode & 0x3) == 0x3 ? 4 : 2;
+    } else if ((opcode & 0x3) < 3) {
         Reg16Type val;
         uint32_t hash;
-        val.word = *reinterpret_cast<uint16_t*>(&data[offset]);
+        val.word = static_cast<uint16_t>(opcode);
         hash = ((val.word >> 11) & 0x1C) | (val.word & 0x3);
         oplen = 2;
         if (tblCompressed_[hash]) {
@@ -343,8 +275,8 @@ int RiscvSourceService::disasm(uint64_t pc,
                                         mnemonic,
                                         comment);
         }
-    } else if ((data[offset] & 0x3) == 0x3) {
-        uint32_t val = *reinterpret_cast<uint32_t*>(&data[offset]);
+    } else {
+        uint32_t val = opcode;
         uint32_t opcode1 = (val >> 2) & 0x1f;
         oplen = 4;
         if (tblOpcode1_[opcode1]) {
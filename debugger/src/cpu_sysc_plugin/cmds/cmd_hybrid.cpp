@@ -0,0 +1,139 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "iservice.h"
+#include "cmd_hybrid.h"
+#include "../cpu_riscv_rtl.h"
+
+namespace debugger {
+
+CmdHybrid::CmdHybrid(ITap *tap, CpuRiscV_RTL *cpu)
+    : ICommand ("hybrid", tap), cpu_(cpu) {
+
+    briefDescr_.make_string("Fast-forward functional model then run RTL");
+    detailedDescr_.make_string(
+        "Description:\n"
+        "    Run functional model up to the specified step or pc, move\n"
+        "    the registers into RTL model and simulate the window of clock\n"
+        "    cycles. Without window argument the HybridWindow attribute is\n"
+        "    used. Functional model is resumed after the window when\n"
+        "    'return' is on.\n"
+        "Output format:\n"
+        "    {'Mode':s,'Window':i,'Return':b,'Switches':i,\n"
+        "     'Clocks':i,'Instructions':i,'CPI':d}\n"
+        "Usage:\n"
+        "    hybrid\n"
+        "    hybrid steps <n> [window]\n"
+        "    hybrid pc <addr|symbol> [window]\n"
+        "    hybrid rtl [window]\n"
+        "    hybrid functional\n"
+        "    hybrid return on|off\n"
+        "Example:\n"
+        "    hybrid steps 200000000 1000000\n"
+        "    hybrid pc main\n");
+
+    AttributeType lstServ;
+    RISCV_get_services_with_iface(IFACE_SOURCE_CODE, &lstServ);
+    isrc_ = 0;
+    if (lstServ.size() != 0) {
+        IService *iserv = static_cast<IService *>(lstServ[0u].to_iface());
+        isrc_ = static_cast<ISourceCode *>(
+                            iserv->getInterface(IFACE_SOURCE_CODE));
+    }
+}
+
+int CmdHybrid::isValid(AttributeType *args) {
+    if (!cmdName_.is_equal((*args)[0u].to_string())) {
+        return CMD_INVALID;
+    }
+    if (args->size() == 1) {
+        return CMD_VALID;
+    }
+    AttributeType &mode = (*args)[1];
+    if (!mode.is_string() || args->size() > 4) {
+        return CMD_WRONG_ARGS;
+    }
+    if (args->size() == 4 && !(*args)[3].is_integer()) {
+        return CMD_WRONG_ARGS;
+    }
+    if (mode.is_equal("steps") && args->size() >= 3
+        && (*args)[2].is_integer()) {
+        return CMD_VALID;
+    }
+    if (mode.is_equal("pc") && args->size() >= 3) {
+        return CMD_VALID;
+    }
+    if (mode.is_equal("rtl") && args->size() <= 3) {
+        if (args->size() == 2 || (*args)[2].is_integer()) {
+            return CMD_VALID;
+        }
+    }
+    if (mode.is_equal("functional") && args->size() == 2) {
+        return CMD_VALID;
+    }
+    if (mode.is_equal("return") && args->size() == 3
+        && ((*args)[2].is_equal("on") || (*args)[2].is_equal("off"))) {
+        return CMD_VALID;
+    }
+    return CMD_WRONG_ARGS;
+}
+
+void CmdHybrid::exec(AttributeType *args, AttributeType *res) {
+    res->attr_free();
+    res->make_nil();
+    if (isValid(args) != CMD_VALID) {
+        generateError(res, "Wrong argument list");
+        return;
+    }
+    if (args->size() == 1) {
+        cpu_->hybridStatus(res);
+        return;
+    }
+
+    AttributeType &mode = (*args)[1];
+    uint64_t window = 0;
+    if (mode.is_equal("functional")) {
+        cpu_->hybridSwitchBack();
+    } else if (mode.is_equal("return")) {
+        cpu_->hybridReturn((*args)[2].is_equal("on"));
+    } else if (mode.is_equal("rtl")) {
+        if (args->size() == 3) {
+            window = (*args)[2].to_uint64();
+        }
+        cpu_->hybridRun(HybridTarget_Now, 0, window);
+    } else if (mode.is_equal("steps")) {
+        if (args->size() == 4) {
+            window = (*args)[3].to_uint64();
+        }
+        cpu_->hybridRun(HybridTarget_Steps, (*args)[2].to_uint64(), window);
+    } else {
+        uint64_t addr = 0;
+        AttributeType &target = (*args)[2];
+        if (target.is_integer()) {
+            addr = target.to_uint64();
+        } else if (!target.is_string() || !isrc_
+            || isrc_->symbol2Address(target.to_string(), &addr) < 0) {
+            generateError(res, "Symbol not found");
+            return;
+        }
+        if (args->size() == 4) {
+            window = (*args)[3].to_uint64();
+        }
+        cpu_->hybridRun(HybridTarget_Pc, addr, window);
+    }
+}
+
+}  // namespace debugger
@@ -16,13 +16,27 @@
 
 #include "api_core.h"
 #include "cpu_riscv_rtl.h"
+#include "debug/dsumap.h"
+#include <riscv-isa.h>
 
 namespace debugger {
 
+/** CSRs implemented in RTL model. They are moved in both directions. */
+static const uint16_t HYBRID_CSR[] = {
+    CSR_mstatus, CSR_mtvec, CSR_mscratch, CSR_mepc
+};
+/** Read-only in RTL model. They are returned into functional model only. */
+static const uint16_t HYBRID_CSR_RO[] = {
+    CSR_mcause, CSR_mbadaddr
+};
+static const int HYBRID_DPORT_TIMEOUT = 1000;   // clock cycles
+static const uint64_t HYBRID_CHUNK = 10000;     // clock cycles per sc_start()
+
 CpuRiscV_RTL::CpuRiscV_RTL(const char *name)  
     : IService(name), IHap(HAP_ConfigDone) {
     registerInterface(static_cast<IThread *>(this));
     registerInterface(static_cast<IClock *>(this));
+    registerInterface(static_cast<IDbgNbResponse *>(this));
     registerInterface(static_cast<IHap *>(this));
     registerAttribute("Bus", &bus_);
     registerAttribute("CmdExecutor", &cmdexec_);
@@ -31,12 +45,37 @@ CpuRiscV_RTL::CpuRiscV_RTL(const char *name)
     registerAttribute("InVcdFile", &InVcdFile_);
     registerAttribute("OutVcdFile", &OutVcdFile_);
     registerAttribute("GenerateRef", &GenerateRef_);
+    registerAttribute("FastForward", &fastForward_);
+    registerAttribute("HybridWindow", &hybridWindow_);
+    registerAttribute("HybridReturn", &hybridReturn_);
 
     bus_.make_string("");
     freqHz_.make_uint64(1);
     InVcdFile_.make_string("");
     OutVcdFile_.make_string("");
     GenerateRef_.make_boolean(false);
+    fastForward_.make_string("");
+    hybridWindow_.make_uint64(100000);
+    hybridReturn_.make_boolean(true);
+    iffwd_ = 0;
+    iffwdgen_ = 0;
+    iffwdclk_ = 0;
+    iffwdbus_ = 0;
+    hybridState_ = Hybrid_Functional;
+    runRequest_ = false;
+    reqType_ = HybridTarget_Now;
+    reqTarget_ = 0;
+    targetType_ = HybridTarget_Now;
+    switchBack_ = false;
+    target_ = 0;
+    targetStep_ = 0;
+    window_ = 0;
+    dportDone_ = false;
+    ffDone_ = false;
+    switches_ = 0;
+    lastClocks_ = 0;
+    lastInstr_ = 0;
+    pcmd_hybrid_ = 0;
     RISCV_event_create(&config_done_, "riscv_sysc_config_done");
     RISCV_register_hap(static_cast<IHap *>(this));
 
@@ -73,6 +112,31 @@ void CpuRiscV_RTL::postinitService() {
         return;
     }
 
+    if (fastForward_.size()) {
+        const char *ffname = fastForward_.to_string();
+        IService *iserv = static_cast<IService *>(RISCV_get_service(ffname));
+        AttributeType *dbgbus = 0;
+        if (iserv) {
+            dbgbus = static_cast<AttributeType *>(
+                            iserv->getAttribute("DbgBus"));
+        }
+        if (dbgbus && dbgbus->is_string()) {
+            iffwdbus_ = static_cast<IMemoryOperation *>(
+                RISCV_get_service_iface(dbgbus->to_string(),
+                                        IFACE_MEMORY_OPERATION));
+        }
+        iffwd_ = static_cast<ICpuFunctional *>(
+            RISCV_get_service_iface(ffname, IFACE_CPU_FUNCTIONAL));
+        iffwdgen_ = static_cast<ICpuGeneric *>(
+            RISCV_get_service_iface(ffname, IFACE_CPU_GENERIC));
+        iffwdclk_ = static_cast<IClock *>(
+            RISCV_get_service_iface(ffname, IFACE_CLOCK));
+        if (!iffwd_ || !iffwdgen_ || !iffwdclk_ || !iffwdbus_) {
+            RISCV_error("Functional model '%s' not found", ffname);
+            iffwd_ = 0;
+        }
+    }
+
     if (InVcdFile_.size()) {
         i_vcd_ = sc_create_vcd_trace_file(InVcdFile_.to_string());
         i_vcd_->set_time_unit(1, SC_PS);
@@ -106,6 +170,11 @@ void CpuRiscV_RTL::postinitService() {
     pcmd_regs_ = new CmdRegsRiscv(itap_);
     icmdexec_->registerCommand(static_cast<ICommand *>(pcmd_regs_));
 
+    if (iffwd_) {
+        pcmd_hybrid_ = new CmdHybrid(itap_, this);
+        icmdexec_->registerCommand(static_cast<ICommand *>(pcmd_hybrid_));
+    }
+
     if (!run()) {
         RISCV_error("Can't create thread.", NULL);
         return;
@@ -121,6 +190,10 @@ void CpuRiscV_RTL::predeleteService() {
     delete pcmd_csr_;
     delete pcmd_reg_;
     delete pcmd_regs_;
+    if (pcmd_hybrid_) {
+        icmdexec_->unregisterCommand(static_cast<ICommand *>(pcmd_hybrid_));
+        delete pcmd_hybrid_;
+    }
 }
 
 void CpuRiscV_RTL::createSystemC() {
@@ -186,6 +259,11 @@ void CpuRiscV_RTL::hapTriggered(IFace *isrc, EHapType type,
 }
 
 void CpuRiscV_RTL::stop() {
+    if (iffwd_) {
+        // Hybrid loop runs SystemC by chunks and checks isEnabled()
+        IThread::stop();
+        return;
+    }
     sc_stop();
     IThread::stop();
 }
@@ -193,7 +271,11 @@ void CpuRiscV_RTL::stop() {
 void CpuRiscV_RTL::busyLoop() {
     RISCV_event_wait(&config_done_);
 
-    sc_start();
+    if (iffwd_) {
+        hybridLoop();
+    } else {
+        sc_start();
+    }
 
     if (i_vcd_) {
         sc_close_vcd_trace_file(i_vcd_);
@@ -203,5 +285,344 @@ void CpuRiscV_RTL::busyLoop() {
     }
 }
 
-}  // namespace debugger
+/**
+ * Called from the command thread: the request is only stored, the
+ * functional model is controlled by hybridLoop() through its debug port.
+ */
+void CpuRiscV_RTL::hybridRun(EHybridTarget type, uint64_t target,
+                             uint64_t window) {
+    if (hybridState_ == Hybrid_Rtl || hybridState_ == Hybrid_RtlHalted) {
+        RISCV_error("RTL model is already active", NULL);
+        return;
+    }
+    window_ = window ? window : hybridWindow_.to_uint64();
+    reqType_ = type;
+    reqTarget_ = target;
+    switchBack_ = false;
+    runRequest_ = true;
+}
+
+void CpuRiscV_RTL::hybridSwitchBack() {
+    switchBack_ = true;
+}
+
+void CpuRiscV_RTL::hybridStatus(AttributeType *res) {
+    static const char *MODE_NAME[] = {
+        "functional", "fastforward", "rtl", "rtl_halted"
+    };
+    res->make_dict();
+    (*res)["Mode"].make_string(MODE_NAME[hybridState_]);
+    (*res)["Window"].make_uint64(hybridWindow_.to_uint64());
+    (*res)["Return"].make_boolean(hybridReturn_.to_bool());
+    (*res)["Switches"].make_uint64(switches_);
+    (*res)["Clocks"].make_uint64(lastClocks_);
+    (*res)["Instructions"].make_uint64(lastInstr_);
+    if (lastInstr_) {
+        (*res)["CPI"].make_floating(static_cast<double>(lastClocks_)
+                                  / static_cast<double>(lastInstr_));
+    } else {
+        (*res)["CPI"].make_floating(0);
+    }
+}
+
+void CpuRiscV_RTL::nb_response_debug_port(DebugPortTransactionType *trans) {
+    if (trans == &ffTrans_) {
+        ffDone_ = true;
+    } else {
+        dportDone_ = true;
+    }
+}
 
+/**
+ * Called only from the SystemC thread: transaction is latched by wrapper
+ * on the clock edge so the simulation is advanced until the response.
+ */
+bool CpuRiscV_RTL::dportAccess(uint64_t off, bool write, uint64_t *data) {
+    dportTrans_.write = write;
+    dportTrans_.region = static_cast<uint8_t>((off >> 15) & 0x3);
+    dportTrans_.addr = static_cast<uint16_t>(off & 0x7FFF);
+    dportTrans_.bytes = 8;
+    dportTrans_.wdata = *data;
+    dportTrans_.rdata = 0;
+    dportDone_ = false;
+    wrapper_->nb_transport_debug_port(&dportTrans_,
+                                      static_cast<IDbgNbResponse *>(this));
+    for (int i = 0; i < HYBRID_DPORT_TIMEOUT && !dportDone_; i++) {
+        sc_start(clkPeriod_);
+    }
+    if (!dportDone_) {
+        RISCV_error("Debug port timeout: region=%d addr=%04x",
+                    dportTrans_.region, dportTrans_.addr);
+        return false;
+    }
+    *data = dportTrans_.rdata;
+    return true;
+}
+
+/**
+ * Debug port of the functional model is served by its own thread between
+ * instructions, so breakpoints and run control are changed without racing
+ * with the executed code.
+ */
+bool CpuRiscV_RTL::ffdportAccess(uint64_t off, bool write, uint64_t *data) {
+    ffTrans_.write = write;
+    ffTrans_.region = static_cast<uint8_t>((off >> 15) & 0x3);
+    ffTrans_.addr = static_cast<uint16_t>(off & 0x7FFF);
+    ffTrans_.bytes = 8;
+    ffTrans_.wdata = *data;
+    ffTrans_.rdata = 0;
+    ffDone_ = false;
+    iffwdgen_->nb_transport_debug_port(&ffTrans_,
+                                       static_cast<IDbgNbResponse *>(this));
+    for (int i = 0; i < HYBRID_DPORT_TIMEOUT && !ffDone_; i++) {
+        RISCV_sleep_ms(1);
+    }
+    if (!ffDone_) {
+        RISCV_error("Functional model debug port timeout: addr=%04x",
+                    ffTrans_.addr);
+        return false;
+    }
+    *data = ffTrans_.rdata;
+    return true;
+}
+
+uint64_t CpuRiscV_RTL::readFunctional(uint64_t off) {
+    Axi4TransactionType tr;
+    tr.action = MemAction_Read;
+    tr.addr = off;
+    tr.xsize = 8;
+    tr.source_idx = 0;
+    tr.rpayload.b64[0] = 0;
+    iffwdbus_->b_transport(&tr);
+    return tr.rpayload.b64[0];
+}
+
+void CpuRiscV_RTL::writeFunctional(uint64_t off, uint64_t val) {
+    Axi4TransactionType tr;
+    tr.action = MemAction_Write;
+    tr.addr = off;
+    tr.xsize = 8;
+    tr.wstrb = 0xFF;
+    tr.source_idx = 0;
+    tr.wpayload.b64[0] = val;
+    iffwdbus_->b_transport(&tr);
+}
+
+/**
+ * Steps target uses the stepping mode of the functional model, pc target
+ * uses the HW breakpoint. Both are set through the debug port of the model
+ * so they are applied between instructions.
+ */
+bool CpuRiscV_RTL::startFastForward() {
+    GenericCpuControlType ctrl;
+    uint64_t val = target_;
+    bool ok = true;
+    if (hybridState_ == Hybrid_FastForward
+        && targetType_ == HybridTarget_Pc) {
+        // Previous target is replaced
+        ffdportAccess(DSUREG(udbg.v.remove_breakpoint), true, &val);
+    }
+    targetType_ = reqType_;
+    target_ = reqTarget_;
+    val = target_;
+    ctrl.val = 0;
+    switch (targetType_) {
+    case HybridTarget_Now:
+        if (iffwd_->isHalt()) {
+            return true;
+        }
+        ctrl.bits.halt = 1;
+        break;
+    case HybridTarget_Steps:
+        // Step counter is read while the model is halted, otherwise it is
+        // ahead by the time the stepping request is served
+        ctrl.bits.halt = 1;
+        if (!iffwd_->isHalt()
+            && !ffdportAccess(DSUREG(udbg.v.control), true, &ctrl.val)) {
+            return false;
+        }
+        targetStep_ = iffwdclk_->getStepCounter() + target_;
+        ok = ffdportAccess(DSUREG(udbg.v.stepping_mode_steps), true, &val);
+        ctrl.val = 0;
+        ctrl.bits.stepping = 1;
+        break;
+    case HybridTarget_Pc:
+        if (!iffwd_->isHalt()) {
+            // Running model may stop on the new breakpoint at any moment
+            return ffdportAccess(DSUREG(udbg.v.add_breakpoint), true, &val);
+        }
+        ok = ffdportAccess(DSUREG(udbg.v.add_breakpoint), true, &val);
+        break;
+    default:;
+    }
+    return ok && ffdportAccess(DSUREG(udbg.v.control), true, &ctrl.val);
+}
+
+bool CpuRiscV_RTL::targetReached() {
+    GenericCpuControlType ctrl;
+    uint64_t val;
+    if (!iffwd_->isHalt()) {
+        if (targetType_ == HybridTarget_Steps
+            && iffwdclk_->getStepCounter() >= targetStep_) {
+            // Resumed by user before the end of stepping
+            ctrl.val = 0;
+            ctrl.bits.halt = 1;
+            ffdportAccess(DSUREG(udbg.v.control), true, &ctrl.val);
+        }
+        return false;
+    }
+    switch (targetType_) {
+    case HybridTarget_Steps:
+        // Halted by user, wait until resumed
+        return iffwdclk_->getStepCounter() >= targetStep_;
+    case HybridTarget_Pc:
+        if (iffwd_->getPC() != target_) {
+            return false;
+        }
+        val = target_;
+        return ffdportAccess(DSUREG(udbg.v.remove_breakpoint), true, &val);
+    default:;
+    }
+    return true;
+}
+
+bool CpuRiscV_RTL::moveToRtl(uint64_t off) {
+    uint64_t val = readFunctional(off);
+    return dportAccess(off, true, &val);
+}
+
+bool CpuRiscV_RTL::moveToFunctional(uint64_t off) {
+    uint64_t val = 0;
+    if (!dportAccess(off, false, &val)) {
+        return false;
+    }
+    writeFunctional(off, val);
+    return true;
+}
+
+/**
+ * Both models share the system bus so memory isn't copied: only registers,
+ * privilege level and pc are moved while both CPUs are halted.
+ */
+bool CpuRiscV_RTL::switchToRtl() {
+    bool ok = true;
+    for (int i = 1; i < 32 && ok; i++) {
+        ok = moveToRtl(DSUREG(ureg.v.iregs[i]));
+    }
+    for (unsigned i = 0; i < sizeof(HYBRID_CSR)/sizeof(HYBRID_CSR[0]) && ok;
+         i++) {
+        ok = moveToRtl(DSUREG(csr[HYBRID_CSR[i]]));
+    }
+    uint64_t prv = iffwd_->getPrvLevel();
+    if (!ok || !dportAccess(DSUREG(csr[CSR_dcsr]), true, &prv)
+        || !moveToRtl(DSUREG(ureg.v.npc))) {
+        RISCV_error("Can't move state into RTL model", NULL);
+        return false;
+    }
+    switches_++;
+    RISCV_info("Switched to RTL at pc=%08" RV_PRI64 "x",
+               readFunctional(DSUREG(ureg.v.npc)));
+    return true;
+}
+
+bool CpuRiscV_RTL::switchToFunctional() {
+    bool ok = true;
+    for (int i = 1; i < 32 && ok; i++) {
+        ok = moveToFunctional(DSUREG(ureg.v.iregs[i]));
+    }
+    for (unsigned i = 0; i < sizeof(HYBRID_CSR)/sizeof(HYBRID_CSR[0]) && ok;
+         i++) {
+        ok = moveToFunctional(DSUREG(csr[HYBRID_CSR[i]]));
+    }
+    for (unsigned i = 0;
+         i < sizeof(HYBRID_CSR_RO)/sizeof(HYBRID_CSR_RO[0]) && ok; i++) {
+        ok = moveToFunctional(DSUREG(csr[HYBRID_CSR_RO[i]]));
+    }
+    uint64_t prv = 0;
+    if (!ok || !dportAccess(DSUREG(csr[CSR_dcsr]), false, &prv)
+        || !moveToFunctional(DSUREG(ureg.v.npc))) {
+        RISCV_error("Can't move state into functional model", NULL);
+        return false;
+    }
+    iffwd_->setPrvLevel(prv & 0x3);
+    // Memory could be modified by RTL model
+    iffwd_->flush(~0ull);
+    switches_++;
+    RISCV_info("Switched to functional model at pc=%08" RV_PRI64 "x",
+               readFunctional(DSUREG(ureg.v.npc)));
+    iffwd_->go();
+    return true;
+}
+
+bool CpuRiscV_RTL::runRtl(uint64_t cycles) {
+    uint64_t clk0 = 0;
+    uint64_t instr0 = 0;
+    uint64_t val = 0;
+    bool ok = dportAccess(DSUREG(udbg.v.clock_cnt), false, &clk0)
+           && dportAccess(DSUREG(udbg.v.executed_cnt), false, &instr0)
+           && dportAccess(DSUREG(udbg.v.control), true, &val);
+    while (ok && cycles && isEnabled() && !switchBack_) {
+        uint64_t n = cycles < HYBRID_CHUNK ? cycles : HYBRID_CHUNK;
+        sc_start(static_cast<double>(n) * clkPeriod_);
+        cycles -= n;
+    }
+    val = 1;
+    ok = ok && dportAccess(DSUREG(udbg.v.control), true, &val)
+            && dportAccess(DSUREG(udbg.v.clock_cnt), false, &val);
+    lastClocks_ = val - clk0;
+    ok = ok && dportAccess(DSUREG(udbg.v.executed_cnt), false, &val);
+    lastInstr_ = val - instr0;
+    RISCV_info("RTL window: %" RV_PRI64 "d clocks, %" RV_PRI64 "d instr",
+               lastClocks_, lastInstr_);
+    return ok;
+}
+
+void CpuRiscV_RTL::hybridLoop() {
+    uint64_t val = 1;
+    clkPeriod_ = wrapper_->o_clk.period();
+
+    // RTL model must not execute boot code while functional model is active
+    for (int i = 0; i < HYBRID_DPORT_TIMEOUT && !w_nrst.read(); i++) {
+        sc_start(clkPeriod_);
+    }
+    dportAccess(DSUREG(udbg.v.control), true, &val);
+
+    while (isEnabled()) {
+        if (runRequest_ && (hybridState_ == Hybrid_Functional
+                         || hybridState_ == Hybrid_FastForward)) {
+            runRequest_ = false;
+            if (startFastForward()) {
+                hybridState_ = Hybrid_FastForward;
+            }
+            continue;
+        }
+        switch (hybridState_) {
+        case Hybrid_FastForward:
+            if (targetReached()) {
+                hybridState_ = switchToRtl() ? Hybrid_Rtl : Hybrid_Functional;
+                continue;
+            }
+            break;
+        case Hybrid_Rtl:
+            runRtl(window_);
+            hybridState_ = Hybrid_RtlHalted;
+            if (hybridReturn_.to_bool()) {
+                switchBack_ = true;
+            }
+            continue;
+        case Hybrid_RtlHalted:
+            if (switchBack_) {
+                switchBack_ = false;
+                if (switchToFunctional()) {
+                    hybridState_ = Hybrid_Functional;
+                }
+                continue;
+            }
+            break;
+        default:;
+        }
+        RISCV_sleep_ms(10);
+    }
+}
+
+}  // namespace debugger
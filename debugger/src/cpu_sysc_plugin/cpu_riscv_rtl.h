@@ -21,6 +21,13 @@
  *
  * @note       When GenerateRef is true Core uses step counter instead 
  *             of clock counter to generate callbacks.
+ *
+ *             FastForward - Name of the functional CPU sharing the same
+ *                           system bus. RTL model is paused while the
+ *                           functional model runs up to the specified
+ *                           step or pc, then the architectural state is
+ *                           moved into RTL through the debug port (see
+ *                           'hybrid' command).
  */
 
 #ifndef __DEBUGGER_CPU_RISCV_RTL_H__
@@ -36,19 +43,36 @@
 #include "coreservices/iclock.h"
 #include "coreservices/icmdexec.h"
 #include "coreservices/itap.h"
+#include "coreservices/icpugen.h"
+#include "coreservices/icpufunctional.h"
 #include "cmds/cmd_br_riscv.h"
 #include "cmds/cmd_reg_riscv.h"
 #include "cmds/cmd_regs_riscv.h"
 #include "cmds/cmd_csr.h"
+#include "cmds/cmd_hybrid.h"
 #include "rtl_wrapper.h"
 #include "riverlib/river_top.h"
 #include <systemc.h>
 
 namespace debugger {
 
+enum EHybridState {
+    Hybrid_Functional,      // functional model is running
+    Hybrid_FastForward,     // waiting the functional model reaches target
+    Hybrid_Rtl,             // RTL model runs the measurement window
+    Hybrid_RtlHalted        // window finished without switching back
+};
+
+enum EHybridTarget {
+    HybridTarget_Now,
+    HybridTarget_Steps,
+    HybridTarget_Pc
+};
+
 class CpuRiscV_RTL : public IService, 
                  public IThread,
                  public IClock,
+                 public IDbgNbResponse,
                  public IHap {
  public:
     CpuRiscV_RTL(const char *name);
@@ -78,11 +102,20 @@ class CpuRiscV_RTL : public IService,
 
     virtual double getFreqHz() { return 1.0; }
 
+    /** IDbgNbResponse */
+    virtual void nb_response_debug_port(DebugPortTransactionType *trans);
+
     /** IHap */
     virtual void hapTriggered(IFace *isrc, EHapType type, const char *descr);
 
     virtual void stop();
 
+    /** Hybrid simulation control used by 'hybrid' command */
+    void hybridRun(EHybridTarget type, uint64_t target, uint64_t window);
+    void hybridSwitchBack();
+    void hybridReturn(bool v) { hybridReturn_.make_boolean(v); }
+    void hybridStatus(AttributeType *res);
+
  protected:
     /** IThread interface */
     virtual void busyLoop();
@@ -91,6 +124,19 @@ class CpuRiscV_RTL : public IService,
     void createSystemC();
     void deleteSystemC();
 
+    void hybridLoop();
+    bool startFastForward();
+    bool targetReached();
+    bool switchToRtl();
+    bool switchToFunctional();
+    bool runRtl(uint64_t cycles);
+    bool dportAccess(uint64_t off, bool write, uint64_t *data);
+    bool ffdportAccess(uint64_t off, bool write, uint64_t *data);
+    uint64_t readFunctional(uint64_t off);
+    void writeFunctional(uint64_t off, uint64_t val);
+    bool moveToRtl(uint64_t off);
+    bool moveToFunctional(uint64_t off);
+
  private:
     AttributeType bus_;
     AttributeType cmdexec_;
@@ -99,11 +145,37 @@ class CpuRiscV_RTL : public IService,
     AttributeType InVcdFile_;
     AttributeType OutVcdFile_;
     AttributeType GenerateRef_;
+    AttributeType fastForward_;
+    AttributeType hybridWindow_;
+    AttributeType hybridReturn_;
     event_def config_done_;
 
     ICmdExecutor *icmdexec_;
     ITap *itap_;
     IMemoryOperation *ibus_;
+    ICpuFunctional *iffwd_;         // functional model used to fast-forward
+    ICpuGeneric *iffwdgen_;
+    IClock *iffwdclk_;
+    IMemoryOperation *iffwdbus_;    // debug bus of the functional model
+
+    volatile EHybridState hybridState_;
+    volatile bool runRequest_;      // set by 'hybrid' command
+    EHybridTarget reqType_;
+    uint64_t reqTarget_;
+    EHybridTarget targetType_;
+    volatile bool switchBack_;
+    uint64_t target_;
+    uint64_t targetStep_;
+    uint64_t window_;
+    sc_time clkPeriod_;
+    DebugPortTransactionType dportTrans_;
+    volatile bool dportDone_;
+    DebugPortTransactionType ffTrans_;
+    volatile bool ffDone_;
+    // Statistic of the last cycle-accurate window:
+    uint64_t switches_;
+    uint64_t lastClocks_;
+    uint64_t lastInstr_;
 
     sc_signal<bool> w_clk;
     sc_signal<bool> w_nrst;
@@ -139,6 +211,7 @@ class CpuRiscV_RTL : public IService,
     CmdRegRiscv *pcmd_reg_;
     CmdRegsRiscv *pcmd_regs_;
     CmdCsr *pcmd_csr_;
+    CmdHybrid *pcmd_hybrid_;
 };
 
 DECLARE_CLASS(CpuRiscV_RTL)
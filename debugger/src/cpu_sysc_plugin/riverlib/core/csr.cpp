@@ -197,6 +197,13 @@ void CsrRegs::comb() {
 
     procedure_RegAccess(i_dport_addr.read(), w_dport_wena,
                         i_dport_wdata.read(), r, &v, &wb_dport_rdata);
+    if (i_dport_addr.read() == CSR_dcsr) {
+        // Privilege level isn't visible for instructions
+        wb_dport_rdata(1, 0) = r.mode;
+        if (w_dport_wena) {
+            v.mode = i_dport_wdata.read()(1, 0);
+        }
+    }
 
 
     if (i_addr.read() == CSR_mepc && i_xret.read()) {
@@ -107,7 +107,6 @@ void RtlWrapper::clk_negedge_proc() {
     /** Simulation events queue */
     IFace *cb;
 
-    step_queue_.initProc();
     step_queue_.pushPreQueued();
     uint64_t step_cnt = i_time.read();
     while ((cb = step_queue_.getNext(step_cnt)) != 0) {
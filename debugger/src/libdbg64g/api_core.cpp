@@ -29,6 +29,7 @@
 #include "services/comport/comport.h"
 #include "services/console/autocompleter.h"
 #include "services/console/console.h"
+#include "services/profiler/profiler.h"
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
@@ -71,6 +72,7 @@ extern "C" int RISCV_init() {
     REGISTER_CLASS_IDX(AutoCompleter, 10);
     REGISTER_CLASS_IDX(ConsoleService, 11);
     REGISTER_CLASS_IDX(EdclService, 12);
+    REGISTER_CLASS_IDX(ProfilerService, 13);
 
     pcore_->load_plugins();
     return 0;
@@ -309,11 +311,22 @@ extern "C" void RISCV_disable_log() {
     pcore_->closeLog();
 }
 
+extern "C" int RISCV_is_log_enabled(void *iface, int level) {
+    IFace *iout = reinterpret_cast<IFace *>(iface);
+    if (iout == NULL || strcmp(iout->getFaceName(), IFACE_SERVICE) != 0) {
+        return 1;
+    }
+    return level <= static_cast<IService *>(iout)->getLogLevel();
+}
+
 extern "C" int RISCV_printf(void *iface, int level, 
                             const char *fmt, ...) {
     int ret = 0;
     va_list arg;
     IFace *iout = reinterpret_cast<IFace *>(iface);
+    if (!RISCV_is_log_enabled(iface, level)) {
+        return 0;
+    }
     uint64_t cur_t = pcore_->getTimestamp();
 
     char *buf = pcore_->getpBufLog();
@@ -324,12 +337,6 @@ extern "C" int RISCV_printf(void *iface, int level,
                     "[%" RV_PRI64 "d, \"%s\", \"", cur_t, "unknown");
     } else if (strcmp(iout->getFaceName(), IFACE_SERVICE) == 0) {
         IService *iserv = static_cast<IService *>(iout);
-        AttributeType *local_level = 
-                static_cast<AttributeType *>(iserv->getAttribute("LogLevel"));
-        if (level > static_cast<int>(local_level->to_int64())) {
-            pcore_->unlockPrintf();
-            return 0;
-        }
         ret = RISCV_sprintf(buf, buf_sz,
                 "[%" RV_PRI64 "d, \"%s\", \"", cur_t, iserv->getObjName());
     } else if (strcmp(iout->getFaceName(), IFACE_CLASS) == 0) {
@@ -407,6 +414,15 @@ extern "C" void RISCV_memory_barrier() {
 #endif
 }
 
+extern "C" uint64_t RISCV_atomic_add64(volatile uint64_t *p, uint64_t v) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    return static_cast<uint64_t>(InterlockedExchangeAdd64(
+        reinterpret_cast<volatile LONG64 *>(p), static_cast<LONG64>(v)));
+#else
+    return __sync_fetch_and_add(p, v);
+#endif
+}
+
 extern "C" void RISCV_thread_create(void *data) {
     LibThreadType *p = (LibThreadType *)data;
 #if defined(_WIN32) || defined(__CYGWIN__)
@@ -162,6 +162,7 @@ class ElfHeaderType {
             }
         }
     }
+    virtual ~ElfHeaderType() {}
 
     virtual bool isElf() { return isElf_; }
     virtual bool isElf32() { return is32b_; }
@@ -274,6 +275,7 @@ class SectionHeaderType {
             }
         }
     }
+    virtual ~SectionHeaderType() {}
     virtual ElfWord get_name() { return sh_name_; }
     virtual ElfWord get_type() { return sh_type_; }
     virtual uint64_t get_offset() { return sh_offset_; }
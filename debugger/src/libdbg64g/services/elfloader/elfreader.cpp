@@ -16,24 +16,113 @@
 
 #include "elfreader.h"
 #include <iostream>
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
 
 namespace debugger {
 
+/** DWARF line program opcodes */
+enum EDwarfLineOpcode {
+    DW_LNS_extended_op = 0,
+    DW_LNS_copy = 1,
+    DW_LNS_advance_pc = 2,
+    DW_LNS_advance_line = 3,
+    DW_LNS_set_file = 4,
+    DW_LNS_const_add_pc = 8,
+    DW_LNS_fixed_advance_pc = 9
+};
+
+enum EDwarfLineExtOpcode {
+    DW_LNE_end_sequence = 1,
+    DW_LNE_set_address = 2
+};
+
+static uint64_t dwarf_uint(const uint8_t *p, int sz) {
+    uint64_t ret = 0;
+    for (int i = sz - 1; i >= 0; i--) {
+        ret = (ret << 8) | p[i];
+    }
+    return ret;
+}
+
+static uint64_t dwarf_uleb(const uint8_t **pp, const uint8_t *end) {
+    const uint8_t *p = *pp;
+    uint64_t ret = 0;
+    int shift = 0;
+    while (p < end) {
+        uint8_t b = *p++;
+        if (shift < 64) {
+            ret |= static_cast<uint64_t>(b & 0x7F) << shift;
+        }
+        shift += 7;
+        if ((b & 0x80) == 0) {
+            break;
+        }
+    }
+    *pp = p;
+    return ret;
+}
+
+static int64_t dwarf_sleb(const uint8_t **pp, const uint8_t *end) {
+    const uint8_t *p = *pp;
+    uint64_t ret = 0;
+    int shift = 0;
+    uint8_t b = 0;
+    while (p < end) {
+        b = *p++;
+        if (shift < 64) {
+            ret |= static_cast<uint64_t>(b & 0x7F) << shift;
+        }
+        shift += 7;
+        if ((b & 0x80) == 0) {
+            break;
+        }
+    }
+    if (shift < 64 && (b & 0x40)) {
+        ret |= ~0ull << shift;
+    }
+    *pp = p;
+    return static_cast<int64_t>(ret);
+}
+
+/** Skip zero-terminated string. Return false if it exceeds 'end' */
+static bool dwarf_skip_string(const uint8_t **pp, const uint8_t *end) {
+    const uint8_t *p = *pp;
+    while (p < end && *p) {
+        p++;
+    }
+    *pp = p + 1;
+    return p < end;
+}
+
 ElfReaderService::ElfReaderService(const char *name) : IService(name) {
     registerInterface(static_cast<IElfReader *>(this));
     registerAttribute("SourceProc", &sourceProc_);
     image_ = NULL;
+    imageSize_ = 0;
+    header_ = NULL;
+    sh_tbl_ = NULL;
+    shnum_ = 0;
     sectionNames_ = NULL;
+    symbolNames_ = NULL;
+    loadSections_ = NULL;
+    loadSectionCnt_ = 0;
+    lines_ = NULL;
+    lineCnt_ = 0;
+    lineMax_ = 0;
     symbolList_.make_list(0);
-    loadSectionList_.make_list(0);
     sourceProc_.make_string("");
     isrc_ = 0;
 }
 
 ElfReaderService::~ElfReaderService() {
-    if (image_) {
-        delete image_;
-    }
+    unmapFile();
 }
 
 void ElfReaderService::postinitService() {
@@ -46,54 +135,117 @@ void ElfReaderService::postinitService() {
     }
 }
 
+bool ElfReaderService::mapFile(const char *filename) {
+#if defined(_WIN32)
+    HANDLE hfile = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hfile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fsz;
+    HANDLE hmap = NULL;
+    if (GetFileSizeEx(hfile, &fsz) && fsz.QuadPart != 0) {
+        hmap = CreateFileMappingA(hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    if (hmap) {
+        // View keeps the mapping object alive after handles are closed
+        image_ = static_cast<uint8_t *>(
+                    MapViewOfFile(hmap, FILE_MAP_READ, 0, 0, 0));
+        imageSize_ = static_cast<uint64_t>(fsz.QuadPart);
+        CloseHandle(hmap);
+    }
+    CloseHandle(hfile);
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size != 0) {
+        void *p = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ,
+                       MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            image_ = static_cast<uint8_t *>(p);
+            imageSize_ = static_cast<uint64_t>(st.st_size);
+        }
+    }
+    close(fd);
+#endif
+    return image_ != NULL;
+}
+
+void ElfReaderService::unmapFile() {
+    for (int i = 0; i < shnum_; i++) {
+        delete sh_tbl_[i];
+    }
+    delete [] sh_tbl_;
+    delete [] loadSections_;
+    delete [] lines_;
+    delete header_;
+    sh_tbl_ = NULL;
+    shnum_ = 0;
+    loadSections_ = NULL;
+    loadSectionCnt_ = 0;
+    lines_ = NULL;
+    lineCnt_ = 0;
+    lineMax_ = 0;
+    header_ = NULL;
+    sectionNames_ = NULL;
+    symbolNames_ = NULL;
+    symbolList_.make_list(0);
+    if (image_ == NULL) {
+        return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(image_);
+#else
+    munmap(image_, static_cast<size_t>(imageSize_));
+#endif
+    image_ = NULL;
+    imageSize_ = 0;
+}
+
 int ElfReaderService::readFile(const char *filename) {
-    FILE *fp = fopen(filename, "rb");
-    if (!fp) {
+    unmapFile();
+    if (!mapFile(filename)) {
         RISCV_error("File '%s' not found", filename);
         return -1;
     }
-    fseek(fp, 0, SEEK_END);
-    int sz = ftell(fp);
-    rewind(fp);
-
-    if (image_) {
-        delete image_;
-        sectionNames_ = NULL;
-        sourceProc_.make_list(0);
-        symbolList_.make_list(0);
-        loadSectionList_.make_list(0);
-    }
-    image_ = new uint8_t[sz];
-    fread(image_, 1, sz, fp);
 
     if (readElfHeader() != 0) {
-        fclose(fp);
         return 0;
     }
 
-    symbolNames_ = 0;
     if (!header_->get_shoff()) {
-        fclose(fp);
         return 0;
     }
 
-    sh_tbl_ = new SectionHeaderType *[header_->get_shnum()];
+    shnum_ = header_->get_shnum();
+    uint64_t shsize = header_->isElf32() ? sizeof(Elf32_Shdr)
+                                         : sizeof(Elf64_Shdr);
+    if (header_->get_shoff() + shnum_ * shsize > imageSize_) {
+        RISCV_error("Wrong section table offset", NULL);
+        shnum_ = 0;
+        return 0;
+    }
+    sh_tbl_ = new SectionHeaderType *[shnum_];
+    loadSections_ = new LoadSectionType[shnum_];
 
     /** Search .shstrtab section */
     uint8_t *psh = &image_[header_->get_shoff()];
-    for (int i = 0; i < header_->get_shnum(); i++) {
+    for (int i = 0; i < shnum_; i++) {
         sh_tbl_[i] = new SectionHeaderType(psh, header_);
+        psh += shsize;
 
-        sectionNames_ = reinterpret_cast<char *>(&image_[sh_tbl_[i]->get_offset()]);
-        if (sh_tbl_[i]->get_type() == SHT_STRTAB && 
-            strcmp(sectionNames_ + sh_tbl_[i]->get_name(), ".shstrtab") != 0) {
-            sectionNames_ = NULL;
+        if (sh_tbl_[i]->get_type() != SHT_STRTAB
+            || sh_tbl_[i]->get_offset() >= imageSize_) {
+            continue;
         }
-
-        if (header_->isElf32()) {
-            psh += sizeof(Elf32_Shdr);
-        } else {
-            psh += sizeof(Elf64_Shdr);
+        char *names = reinterpret_cast<char *>(
+                        &image_[sh_tbl_[i]->get_offset()]);
+        if (sh_tbl_[i]->get_name() < sh_tbl_[i]->get_size()
+            && strcmp(names + sh_tbl_[i]->get_name(), ".shstrtab") == 0) {
+            sectionNames_ = names;
         }
     }
     if (!sectionNames_) {
@@ -102,7 +254,7 @@ int ElfReaderService::readFile(const char *filename) {
 
     /** Search ".strtab" section with Debug symbols */
     SectionHeaderType *sh;
-    for (int i = 0; i < header_->get_shnum(); i++) {
+    for (int i = 0; i < shnum_; i++) {
         sh = sh_tbl_[i];
         if (sectionNames_ == NULL || sh->get_type() != SHT_STRTAB) {
             continue;
@@ -130,12 +282,14 @@ int ElfReaderService::readFile(const char *filename) {
     if (header_->get_phoff()) {
         //readProgramHeader();
     }
-
-    fclose(fp);
     return 0;
 }
 
 int ElfReaderService::readElfHeader() {
+    if (imageSize_ < sizeof(Elf64_Ehdr)) {
+        RISCV_error("File format is not ELF", NULL);
+        return -1;
+    }
     header_ = new ElfHeaderType(image_);
     if (header_->isElf()) {
         return 0;
@@ -147,9 +301,8 @@ int ElfReaderService::readElfHeader() {
 int ElfReaderService::loadSections() {
     SectionHeaderType *sh;
     uint64_t total_bytes = 0;
-    AttributeType tsymb;
 
-    for (int i = 0; i < header_->get_shnum(); i++) {
+    for (int i = 0; i < shnum_; i++) {
         sh = sh_tbl_[i];
 
         if (sh->get_size() == 0) {
@@ -171,18 +324,11 @@ int ElfReaderService::loadSections() {
              *          whose format and meaning are determined solely by the
              *          program.
              */
-            AttributeType loadsec;
-            loadsec.make_list(LoadSh_Total);
-            if (sectionNames_) {
-                loadsec[LoadSh_name].make_string(&sectionNames_[sh->get_name()]);
-            } else {
-                loadsec[LoadSh_name].make_string("unknown");
+            if (sh->get_offset() + sh->get_size() > imageSize_) {
+                RISCV_error("Section [%d] is out of file", i);
+                continue;
             }
-            loadsec[LoadSh_addr].make_uint64(sh->get_addr());
-            loadsec[LoadSh_size].make_uint64(sh->get_size());
-            loadsec[LoadSh_data].make_data(static_cast<unsigned>(sh->get_size()),
-                                           &image_[sh->get_offset()]);
-            loadSectionList_.add_to_list(&loadsec);
+            addLoadSection(sh, &image_[sh->get_offset()]);
             total_bytes += sh->get_size();
         } else if (sh->get_type() == SHT_NOBITS
                     && (sh->get_flags() & SHF_ALLOC) != 0) {
@@ -193,34 +339,37 @@ int ElfReaderService::loadSections() {
              *          section contains no bytes, the sh_offset member
              *          contains the conceptual file offset.
              */
-            AttributeType loadsec;
-            loadsec.make_list(LoadSh_Total);
-            if (sectionNames_) {
-                loadsec[LoadSh_name].make_string(&sectionNames_[sh->get_name()]);
-            } else {
-                loadsec[LoadSh_name].make_string("unknown");
-            }
-            loadsec[LoadSh_addr].make_uint64(sh->get_addr());
-            loadsec[LoadSh_size].make_uint64(sh->get_size());
-            loadsec[LoadSh_data].make_data(static_cast<unsigned>(sh->get_size()));
-            memset(loadsec[LoadSh_data].data(), 
-                        0, static_cast<size_t>(sh->get_size()));
-            loadSectionList_.add_to_list(&loadsec);
+            addLoadSection(sh, NULL);
             total_bytes += sh->get_size();
         } else if (sh->get_type() == SHT_SYMTAB || sh->get_type() == SHT_DYNSYM) {
             processDebugSymbol(sh);
+        } else if (sectionNames_ && sh->get_type() == SHT_PROGBITS
+                && strcmp(&sectionNames_[sh->get_name()], ".debug_line") == 0) {
+            processDebugLine(sh);
         }
     }
-    symbolList_.sort(LoadSh_name);
+    symbolList_.sort(Symbol_Name);
     if (isrc_) {
         isrc_->addSymbols(&symbolList_);
     }
     return static_cast<int>(total_bytes);
 }
 
+void ElfReaderService::addLoadSection(SectionHeaderType *sh,
+                                      const uint8_t *data) {
+    LoadSectionType &sec = loadSections_[loadSectionCnt_++];
+    if (sectionNames_) {
+        sec.name = &sectionNames_[sh->get_name()];
+    } else {
+        sec.name = "unknown";
+    }
+    sec.addr = sh->get_addr();
+    sec.size = sh->get_size();
+    sec.data = data;
+}
+
 void ElfReaderService::processDebugSymbol(SectionHeaderType *sh) {
     uint64_t symbol_off = 0;
-    SymbolTableType *st;
     AttributeType tsymb;
     uint8_t st_type;
     const char *symb_name;
@@ -230,18 +379,19 @@ void ElfReaderService::processDebugSymbol(SectionHeaderType *sh) {
         return;
     }
 
+    if (sh->get_offset() + sh->get_size() > imageSize_) {
+        return;
+    }
     while (symbol_off < sh->get_size()) {
-        st = new SymbolTableType(&image_[sh->get_offset() + symbol_off],
-                                header_);
-        
-        symb_name = &symbolNames_[st->get_name()];
+        SymbolTableType st(&image_[sh->get_offset() + symbol_off], header_);
 
-        st_type = st->get_info() & 0xF;
-        if ((st_type == STT_OBJECT || st_type == STT_FUNC) && st->get_value()) {
+        st_type = st.get_info() & 0xF;
+        if ((st_type == STT_OBJECT || st_type == STT_FUNC) && st.get_value()) {
+            symb_name = &symbolNames_[st.get_name()];
             tsymb.make_list(Symbol_Total);
             tsymb[Symbol_Name].make_string(symb_name);
-            tsymb[Symbol_Addr].make_uint64(st->get_value());
-            tsymb[Symbol_Size].make_uint64(st->get_size());
+            tsymb[Symbol_Addr].make_uint64(st.get_value());
+            tsymb[Symbol_Size].make_uint64(st.get_size());
             if (st_type == STT_FUNC) {
                 tsymb[Symbol_Type].make_uint64(SYMBOL_TYPE_FUNCTION);
             } else {
@@ -255,8 +405,8 @@ void ElfReaderService::processDebugSymbol(SectionHeaderType *sh) {
         if (sh->get_entsize()) {
             // section with elements of fixed size
             symbol_off += sh->get_entsize(); 
-        } else if (st->get_size()) {
-            symbol_off += st->get_size();
+        } else if (st.get_size()) {
+            symbol_off += st.get_size();
         } else {
             if (header_->isElf32()) {
                 symbol_off += sizeof(Elf32_Sym);
@@ -264,8 +414,210 @@ void ElfReaderService::processDebugSymbol(SectionHeaderType *sh) {
                 symbol_off += sizeof(Elf64_Sym);
             }
         }
-        delete st;
     }
 }
 
+/**
+ * Line number programs of DWARF versions 2..4. Directory and file names
+ * point into the mapped file, files defined by DW_LNE_define_file are
+ * ignored.
+ */
+void ElfReaderService::processDebugLine(SectionHeaderType *sh) {
+    if (sh->get_offset() + sh->get_size() > imageSize_) {
+        return;
+    }
+    const uint8_t *p = &image_[sh->get_offset()];
+    const uint8_t *send = p + sh->get_size();
+    while (send - p >= 4) {
+        uint64_t unit_len = dwarf_uint(p, 4);
+        int offsz = 4;
+        p += 4;
+        if (unit_len == 0xFFFFFFFFull) {
+            if (send - p < 8) {
+                break;
+            }
+            unit_len = dwarf_uint(p, 8);
+            offsz = 8;
+            p += 8;
+        }
+        if (unit_len > static_cast<uint64_t>(send - p)) {
+            RISCV_error("Wrong .debug_line unit length", NULL);
+            break;
+        }
+        const uint8_t *uend = p + unit_len;
+        const uint8_t *unit = p;
+        p = uend;
+        if (uend - unit < 2 + offsz) {
+            continue;
+        }
+        unsigned version = static_cast<unsigned>(dwarf_uint(unit, 2));
+        if (version < 2 || version > 4) {
+            RISCV_info("DWARF line table version %d isn't supported",
+                       version);
+            continue;
+        }
+        uint64_t hdr_len = dwarf_uint(unit + 2, offsz);
+        const uint8_t *h = unit + 2 + offsz;
+        if (hdr_len > static_cast<uint64_t>(uend - h) || hdr_len < 6) {
+            continue;
+        }
+        const uint8_t *prog = h + hdr_len;
+        unsigned min_len = *h++;
+        if (version >= 4) {
+            h++;        // maximum_operations_per_instruction (VLIW only)
+        }
+        h++;            // default_is_stmt
+        int line_base = static_cast<int8_t>(*h++);
+        unsigned line_range = *h++;
+        unsigned opcode_base = *h++;
+        const uint8_t *std_len = h;
+        if (line_range == 0 || opcode_base == 0
+            || opcode_base - 1 > static_cast<unsigned>(prog - h)) {
+            continue;
+        }
+        h += opcode_base - 1;
+
+        // Both lists end with an empty string
+        const uint8_t *dirs = h;
+        while (h < prog && *h) {
+            dwarf_skip_string(&h, prog);
+        }
+        h++;
+        const uint8_t *files = h;
+        while (h < prog && *h) {
+            dwarf_skip_string(&h, prog);
+            dwarf_uleb(&h, prog);       // directory index
+            dwarf_uleb(&h, prog);       // modification time
+            dwarf_uleb(&h, prog);       // file length
+        }
+        if (h >= prog) {
+            continue;
+        }
+        runLineProgram(prog, uend, dirs, files, min_len, line_base,
+                       line_range, opcode_base, std_len);
+    }
+    RISCV_info("Source lines: %d", lineCnt_);
+}
+
+void ElfReaderService::runLineProgram(const uint8_t *p, const uint8_t *end,
+                                      const uint8_t *dirs,
+                                      const uint8_t *files,
+                                      unsigned min_len, int line_base,
+                                      unsigned line_range,
+                                      unsigned opcode_base,
+                                      const uint8_t *std_len) {
+    uint64_t addr = 0;
+    int64_t line = 1;
+    uint64_t fileidx = 1;
+    const char *dir = "";
+    const char *file = 0;
+    bool file_valid = false;
+
+    while (p < end) {
+        if (!file_valid) {
+            // Lists were checked on header parsing and end before program
+            const uint8_t *f = files;
+            uint64_t n = 1;
+            file = "??";
+            dir = "";
+            while (*f) {
+                const char *name = reinterpret_cast<const char *>(f);
+                dwarf_skip_string(&f, end);
+                uint64_t diridx = dwarf_uleb(&f, end);
+                dwarf_uleb(&f, end);
+                dwarf_uleb(&f, end);
+                if (n++ != fileidx) {
+                    continue;
+                }
+                file = name;
+                const uint8_t *d = dirs;
+                for (uint64_t i = 1; *d && i < diridx; i++) {
+                    dwarf_skip_string(&d, end);
+                }
+                if (diridx && *d && name[0] != '/') {
+                    dir = reinterpret_cast<const char *>(d);
+                }
+                break;
+            }
+            file_valid = true;
+        }
+
+        unsigned op = *p++;
+        if (op >= opcode_base) {
+            op -= opcode_base;
+            addr += (op / line_range) * min_len;
+            line += line_base + static_cast<int>(op % line_range);
+            addSourceLine(addr, dir, file, static_cast<uint32_t>(line));
+            continue;
+        }
+        switch (op) {
+        case DW_LNS_extended_op: {
+            uint64_t len = dwarf_uleb(&p, end);
+            if (len == 0 || len > static_cast<uint64_t>(end - p)) {
+                return;
+            }
+            const uint8_t *next = p + len;
+            uint8_t eop = *p++;
+            if (eop == DW_LNE_end_sequence) {
+                addSourceLine(addr, dir, file, 0);
+                addr = 0;
+                line = 1;
+                fileidx = 1;
+                file_valid = false;
+            } else if (eop == DW_LNE_set_address) {
+                addr = dwarf_uint(p, len > 9 ? 8 : static_cast<int>(len - 1));
+            }
+            p = next;
+            break;
+        }
+        case DW_LNS_copy:
+            addSourceLine(addr, dir, file, static_cast<uint32_t>(line));
+            break;
+        case DW_LNS_advance_pc:
+            addr += dwarf_uleb(&p, end) * min_len;
+            break;
+        case DW_LNS_advance_line:
+            line += dwarf_sleb(&p, end);
+            break;
+        case DW_LNS_set_file:
+            fileidx = dwarf_uleb(&p, end);
+            file_valid = false;
+            break;
+        case DW_LNS_const_add_pc:
+            addr += ((255 - opcode_base) / line_range) * min_len;
+            break;
+        case DW_LNS_fixed_advance_pc:
+            if (end - p < 2) {
+                return;
+            }
+            addr += dwarf_uint(p, 2);
+            p += 2;
+            break;
+        default:
+            // Other standard opcodes don't change address and line
+            for (unsigned i = 0; i < std_len[op - 1]; i++) {
+                dwarf_uleb(&p, end);
+            }
+        }
+    }
+}
+
+void ElfReaderService::addSourceLine(uint64_t addr, const char *dir,
+                                     const char *file, uint32_t line) {
+    if (lineCnt_ == lineMax_) {
+        lineMax_ = lineMax_ ? 2 * lineMax_ : 1024;
+        SourceLineType *t = new SourceLineType[lineMax_];
+        if (lineCnt_) {
+            memcpy(t, lines_, lineCnt_ * sizeof(SourceLineType));
+        }
+        delete [] lines_;
+        lines_ = t;
+    }
+    SourceLineType &row = lines_[lineCnt_++];
+    row.addr = addr;
+    row.dir = dir;
+    row.file = file;
+    row.line = line;
+}
+
 }  // namespace debugger
@@ -26,6 +26,13 @@
 
 namespace debugger {
 
+/**
+ * @brief ELF file reader.
+ *
+ * File is mapped into memory and sections are provided as the views into
+ * the mapping without copying. NOBITS sections have no data and should be
+ * filled by zeros. Views are valid until the next readFile() call.
+ */
 class ElfReaderService : public IService,
                          public IElfReader {
 public:
@@ -39,37 +46,53 @@ public:
     virtual int readFile(const char *filename);
 
     virtual unsigned loadableSectionTotal() {
-        return loadSectionList_.size();
+        return loadSectionCnt_;
     }
 
     virtual const char *sectionName(unsigned idx) {
-        return loadSectionList_[idx][LoadSh_name].to_string();
+        return loadSections_[idx].name;
     }
 
     virtual uint64_t sectionAddress(unsigned idx)  {
-        return loadSectionList_[idx][LoadSh_addr].to_uint64();
+        return loadSections_[idx].addr;
     }
 
     virtual uint64_t sectionSize(unsigned idx)  {
-        return loadSectionList_[idx][LoadSh_size].to_uint64();
+        return loadSections_[idx].size;
     }
 
-    virtual uint8_t *sectionData(unsigned idx)  {
-        return loadSectionList_[idx][LoadSh_data].data();
+    virtual const uint8_t *sectionData(unsigned idx)  {
+        return loadSections_[idx].data;
+    }
+
+    virtual unsigned sourceLineTotal() { return lineCnt_; }
+
+    virtual const SourceLineType *sourceLine(unsigned idx) {
+        return &lines_[idx];
     }
 
 private:
+    bool mapFile(const char *filename);
+    void unmapFile();
     int readElfHeader();
     int loadSections();
+    void addLoadSection(SectionHeaderType *sh, const uint8_t *data);
     void processDebugSymbol(SectionHeaderType *sh);
+    void processDebugLine(SectionHeaderType *sh);
+    void runLineProgram(const uint8_t *p, const uint8_t *end,
+                        const uint8_t *dirs, const uint8_t *files,
+                        unsigned min_len, int line_base,
+                        unsigned line_range, unsigned opcode_base,
+                        const uint8_t *std_len);
+    void addSourceLine(uint64_t addr, const char *dir, const char *file,
+                       uint32_t line);
 
 private:
-    enum ELoadSectionItem {
-        LoadSh_name,
-        LoadSh_addr,
-        LoadSh_size,
-        LoadSh_data,
-        LoadSh_Total,
+    struct LoadSectionType {
+        const char *name;
+        uint64_t addr;
+        uint64_t size;
+        const uint8_t *data;        // NULL for zero-filled section
     };
 
     enum EMode {
@@ -79,14 +102,20 @@ private:
 
     AttributeType sourceProc_;
     AttributeType symbolList_;
-    AttributeType loadSectionList_;
 
     ISourceCode *isrc_;
-    uint8_t *image_;
+    uint8_t *image_;                // read-only file mapping
+    uint64_t imageSize_;
     ElfHeaderType *header_;
     SectionHeaderType **sh_tbl_;
+    int shnum_;
     char *sectionNames_;
     char *symbolNames_;
+    LoadSectionType *loadSections_;
+    unsigned loadSectionCnt_;
+    SourceLineType *lines_;
+    unsigned lineCnt_;
+    unsigned lineMax_;
 };
 
 DECLARE_CLASS(ElfReaderService)
@@ -0,0 +1,327 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "iservice.h"
+#include "cmd_coverage.h"
+#include "debug/dsumap.h"
+#include "coreservices/isrccode.h"
+
+namespace debugger {
+
+CmdCoverage::CmdCoverage(ITap *tap) : ICommand ("coverage", tap) {
+
+    briefDescr_.make_string("Code coverage of the functional CPU model");
+    detailedDescr_.make_string(
+        "Description:\n"
+        "    Read statistic of executed instructions collected inside of\n"
+        "    the region cached by CPU model, clear it or export it. Edge\n"
+        "    coverage counts different (previous pc, pc) pairs and it\n"
+        "    slows down the simulation. Export into lcov tracefile uses\n"
+        "    line table of the ELF file loaded by the 'loadelf' command.\n"
+        "    Reset requires halted target.\n"
+        "Output format:\n"
+        "    {'Base':i,'Size':i,'Covered':i,'Edges':i}\n"
+        "Usage:\n"
+        "    coverage\n"
+        "    coverage reset\n"
+        "    coverage edges on|off\n"
+        "    coverage dump <file>\n"
+        "    coverage lcov <file>\n"
+        "Example:\n"
+        "    coverage\n"
+        "    coverage lcov fw.info\n");
+}
+
+int CmdCoverage::isValid(AttributeType *args) {
+    if (!cmdName_.is_equal((*args)[0u].to_string())) {
+        return CMD_INVALID;
+    }
+    if (args->size() == 1) {
+        return CMD_VALID;
+    }
+    if (!(*args)[1].is_string()) {
+        return CMD_WRONG_ARGS;
+    }
+    if (args->size() == 2 && (*args)[1].is_equal("reset")) {
+        return CMD_VALID;
+    }
+    if (args->size() == 3 && (*args)[2].is_string()
+        && ((*args)[1].is_equal("edges") || (*args)[1].is_equal("dump")
+            || (*args)[1].is_equal("lcov"))) {
+        return CMD_VALID;
+    }
+    return CMD_WRONG_ARGS;
+}
+
+void CmdCoverage::exec(AttributeType *args, AttributeType *res) {
+    res->attr_free();
+    res->make_nil();
+    if (isValid(args) != CMD_VALID) {
+        generateError(res, "Wrong argument list");
+        return;
+    }
+
+    AttributeType lstServ;
+    RISCV_get_services_with_iface(IFACE_COVERAGE_TRACKER, &lstServ);
+    if (lstServ.size() == 0) {
+        generateError(res, "Coverage tracker not found");
+        return;
+    }
+    IService *iserv = getHartService(&lstServ);
+    ICoverageTracker *icov = static_cast<ICoverageTracker *>(
+                        iserv->getInterface(IFACE_COVERAGE_TRACKER));
+
+    const char *err = 0;
+    if (args->size() == 1) {
+        uint64_t base, size;
+        icov->getCoverageRegion(&base, &size);
+        res->make_dict();
+        (*res)["Base"].make_uint64(base);
+        (*res)["Size"].make_uint64(size);
+        (*res)["Covered"].make_uint64(icov->coveredTotal());
+        (*res)["Edges"].make_uint64(icov->edgeTotal());
+    } else if ((*args)[1].is_equal("reset")) {
+        if (!isHalted()) {
+            err = "Target isn't halted";
+        } else {
+            icov->resetCoverage();
+        }
+    } else if ((*args)[1].is_equal("edges")) {
+        if ((*args)[2].is_equal("on")) {
+            icov->enableEdgeCoverage(true);
+        } else if ((*args)[2].is_equal("off")) {
+            icov->enableEdgeCoverage(false);
+        } else {
+            err = "Wrong argument list";
+        }
+    } else if ((*args)[1].is_equal("dump")) {
+        err = dumpAddresses(icov, (*args)[2].to_string());
+    } else {
+        err = writeLcov(icov, (*args)[2].to_string());
+    }
+    if (err) {
+        generateError(res, err);
+    }
+}
+
+bool CmdCoverage::isRangeCovered(ICoverageTracker *icov, uint64_t addr,
+                                 uint64_t end) {
+    uint64_t base, size;
+    icov->getCoverageRegion(&base, &size);
+    if (addr < base) {
+        addr = base;
+    }
+    if (end > base + size) {
+        end = base + size;
+    }
+    for (uint64_t a = addr & ~1ull; a < end; a += 2) {
+        if (icov->isCovered(a)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Addresses of the executed instructions, one per line */
+const char *CmdCoverage::dumpAddresses(ICoverageTracker *icov,
+                                    const char *filename) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        return "Can't open file";
+    }
+    uint64_t base, size;
+    icov->getCoverageRegion(&base, &size);
+    for (uint64_t a = base; a < base + size; a += 2) {
+        if (icov->isCovered(a)) {
+            fprintf(fp, "%08" RV_PRI64 "x\n", a);
+        }
+    }
+    fclose(fp);
+    return 0;
+}
+
+int CmdCoverage::compareRanges(const void *a, const void *b) {
+    const LineRangeType *p1 = static_cast<const LineRangeType *>(a);
+    const LineRangeType *p2 = static_cast<const LineRangeType *>(b);
+    if (p1->addr != p2->addr) {
+        return p1->addr < p2->addr ? -1 : 1;
+    }
+    return 0;
+}
+
+int CmdCoverage::compareItems(const void *a, const void *b) {
+    const LcovItemType *p1 = static_cast<const LcovItemType *>(a);
+    const LcovItemType *p2 = static_cast<const LcovItemType *>(b);
+    int ret = strcmp(p1->dir, p2->dir);
+    if (ret == 0) {
+        ret = strcmp(p1->file, p2->file);
+    }
+    if (ret == 0 && p1->line != p2->line) {
+        ret = p1->line < p2->line ? -1 : 1;
+    }
+    if (ret == 0 && (p1->name == 0) != (p2->name == 0)) {
+        ret = p1->name ? -1 : 1;
+    }
+    return ret;
+}
+
+/**
+ * Line is hit when any instruction of its address ranges was executed,
+ * function is hit when any instruction inside of symbol size was executed.
+ */
+const char *CmdCoverage::writeLcov(ICoverageTracker *icov,
+                                   const char *filename) {
+    AttributeType lstServ;
+    RISCV_get_services_with_iface(IFACE_ELFREADER, &lstServ);
+    if (lstServ.size() == 0) {
+        return "ElfReader service not found";
+    }
+    IService *iserv = static_cast<IService *>(lstServ[0u].to_iface());
+    IElfReader *ielf = static_cast<IElfReader *>(
+                        iserv->getInterface(IFACE_ELFREADER));
+    unsigned rows = ielf->sourceLineTotal();
+    if (rows == 0) {
+        return "No line table. Load ELF file with debug information";
+    }
+
+    AttributeType symbols;
+    symbols.make_list(0);
+    RISCV_get_services_with_iface(IFACE_SOURCE_CODE, &lstServ);
+    if (lstServ.size()) {
+        iserv = static_cast<IService *>(lstServ[0u].to_iface());
+        static_cast<ISourceCode *>(iserv->getInterface(IFACE_SOURCE_CODE))
+                ->getSymbols(&symbols);
+    }
+
+    LineRangeType *ranges = new LineRangeType[rows];
+    unsigned rcnt = 0;
+    for (unsigned i = 0; i + 1 < rows; i++) {
+        const SourceLineType *row = ielf->sourceLine(i);
+        const SourceLineType *next = ielf->sourceLine(i + 1);
+        if (row->line == 0 || next->addr <= row->addr) {
+            continue;
+        }
+        ranges[rcnt].addr = row->addr;
+        ranges[rcnt].end = next->addr;
+        ranges[rcnt].row = row;
+        rcnt++;
+    }
+    qsort(ranges, rcnt, sizeof(LineRangeType), compareRanges);
+
+    LcovItemType *items = new LcovItemType[rcnt + symbols.size()];
+    unsigned cnt = 0;
+    for (unsigned i = 0; i < rcnt; i++) {
+        LcovItemType &item = items[cnt++];
+        item.dir = ranges[i].row->dir;
+        item.file = ranges[i].row->file;
+        item.line = ranges[i].row->line;
+        item.name = 0;
+        item.hit = isRangeCovered(icov, ranges[i].addr, ranges[i].end);
+    }
+    for (unsigned n = 0; n < symbols.size(); n++) {
+        AttributeType &symb = symbols[n];
+        if ((symb[Symbol_Type].to_uint64() & SYMBOL_TYPE_FUNCTION) == 0) {
+            continue;
+        }
+        uint64_t addr = symb[Symbol_Addr].to_uint64();
+        uint64_t sz = symb[Symbol_Size].to_uint64();
+        // Last range starting before or at the function address
+        unsigned lo = 0, hi = rcnt;
+        while (lo < hi) {
+            unsigned mid = (lo + hi) / 2;
+            if (ranges[mid].addr <= addr) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo == 0 || addr >= ranges[lo - 1].end) {
+            continue;
+        }
+        const SourceLineType *row = ranges[lo - 1].row;
+        LcovItemType &item = items[cnt++];
+        item.dir = row->dir;
+        item.file = row->file;
+        item.line = row->line;
+        item.name = symb[Symbol_Name].to_string();
+        item.hit = isRangeCovered(icov, addr, addr + (sz ? sz : 2));
+    }
+    delete [] ranges;
+    qsort(items, cnt, sizeof(LcovItemType), compareItems);
+
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        delete [] items;
+        return "Can't open file";
+    }
+    unsigned start = 0;
+    while (start < cnt) {
+        // Items of the same source file
+        unsigned end = start + 1;
+        while (end < cnt && strcmp(items[end].dir, items[start].dir) == 0
+            && strcmp(items[end].file, items[start].file) == 0) {
+            end++;
+        }
+        fprintf(fp, "TN:\nSF:%s%s%s\n", items[start].dir,
+                items[start].dir[0] ? "/" : "", items[start].file);
+
+        unsigned fnf = 0, fnh = 0;
+        for (unsigned i = start; i < end; i++) {
+            if (items[i].name) {
+                fprintf(fp, "FN:%d,%s\n", items[i].line, items[i].name);
+            }
+        }
+        for (unsigned i = start; i < end; i++) {
+            if (items[i].name) {
+                fprintf(fp, "FNDA:%d,%s\n", items[i].hit ? 1 : 0,
+                        items[i].name);
+                fnf++;
+                fnh += items[i].hit ? 1 : 0;
+            }
+        }
+        fprintf(fp, "FNF:%d\nFNH:%d\n", fnf, fnh);
+
+        unsigned lf = 0, lh = 0;
+        for (unsigned i = start; i < end; ) {
+            // Line can be described by several address ranges
+            uint32_t line = items[i].line;
+            bool hit = false;
+            bool isline = false;
+            for (; i < end && items[i].line == line; i++) {
+                if (items[i].name == 0) {
+                    isline = true;
+                    hit = hit || items[i].hit;
+                }
+            }
+            if (isline) {
+                fprintf(fp, "DA:%d,%d\n", line, hit ? 1 : 0);
+                lf++;
+                lh += hit ? 1 : 0;
+            }
+        }
+        fprintf(fp, "LF:%d\nLH:%d\nend_of_record\n", lf, lh);
+        start = end;
+    }
+    fclose(fp);
+    delete [] items;
+    return 0;
+}
+
+}  // namespace debugger
@@ -0,0 +1,63 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef __DEBUGGER_CMD_COVERAGE_H__
+#define __DEBUGGER_CMD_COVERAGE_H__
+
+#include "api_core.h"
+#include "coreservices/itap.h"
+#include "coreservices/icommand.h"
+#include "coreservices/icoverage.h"
+#include "coreservices/ielfreader.h"
+
+namespace debugger {
+
+class CmdCoverage : public ICommand  {
+ public:
+    explicit CmdCoverage(ITap *tap);
+
+    /** ICommand */
+    virtual int isValid(AttributeType *args);
+    virtual void exec(AttributeType *args, AttributeType *res);
+
+ private:
+    bool isRangeCovered(ICoverageTracker *icov, uint64_t addr, uint64_t end);
+    const char *dumpAddresses(ICoverageTracker *icov, const char *filename);
+    const char *writeLcov(ICoverageTracker *icov, const char *filename);
+
+ private:
+    /** Line or function record of the lcov file */
+    struct LcovItemType {
+        const char *dir;
+        const char *file;
+        uint32_t line;
+        const char *name;       // NULL for line record
+        bool hit;
+    };
+    /** Address range of the line table row */
+    struct LineRangeType {
+        uint64_t addr;
+        uint64_t end;
+        const SourceLineType *row;
+    };
+    static int compareRanges(const void *a, const void *b);
+    static int compareItems(const void *a, const void *b);
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_CMD_COVERAGE_H__
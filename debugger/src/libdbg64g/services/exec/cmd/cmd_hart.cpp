@@ -0,0 +1,80 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "cmd_hart.h"
+#include "debug/dsumap.h"
+
+namespace debugger {
+
+CmdHart::CmdHart(ITap *tap) : ICommand ("hart", tap) {
+
+    briefDescr_.make_string("Select hart accessed by debugger");
+    detailedDescr_.make_string(
+        "Description:\n"
+        "    Registers, CSRs, stack trace, status, imix, coverage and\n"
+        "    profile commands access the selected hart. Run control\n"
+        "    commands and HW breakpoints are applied to all harts.\n"
+        "    Without arguments return list [selected, total].\n"
+        "Example:\n"
+        "    hart\n"
+        "    hart 1\n");
+}
+
+int CmdHart::isValid(AttributeType *args) {
+    if (!cmdName_.is_equal((*args)[0u].to_string())) {
+        return CMD_INVALID;
+    }
+    if (args->size() == 1
+        || (args->size() == 2 && (*args)[1].is_integer())) {
+        return CMD_VALID;
+    }
+    return CMD_WRONG_ARGS;
+}
+
+void CmdHart::exec(AttributeType *args, AttributeType *res) {
+    res->attr_free();
+    res->make_nil();
+    if (isValid(args) != CMD_VALID) {
+        generateError(res, "Wrong argument list");
+        return;
+    }
+
+    Reg64Type t1;
+    DsuMapType *dsu = DSUBASE();
+    uint64_t addr_ctx =
+        reinterpret_cast<uint64_t>(&dsu->ulocal.v.cpu_context);
+    uint64_t addr_total =
+        reinterpret_cast<uint64_t>(&dsu->ulocal.v.cpu_total);
+
+    tap_->read(addr_total, 8, t1.buf);
+    uint64_t total = t1.val ? t1.val : 1;
+    if (args->size() == 2) {
+        t1.val = (*args)[1].to_uint64();
+        if (t1.val >= total) {
+            generateError(res, "Hart index out of range");
+            return;
+        }
+        tap_->write(addr_ctx, 8, t1.buf);
+    }
+
+    tap_->read(addr_ctx, 8, t1.buf);
+    res->make_list(2);
+    (*res)[0u].make_uint64(t1.val);
+    (*res)[1].make_uint64(total);
+}
+
+}  // namespace debugger
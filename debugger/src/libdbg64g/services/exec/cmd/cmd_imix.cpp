@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "iservice.h"
+#include "cmd_imix.h"
+#include "coreservices/iinstrmix.h"
+
+namespace debugger {
+
+static const char *const INSTR_MIX_NAMES[InstrMix_Total] = {
+    "Alu",
+    "Load",
+    "Store",
+    "BranchNotTaken",
+    "BranchTaken",
+    "Jump",
+    "MulDiv",
+    "Fpu",
+    "Atomic",
+    "Csr",
+    "System",
+    "Illegal"
+};
+
+CmdInstrMix::CmdInstrMix(ITap *tap) : ICommand ("imix", tap) {
+
+    briefDescr_.make_string("Instruction mix and traps statistic");
+    detailedDescr_.make_string(
+        "Description:\n"
+        "    Read counters of the executed instructions by class and of\n"
+        "    the taken traps by code (mcause code for RISC-V, exception\n"
+        "    vector index for ARM). Counting is enabled by the CPU attribute\n"
+        "    'InstrMix' or by this command.\n"
+        "Output format:\n"
+        "    {'Enabled':b,'Total':i,'Alu':i,'Load':i,'Store':i,\n"
+        "     'BranchNotTaken':i,'BranchTaken':i,'Jump':i,'MulDiv':i,\n"
+        "     'Fpu':i,'Atomic':i,'Csr':i,'System':i,'Illegal':i,\n"
+        "     'Instr16':i,'Instr32':i,\n"
+        "     'Exceptions':[[code,count],...],'Interrupts':[[code,count],...]}\n"
+        "Usage:\n"
+        "    imix\n"
+        "    imix on|off\n"
+        "    imix reset\n"
+        "Example:\n"
+        "    imix on\n"
+        "    imix\n");
+}
+
+int CmdInstrMix::isValid(AttributeType *args) {
+    if (!cmdName_.is_equal((*args)[0u].to_string())) {
+        return CMD_INVALID;
+    }
+    if (args->size() == 1) {
+        return CMD_VALID;
+    }
+    if (args->size() == 2 && (*args)[1].is_string()
+        && ((*args)[1].is_equal("on") || (*args)[1].is_equal("off")
+            || (*args)[1].is_equal("reset"))) {
+        return CMD_VALID;
+    }
+    return CMD_WRONG_ARGS;
+}
+
+void CmdInstrMix::exec(AttributeType *args, AttributeType *res) {
+    res->attr_free();
+    res->make_nil();
+    if (isValid(args) != CMD_VALID) {
+        generateError(res, "Wrong argument list");
+        return;
+    }
+
+    AttributeType lstServ;
+    RISCV_get_services_with_iface(IFACE_INSTR_MIX, &lstServ);
+    if (lstServ.size() == 0) {
+        generateError(res, "Instruction mix counters not found");
+        return;
+    }
+    IService *iserv = getHartService(&lstServ);
+    IInstrMix *imix = static_cast<IInstrMix *>(
+                        iserv->getInterface(IFACE_INSTR_MIX));
+
+    if (args->size() == 2) {
+        if ((*args)[1].is_equal("on")) {
+            imix->enableInstrMix(true);
+        } else if ((*args)[1].is_equal("off")) {
+            imix->enableInstrMix(false);
+        } else {
+            imix->resetInstrMix();
+        }
+        return;
+    }
+
+    InstrMixType mix;
+    imix->getInstrMix(&mix);
+    uint64_t total = 0;
+    res->make_dict();
+    (*res)["Enabled"].make_boolean(imix->isInstrMixEnabled());
+    for (int i = 0; i < InstrMix_Total; i++) {
+        (*res)[INSTR_MIX_NAMES[i]].make_uint64(mix.instr[i]);
+        total += mix.instr[i];
+    }
+    (*res)["Total"].make_uint64(total);
+    (*res)["Instr16"].make_uint64(mix.oplen[0]);
+    (*res)["Instr32"].make_uint64(mix.oplen[1]);
+
+    const char *TRAP_NAMES[2] = {"Exceptions", "Interrupts"};
+    for (int n = 0; n < 2; n++) {
+        AttributeType &traps = (*res)[TRAP_NAMES[n]];
+        traps.make_list(0);
+        for (unsigned i = 0; i < TRAP_CODE_TOTAL; i++) {
+            if (mix.trap[n][i] == 0) {
+                continue;
+            }
+            AttributeType item;
+            item.make_list(2);
+            item[0u].make_uint64(i);
+            item[1].make_uint64(mix.trap[n][i]);
+            traps.add_to_list(&item);
+        }
+    }
+}
+
+}  // namespace debugger
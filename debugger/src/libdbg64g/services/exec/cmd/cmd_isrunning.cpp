@@ -40,19 +40,7 @@ int CmdIsRunning::isValid(AttributeType *args) {
 }
 
 void CmdIsRunning::exec(AttributeType *args, AttributeType *res) {
-    res->make_boolean(false);
-
-    Reg64Type t1;
-    GenericCpuControlType ctrl;
-    DsuMapType *pdsu = DSUBASE();
-    uint64_t addr = reinterpret_cast<uint64_t>(&pdsu->udbg.v.control);
-    tap_->read(addr, 8, t1.buf);
-    ctrl.val = t1.val;
-    if (ctrl.bits.halt) {
-        res->make_boolean(false);
-    } else {
-        res->make_boolean(true);
-    }
+    res->make_boolean(!isHalted());
 }
 
 }  // namespace debugger
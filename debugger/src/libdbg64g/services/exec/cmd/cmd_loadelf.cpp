@@ -14,6 +14,7 @@
  *  limitations under the License.
  */
 
+#include <string.h>
 #include "iservice.h"
 #include "cmd_loadelf.h"
 #include "coreservices/ielfreader.h"
@@ -82,10 +83,23 @@ void CmdLoadElf::exec(AttributeType *args, AttributeType *res) {
 
     uint64_t sec_addr;
     int sec_sz;
+    uint8_t zeros[1024];
+    memset(zeros, 0, sizeof(zeros));
     for (unsigned i = 0; i < elf->loadableSectionTotal(); i++) {
         sec_addr = elf->sectionAddress(i);
         sec_sz = static_cast<int>(elf->sectionSize(i));
-        tap_->write(sec_addr, sec_sz, elf->sectionData(i));
+        const uint8_t *data = elf->sectionData(i);
+        if (data) {
+            tap_->write(sec_addr, sec_sz, const_cast<uint8_t *>(data));
+            continue;
+        }
+        while (sec_sz > 0) {
+            int wsz = sec_sz < static_cast<int>(sizeof(zeros))
+                    ? sec_sz : static_cast<int>(sizeof(zeros));
+            tap_->write(sec_addr, wsz, zeros);
+            sec_addr += wsz;
+            sec_sz -= wsz;
+        }
     }
 
     //soft_reset = 0;
@@ -0,0 +1,118 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "iservice.h"
+#include "cmd_profile.h"
+#include "coreservices/iprofiler.h"
+
+namespace debugger {
+
+CmdProfile::CmdProfile(ITap *tap) : ICommand ("profile", tap) {
+
+    briefDescr_.make_string("Statistical profiler of the executed code");
+    detailedDescr_.make_string(
+        "Description:\n"
+        "    Control sampling of the CPU program counter and call stack\n"
+        "    and read functions with the largest number of samples. Folded\n"
+        "    stacks file is the input of flame graph tools.\n"
+        "Output format:\n"
+        "    {'Enabled':b,'Period':i,'Samples':i,\n"
+        "     'Top':[[name,self samples,inclusive samples],...]}\n"
+        "Usage:\n"
+        "    profile\n"
+        "    profile top <n>\n"
+        "    profile on [period in steps]\n"
+        "    profile off\n"
+        "    profile reset\n"
+        "    profile folded <file>\n"
+        "Example:\n"
+        "    profile on 1000\n"
+        "    profile top 20\n"
+        "    profile folded fw.folded\n");
+}
+
+int CmdProfile::isValid(AttributeType *args) {
+    if (!cmdName_.is_equal((*args)[0u].to_string())) {
+        return CMD_INVALID;
+    }
+    if (args->size() == 1) {
+        return CMD_VALID;
+    }
+    if (!(*args)[1].is_string()) {
+        return CMD_WRONG_ARGS;
+    }
+    if (args->size() == 2 && ((*args)[1].is_equal("on")
+        || (*args)[1].is_equal("off") || (*args)[1].is_equal("reset"))) {
+        return CMD_VALID;
+    }
+    if (args->size() == 3 && (*args)[1].is_equal("on")
+        && (*args)[2].is_integer()) {
+        return CMD_VALID;
+    }
+    if (args->size() == 3 && (*args)[1].is_equal("top")
+        && (*args)[2].is_integer()) {
+        return CMD_VALID;
+    }
+    if (args->size() == 3 && (*args)[1].is_equal("folded")
+        && (*args)[2].is_string()) {
+        return CMD_VALID;
+    }
+    return CMD_WRONG_ARGS;
+}
+
+void CmdProfile::exec(AttributeType *args, AttributeType *res) {
+    res->attr_free();
+    res->make_nil();
+    if (isValid(args) != CMD_VALID) {
+        generateError(res, "Wrong argument list");
+        return;
+    }
+
+    AttributeType lstServ;
+    RISCV_get_services_with_iface(IFACE_PROFILER, &lstServ);
+    if (lstServ.size() == 0) {
+        generateError(res, "Profiler service not found");
+        return;
+    }
+    IService *iserv = getHartService(&lstServ, "Cpu");
+    IProfiler *iprof = static_cast<IProfiler *>(
+                        iserv->getInterface(IFACE_PROFILER));
+
+    if (args->size() == 1) {
+        res->make_dict();
+        (*res)["Enabled"].make_boolean(iprof->isProfilerEnabled());
+        (*res)["Period"].make_uint64(iprof->getSamplePeriod());
+        (*res)["Samples"].make_uint64(iprof->sampleTotal());
+        iprof->getTopFunctions(10, &(*res)["Top"]);
+    } else if ((*args)[1].is_equal("top")) {
+        iprof->getTopFunctions((*args)[2].to_uint32(), res);
+    } else if ((*args)[1].is_equal("on")) {
+        uint64_t period = 0;
+        if (args->size() == 3) {
+            period = (*args)[2].to_uint64();
+        }
+        iprof->enableProfiler(true, period);
+    } else if ((*args)[1].is_equal("off")) {
+        iprof->enableProfiler(false, 0);
+    } else if ((*args)[1].is_equal("reset")) {
+        iprof->resetProfile();
+    } else if (!iprof->writeFoldedStacks((*args)[2].to_string())) {
+        generateError(res, "Can't open file");
+    }
+}
+
+}  // namespace debugger
@@ -0,0 +1,178 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <string.h>
+#include "iservice.h"
+#include "cmd_restore.h"
+#include "debug/dsumap.h"
+#include "coreservices/isnapshot.h"
+
+namespace debugger {
+
+CmdRestore::CmdRestore(ITap *tap) : ICommand ("restore", tap) {
+
+    briefDescr_.make_string("Restore simulation state from file");
+    detailedDescr_.make_string(
+        "Description:\n"
+        "    Restore state of the CPU, memories and peripheries from the\n"
+        "    checkpoint file created by 'save' command with the same\n"
+        "    configuration. Without file name return to the state of the\n"
+        "    last 'save' command without arguments. Simulation must be\n"
+        "    halted.\n"
+        "Example:\n"
+        "    restore boot.snap\n"
+        "    restore\n");
+}
+
+int CmdRestore::isValid(AttributeType *args) {
+    if (!cmdName_.is_equal((*args)[0u].to_string())) {
+        return CMD_INVALID;
+    }
+    if (args->size() == 1 || args->size() == 2) {
+        return CMD_VALID;
+    }
+    return CMD_WRONG_ARGS;
+}
+
+void CmdRestore::exec(AttributeType *args, AttributeType *res) {
+    res->attr_free();
+    res->make_nil();
+    if (isValid(args) != CMD_VALID) {
+        generateError(res, "Wrong argument list");
+        return;
+    }
+    if (!isHalted()) {
+        generateError(res, "Target isn't halted");
+        return;
+    }
+
+    if (args->size() == 1) {
+        rewindAll(res);
+        return;
+    }
+
+    FILE *fp = fopen((*args)[1].to_string(), "rb");
+    if (!fp) {
+        generateError(res, "File not found");
+        return;
+    }
+    fseek(fp, 0, SEEK_END);
+    long fsz = ftell(fp);
+    if (fsz < 0) {
+        fclose(fp);
+        generateError(res, "Can't read file");
+        return;
+    }
+    rewind(fp);
+    uint8_t *image = new uint8_t[fsz];
+    size_t rdsz = fread(image, 1, fsz, fp);
+    fclose(fp);
+
+    char errmsg[256];
+    errmsg[0] = '\0';
+    if (!restoreImage(image, static_cast<unsigned>(rdsz),
+                      errmsg, sizeof(errmsg))) {
+        generateError(res, errmsg);
+    }
+    delete [] image;
+}
+
+/**
+ * All sections are checked before the first one is applied so that a
+ * wrong file doesn't change the simulation state.
+ */
+bool CmdRestore::restoreImage(const uint8_t *image, unsigned sz,
+                              char *errmsg, int errsz) {
+    SnapshotReader rd(image, sz);
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    uint32_t hdr[2];
+    if (!rd.read(magic, sizeof(magic)) || !rd.read(hdr, sizeof(hdr))
+        || memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0
+        || hdr[0] != SNAPSHOT_VERSION) {
+        RISCV_sprintf(errmsg, errsz, "%s", "Wrong file format");
+        return false;
+    }
+
+    unsigned data_offset = sz - rd.left();
+    for (uint32_t i = 0; i < hdr[1]; i++) {
+        const char *name = rd.readString();
+        uint32_t secsz;
+        if (!name || !rd.read(&secsz, sizeof(secsz))
+            || !rd.readData(secsz)) {
+            RISCV_sprintf(errmsg, errsz, "%s", "Wrong file format");
+            return false;
+        }
+        if (!RISCV_get_service_iface(name, IFACE_SNAPSHOT)) {
+            RISCV_sprintf(errmsg, errsz, "Service '%s' not found", name);
+            return false;
+        }
+    }
+    if (rd.left() != 0) {
+        RISCV_sprintf(errmsg, errsz, "%s", "Wrong file format");
+        return false;
+    }
+
+    SnapshotReader rd2(&image[data_offset], sz - data_offset);
+    for (uint32_t i = 0; i < hdr[1]; i++) {
+        const char *name = rd2.readString();
+        uint32_t secsz;
+        rd2.read(&secsz, sizeof(secsz));
+        SnapshotReader section(rd2.readData(secsz), secsz);
+        ISnapshot *isnap = static_cast<ISnapshot *>(
+                    RISCV_get_service_iface(name, IFACE_SNAPSHOT));
+        if (!isnap->restoreState(&section) || section.left() != 0) {
+            RISCV_sprintf(errmsg, errsz,
+                          "Wrong state of '%s', simulation state is "
+                          "inconsistent", name);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Like the file restore, nothing is rewound unless every service keeps
+ * the in-memory snapshot.
+ */
+void CmdRestore::rewindAll(AttributeType *res) {
+    AttributeType list;
+    RISCV_get_services_with_iface(IFACE_SNAPSHOT, &list);
+    for (unsigned i = 0; i < list.size(); i++) {
+        IService *iserv = static_cast<IService *>(list[i].to_iface());
+        ISnapshot *isnap = static_cast<ISnapshot *>(
+                            iserv->getInterface(IFACE_SNAPSHOT));
+        if (!isnap->hasSnapshot()) {
+            generateError(res, "Snapshot wasn't saved");
+            return;
+        }
+    }
+    for (unsigned i = 0; i < list.size(); i++) {
+        IService *iserv = static_cast<IService *>(list[i].to_iface());
+        ISnapshot *isnap = static_cast<ISnapshot *>(
+                            iserv->getInterface(IFACE_SNAPSHOT));
+        if (!isnap->rewindSnapshot()) {
+            char errmsg[256];
+            RISCV_sprintf(errmsg, sizeof(errmsg),
+                          "Wrong state of '%s', simulation state is "
+                          "inconsistent", iserv->getObjName());
+            generateError(res, errmsg);
+            return;
+        }
+    }
+}
+
+}  // namespace debugger
@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <string.h>
+#include "iservice.h"
+#include "cmd_save.h"
+#include "debug/dsumap.h"
+#include "coreservices/isnapshot.h"
+
+namespace debugger {
+
+CmdSave::CmdSave(ITap *tap) : ICommand ("save", tap) {
+
+    briefDescr_.make_string("Save simulation state into file");
+    detailedDescr_.make_string(
+        "Description:\n"
+        "    Save state of the CPU, memories and peripheries into the\n"
+        "    checkpoint file. Without file name the state is kept in\n"
+        "    host memory and only modified memory pages are copied later.\n"
+        "    Simulation must be halted.\n"
+        "Example:\n"
+        "    save boot.snap\n"
+        "    save\n");
+}
+
+int CmdSave::isValid(AttributeType *args) {
+    if (!cmdName_.is_equal((*args)[0u].to_string())) {
+        return CMD_INVALID;
+    }
+    if (args->size() == 1 || args->size() == 2) {
+        return CMD_VALID;
+    }
+    return CMD_WRONG_ARGS;
+}
+
+void CmdSave::exec(AttributeType *args, AttributeType *res) {
+    res->attr_free();
+    res->make_nil();
+    if (isValid(args) != CMD_VALID) {
+        generateError(res, "Wrong argument list");
+        return;
+    }
+    if (!isHalted()) {
+        generateError(res, "Target isn't halted");
+        return;
+    }
+
+    if (args->size() == 1) {
+        AttributeType list;
+        RISCV_get_services_with_iface(IFACE_SNAPSHOT, &list);
+        for (unsigned i = 0; i < list.size(); i++) {
+            IService *iserv = static_cast<IService *>(list[i].to_iface());
+            static_cast<ISnapshot *>(
+                iserv->getInterface(IFACE_SNAPSHOT))->takeSnapshot();
+        }
+        return;
+    }
+    const char *err = saveFile((*args)[1].to_string());
+    if (err) {
+        generateError(res, err);
+    }
+}
+
+const char *CmdSave::saveFile(const char *filename) {
+    AttributeType list;
+    AutoBuffer buf;
+    uint32_t sz = 0;
+    RISCV_get_services_with_iface(IFACE_SNAPSHOT, &list);
+    for (unsigned i = 0; i < list.size(); i++) {
+        IService *iserv = static_cast<IService *>(list[i].to_iface());
+        ISnapshot *isnap = static_cast<ISnapshot *>(
+                            iserv->getInterface(IFACE_SNAPSHOT));
+        buf.write_bin(iserv->getObjName(),
+                      static_cast<int>(strlen(iserv->getObjName())) + 1);
+        int sz_offset = buf.size();
+        buf.write_bin(reinterpret_cast<char *>(&sz), sizeof(sz));
+        isnap->saveState(&buf);
+        sz = static_cast<uint32_t>(buf.size() - sz_offset - sizeof(sz));
+        memcpy(&buf.getBuffer()[sz_offset], &sz, sizeof(sz));
+    }
+
+    FILE *fp = fopen(filename, "wb");
+    if (!fp) {
+        return "Can't open file";
+    }
+    uint32_t hdr[2];
+    hdr[0] = SNAPSHOT_VERSION;
+    hdr[1] = list.size();
+    fwrite(SNAPSHOT_MAGIC, 1, sizeof(SNAPSHOT_MAGIC), fp);
+    fwrite(hdr, 1, sizeof(hdr), fp);
+    fwrite(buf.getBuffer(), 1, buf.size(), fp);
+    fclose(fp);
+    return 0;
+}
+
+}  // namespace debugger
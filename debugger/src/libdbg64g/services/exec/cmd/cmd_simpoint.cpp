@@ -0,0 +1,325 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include "cmd_simpoint.h"
+#include "cmd_save.h"
+#include "debug/dsumap.h"
+
+namespace debugger {
+
+CmdSimPoint::CmdSimPoint(ITap *tap) : ICommand ("simpoint", tap) {
+
+    briefDescr_.make_string("Select representative simulation intervals");
+    detailedDescr_.make_string(
+        "Description:\n"
+        "    Cluster intervals of the file generated with the BbvFile\n"
+        "    attribute into 'k' phases and select the interval closest to\n"
+        "    the center of each phase. Basic block vectors are normalized\n"
+        "    and randomly projected before the k-means clustering.\n"
+        "    With the file prefix the halted simulation runs to the start\n"
+        "    of each selected interval and saves the checkpoint file\n"
+        "    <prefix><n>.snap. Simulation must start at the same step and\n"
+        "    state as the recorded one.\n"
+        "Output format:\n"
+        "    [[i,i,d,s],*]\n"
+        "         i - Interval index.\n"
+        "         i - Interval start step.\n"
+        "         d - Phase weight: part of the executed instructions.\n"
+        "         s - Checkpoint file name if prefix is specified.\n"
+        "Example:\n"
+        "    simpoint app.bbv 8\n"
+        "    simpoint app.bbv 8 app_sp\n");
+}
+
+int CmdSimPoint::isValid(AttributeType *args) {
+    if (!cmdName_.is_equal((*args)[0u].to_string())) {
+        return CMD_INVALID;
+    }
+    if ((args->size() == 3 || args->size() == 4)
+        && (*args)[1].is_string() && (*args)[2].is_integer()) {
+        return CMD_VALID;
+    }
+    return CMD_WRONG_ARGS;
+}
+
+void CmdSimPoint::exec(AttributeType *args, AttributeType *res) {
+    res->attr_free();
+    res->make_nil();
+    if (isValid(args) != CMD_VALID) {
+        generateError(res, "Wrong argument list");
+        return;
+    }
+    if ((*args)[2].to_uint64() == 0) {
+        generateError(res, "Wrong number of phases");
+        return;
+    }
+
+    BbvReader bbv;
+    const char *err = bbv.load((*args)[1].to_string());
+    if (err) {
+        generateError(res, err);
+        return;
+    }
+    unsigned total = bbv.intervals();
+    unsigned k = (*args)[2].to_uint32();
+    if (k > total) {
+        k = total;
+    }
+
+    double *vec = new double[total * PROJECT_DIM];
+    double *centroid = new double[k * PROJECT_DIM];
+    unsigned *cl = new unsigned[total];
+    cluster(&bbv, k, vec, cl, centroid);
+
+    uint64_t *weight = new uint64_t[k];
+    unsigned *best = new unsigned[k];
+    double *bestDist = new double[k];
+    uint64_t allsteps = 0;
+    for (unsigned c = 0; c < k; c++) {
+        weight[c] = 0;
+        best[c] = total;
+    }
+    for (unsigned i = 0; i < total; i++) {
+        unsigned c = cl[i];
+        double d = 0;
+        for (unsigned n = 0; n < PROJECT_DIM; n++) {
+            double t = vec[i * PROJECT_DIM + n] - centroid[c * PROJECT_DIM + n];
+            d += t * t;
+        }
+        weight[c] += bbv.steps(i);
+        allsteps += bbv.steps(i);
+        if (best[c] == total || d < bestDist[c]) {
+            best[c] = i;
+            bestDist[c] = d;
+        }
+    }
+
+    // Intervals are stored in the order of steps
+    AttributeType item;
+    res->make_list(0);
+    for (unsigned i = 0; i < total; i++) {
+        unsigned c = cl[i];
+        if (best[c] != i) {
+            continue;
+        }
+        item.make_list(3);
+        item[0u].make_uint64(i);
+        item[1].make_uint64(bbv.startStep(i));
+        item[2].make_floating(allsteps ? static_cast<double>(weight[c])
+                                       / static_cast<double>(allsteps) : 0);
+        res->add_to_list(&item);
+    }
+    delete [] vec;
+    delete [] centroid;
+    delete [] cl;
+    delete [] weight;
+    delete [] best;
+    delete [] bestDist;
+
+    if (args->size() == 4) {
+        err = makeCheckpoints((*args)[3].to_string(), res);
+        if (err) {
+            generateError(res, err);
+        }
+    }
+}
+
+/** Uniformly distributed value [-1, 1) of the hashed counter */
+static double simpoint_random(uint64_t x) {
+    x = (x + 1) * 0x9E3779B97F4A7C15ull;
+    x ^= x >> 31;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 29;
+    return static_cast<double>(x >> 11) / 4503599627370496.0 - 1.0;
+}
+
+/**
+ * The random projection matrix is generated from the block index, so the
+ * result is the same for the same file. Initial centers are selected by
+ * k-means++ method with the fixed seed.
+ */
+void CmdSimPoint::cluster(BbvReader *bbv, unsigned k, double *vec,
+                          unsigned *cl, double *centroid) {
+    const unsigned D = PROJECT_DIM;
+    unsigned total = bbv->intervals();
+    uint64_t seed = bbv->blocks();
+
+    for (unsigned i = 0; i < total; i++) {
+        double *v = &vec[i * D];
+        double norm = 0;
+        for (unsigned e = bbv->entryBegin(i); e < bbv->entryBegin(i + 1);
+             e++) {
+            norm += static_cast<double>(bbv->entryCount(e));
+        }
+        memset(v, 0, D * sizeof(double));
+        for (unsigned e = bbv->entryBegin(i); e < bbv->entryBegin(i + 1);
+             e++) {
+            double w = static_cast<double>(bbv->entryCount(e)) / norm;
+            uint64_t b = bbv->entryBlock(e);
+            for (unsigned n = 0; n < D; n++) {
+                v[n] += w * simpoint_random(b * D + n);
+            }
+        }
+    }
+
+    // k-means++ initialization
+    double *dist = new double[total];
+    unsigned first = static_cast<unsigned>(
+        (simpoint_random(seed++) + 1.0) * 0.5 * total) % total;
+    memcpy(centroid, &vec[first * D], D * sizeof(double));
+    for (unsigned i = 0; i < total; i++) {
+        dist[i] = -1.0;
+        cl[i] = 0;
+    }
+    for (unsigned c = 1; c <= k; c++) {
+        double sum = 0;
+        for (unsigned i = 0; i < total; i++) {
+            double d = 0;
+            for (unsigned n = 0; n < D; n++) {
+                double t = vec[i * D + n] - centroid[(c - 1) * D + n];
+                d += t * t;
+            }
+            if (dist[i] < 0 || d < dist[i]) {
+                dist[i] = d;
+                cl[i] = c - 1;
+            }
+            sum += dist[i];
+        }
+        if (c == k) {
+            break;
+        }
+        double r = (simpoint_random(seed++) + 1.0) * 0.5 * sum;
+        unsigned sel = total - 1;
+        for (unsigned i = 0; i < total; i++) {
+            r -= dist[i];
+            if (r < 0) {
+                sel = i;
+                break;
+            }
+        }
+        memcpy(&centroid[c * D], &vec[sel * D], D * sizeof(double));
+    }
+    delete [] dist;
+
+    unsigned *cnt = new unsigned[k];
+    for (unsigned iter = 0; iter < ITERATIONS_MAX; iter++) {
+        // Update centers, center of the empty cluster isn't changed
+        for (unsigned c = 0; c < k; c++) {
+            cnt[c] = 0;
+        }
+        for (unsigned i = 0; i < total; i++) {
+            if (cnt[cl[i]]++ == 0) {
+                memset(&centroid[cl[i] * D], 0, D * sizeof(double));
+            }
+            for (unsigned n = 0; n < D; n++) {
+                centroid[cl[i] * D + n] += vec[i * D + n];
+            }
+        }
+        for (unsigned c = 0; c < k; c++) {
+            for (unsigned n = 0; cnt[c] && n < D; n++) {
+                centroid[c * D + n] /= cnt[c];
+            }
+        }
+
+        bool changed = false;
+        for (unsigned i = 0; i < total; i++) {
+            unsigned sel = cl[i];
+            double mindist = -1.0;
+            for (unsigned c = 0; c < k; c++) {
+                double d = 0;
+                for (unsigned n = 0; n < D; n++) {
+                    double t = vec[i * D + n] - centroid[c * D + n];
+                    d += t * t;
+                }
+                if (mindist < 0 || d < mindist) {
+                    mindist = d;
+                    sel = c;
+                }
+            }
+            if (sel != cl[i]) {
+                cl[i] = sel;
+                changed = true;
+            }
+        }
+        if (!changed) {
+            break;
+        }
+    }
+    delete [] cnt;
+}
+
+/**
+ * Simulation is moved by the stepping mode the same way as 'run <N>'
+ * command does, so the clock queue events happen at the same steps as
+ * while recording.
+ */
+const char *CmdSimPoint::makeCheckpoints(const char *prefix,
+                                         AttributeType *points) {
+    DsuMapType *dsu = DSUBASE();
+    uint64_t addr_run_ctrl = reinterpret_cast<uint64_t>(&dsu->udbg.v.control);
+    uint64_t addr_step_cnt =
+        reinterpret_cast<uint64_t>(&dsu->udbg.v.stepping_mode_steps);
+    char fname[1024];
+    Reg64Type t1;
+
+    if (!isHalted()) {
+        return "Target isn't halted";
+    }
+    for (unsigned i = 0; i < points->size(); i++) {
+        AttributeType &pt = (*points)[i];
+        uint64_t step = pt[1].to_uint64();
+        uint64_t cur = getStepCounter();
+        if (cur > step) {
+            return "Simulation is ahead of the simulation point";
+        }
+        if (cur < step) {
+            t1.val = step - cur;
+            tap_->write(addr_step_cnt, 8, t1.buf);
+
+            GenericCpuControlType ctrl;
+            ctrl.val = 0;
+            ctrl.bits.stepping = 1;
+            t1.val = ctrl.val;
+            tap_->write(addr_run_ctrl, 8, t1.buf);
+            while (!isHalted()) {
+                RISCV_sleep_ms(10);
+            }
+            if (getStepCounter() != step) {
+                return "Simulation halted before the simulation point";
+            }
+        }
+
+        RISCV_sprintf(fname, sizeof(fname), "%s%d.snap", prefix, i);
+        const char *err = CmdSave::saveFile(fname);
+        if (err) {
+            return err;
+        }
+        pt.realloc_list(4);
+        pt[3].make_string(fname);
+    }
+    return 0;
+}
+
+uint64_t CmdSimPoint::getStepCounter() {
+    Reg64Type t1;
+    DsuMapType *pdsu = DSUBASE();
+    uint64_t addr = reinterpret_cast<uint64_t>(&pdsu->udbg.v.executed_cnt);
+    tap_->read(addr, 8, t1.buf);
+    return t1.val;
+}
+
+}  // namespace debugger
@@ -0,0 +1,49 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_CMD_SIMPOINT_H__
+#define __DEBUGGER_CMD_SIMPOINT_H__
+
+#include "api_core.h"
+#include "coreservices/itap.h"
+#include "coreservices/icommand.h"
+#include "generic/bbv.h"
+
+namespace debugger {
+
+class CmdSimPoint : public ICommand  {
+ public:
+    explicit CmdSimPoint(ITap *tap);
+
+    /** ICommand */
+    virtual int isValid(AttributeType *args);
+    virtual void exec(AttributeType *args, AttributeType *res);
+
+ private:
+    /** Put cluster index of each interval into 'cluster' */
+    void cluster(BbvReader *bbv, unsigned k, double *vec, unsigned *cluster,
+                 double *centroid);
+    const char *makeCheckpoints(const char *prefix, AttributeType *points);
+    uint64_t getStepCounter();
+
+ private:
+    static const unsigned PROJECT_DIM = 15;
+    static const unsigned ITERATIONS_MAX = 100;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_CMD_SIMPOINT_H__
@@ -0,0 +1,69 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include "cmd_tracecvt.h"
+#include "generic/bintrace.h"
+
+namespace debugger {
+
+CmdTraceCvt::CmdTraceCvt(ITap *tap) : ICommand ("tracecvt", tap) {
+
+    briefDescr_.make_string("Convert binary CPU trace into text files");
+    detailedDescr_.make_string(
+        "Description:\n"
+        "    Convert file generated with the BinaryTraceFile attribute\n"
+        "    into the registers and memory text trace files. Use '-' to\n"
+        "    skip one of the outputs.\n"
+        "Example:\n"
+        "    tracecvt trace.bin river_func_regs.log river_func_mem.log\n"
+        "    tracecvt trace.bin - river_func_mem.log\n");
+}
+
+int CmdTraceCvt::isValid(AttributeType *args) {
+    if (!cmdName_.is_equal((*args)[0u].to_string())) {
+        return CMD_INVALID;
+    }
+    if (args->size() == 4) {
+        return CMD_VALID;
+    }
+    return CMD_WRONG_ARGS;
+}
+
+void CmdTraceCvt::exec(AttributeType *args, AttributeType *res) {
+    res->attr_free();
+    res->make_nil();
+    if (isValid(args) != CMD_VALID) {
+        generateError(res, "Wrong argument list");
+        return;
+    }
+
+    const char *regfile = (*args)[2].to_string();
+    const char *memfile = (*args)[3].to_string();
+    if (strcmp(regfile, "-") == 0) {
+        regfile = 0;
+    }
+    if (strcmp(memfile, "-") == 0) {
+        memfile = 0;
+    }
+    const char *err = convertBinTrace((*args)[1].to_string(),
+                                      regfile, memfile);
+    if (err) {
+        generateError(res, err);
+    }
+}
+
+}  // namespace debugger
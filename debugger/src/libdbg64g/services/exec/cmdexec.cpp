@@ -25,6 +25,8 @@
 #include "cmd/cmd_write.h"
 #include "cmd/cmd_run.h"
 #include "cmd/cmd_halt.h"
+#include "cmd/cmd_hart.h"
+#include "cmd/cmd_imix.h"
 #include "cmd/cmd_exit.h"
 #include "cmd/cmd_memdump.h"
 #include "cmd/cmd_cpi.h"
@@ -36,6 +38,12 @@
 #include "cmd/cmd_stack.h"
 #include "cmd/cmd_loadbin.h"
 #include "cmd/cmd_elf2raw.h"
+#include "cmd/cmd_tracecvt.h"
+#include "cmd/cmd_save.h"
+#include "cmd/cmd_restore.h"
+#include "cmd/cmd_coverage.h"
+#include "cmd/cmd_profile.h"
+#include "cmd/cmd_simpoint.h"
 
 namespace debugger {
 
@@ -69,11 +77,14 @@ void CmdExecutor::postinitService() {
 
     // Core commands registration:
     registerCommand(new CmdBusUtil(itap_));
+    registerCommand(new CmdCoverage(itap_));
     registerCommand(new CmdCpi(itap_));
     registerCommand(new CmdDisas(itap_));
     registerCommand(new CmdElf2Raw(itap_));
     registerCommand(new CmdExit(itap_));
     registerCommand(new CmdHalt(itap_));
+    registerCommand(new CmdHart(itap_));
+    registerCommand(new CmdInstrMix(itap_));
     registerCommand(new CmdIsRunning(itap_));
     registerCommand(new CmdLoadBin(itap_));
     registerCommand(new CmdLoadElf(itap_));
@@ -81,12 +92,17 @@ void CmdExecutor::postinitService() {
     registerCommand(new CmdLoadSrec(itap_));
     registerCommand(new CmdLog(itap_));
     registerCommand(new CmdMemDump(itap_));
+    registerCommand(new CmdProfile(itap_));
     registerCommand(new CmdRead(itap_));
     registerCommand(new CmdRun(itap_));
     registerCommand(new CmdReset(itap_));
+    registerCommand(new CmdRestore(itap_));
+    registerCommand(new CmdSave(itap_));
+    registerCommand(new CmdSimPoint(itap_));
     registerCommand(new CmdStack(itap_));
     registerCommand(new CmdStatus(itap_));
     registerCommand(new CmdSymb(itap_));
+    registerCommand(new CmdTraceCvt(itap_));
     registerCommand(new CmdWrite(itap_));
 }
 
@@ -33,7 +33,7 @@ MemorySim::MemorySim(const char *name)  : MemoryGeneric(name) {
 void MemorySim::postinitService() {
     MemoryGeneric::postinitService();
 
-    if (initFile_.size() == 0) {
+    if (mem_ == NULL || initFile_.size() == 0) {
         return;
     }
 
@@ -56,72 +56,94 @@ void MemorySim::postinitService() {
         return;
     }
 
+    if (binaryFile_.to_bool() && mapFile(initFile_.to_string())) {
+        fclose(fp);
+        return;
+    }
+    fseek(fp, 0, SEEK_END);
+    long fsz = ftell(fp);
+    if (fsz < 0) {
+        RISCV_error("Can't read '%s' file", initFile_.to_string());
+        fclose(fp);
+        return;
+    }
+    fseek(fp, 0, SEEK_SET);
     if (binaryFile_.to_bool()) {
-        fseek(fp, 0, SEEK_END);
-        uint64_t fsz = ftell(fp);
-        if (fsz > length_.to_uint64()) {
-            fsz = length_.to_uint64();
+        uint64_t rdsz = static_cast<uint64_t>(fsz);
+        if (rdsz > length_.to_uint64()) {
+            rdsz = length_.to_uint64();
         }
-        fseek(fp, 0, SEEK_SET);
-        fread(mem_, 1, static_cast<size_t>(fsz), fp);
+        fread(mem_, 1, static_cast<size_t>(rdsz), fp);
     } else {
-        bool bhalf = false;
-        int rd_symb;
-        uint8_t symb;
-        int linecnt = 0;
-        int symbinline = SYMB_IN_LINE - 1;
-        while (!feof(fp)) {
-            rd_symb = fgetc(fp);
-            if (!chishex(rd_symb))
-                continue;
-
-            if (!bhalf) {
-                bhalf = true;
-                symb = chtohex(rd_symb) << 4;
-                continue;
-            } 
-
-            bhalf = false;
-            symb |= chtohex(rd_symb) & 0xf;
-
-            if ((SYMB_IN_LINE * linecnt + symbinline) >= 
-                        static_cast<int>(length_.to_uint64())) {
-                RISCV_error("HEX file tries to write out "
-                            "of allocated array\n", NULL);
-                break;
-            } 
-
-            mem_[SYMB_IN_LINE * linecnt + symbinline] = symb;
-            if (--symbinline < 0) {
-                linecnt++;
-                symbinline = SYMB_IN_LINE - 1;
-            }
-        }
+        uint8_t *buf = new uint8_t[static_cast<size_t>(fsz)];
+        uint64_t rdsz = fread(buf, 1, static_cast<size_t>(fsz), fp);
+        loadHex(buf, rdsz);
+        delete [] buf;
     }
     fclose(fp);
 }
 
-bool MemorySim::chishex(int s) {
-    bool ret = false;
-    if (s >= '0' && s <= '9') {
-        ret = true;
-    } else if (s >= 'A' && s <= 'F') {
-        ret = true;
-    } else if (s >= 'a' && s <= 'f') {
-        ret = true;
+/**
+ * Each line contains 64-bit word as 16 hex digits, most significant digit
+ * first. Non-hex symbols are skipped. Lines of exactly 16 digits are
+ * decoded at once, others symbol by symbol.
+ */
+void MemorySim::loadHex(const uint8_t *buf, uint64_t sz) {
+    int8_t hex[256];
+    memset(hex, -1, sizeof(hex));
+    for (int i = 0; i < 10; i++) {
+        hex['0' + i] = static_cast<int8_t>(i);
     }
-    return ret;
-}
+    for (int i = 0; i < 6; i++) {
+        hex['A' + i] = static_cast<int8_t>(10 + i);
+        hex['a' + i] = static_cast<int8_t>(10 + i);
+    }
+
+    uint64_t len = length_.to_uint64();
+    uint64_t line = 0;                  // offset of the current word
+    int symbinline = SYMB_IN_LINE - 1;
+    int high = -1;                      // pending high nibble
+    uint64_t i = 0;
+    while (i < sz) {
+        if (symbinline == SYMB_IN_LINE - 1 && high < 0
+            && i + 2*SYMB_IN_LINE <= sz && line + SYMB_IN_LINE <= len) {
+            uint64_t v = 0;
+            int8_t bad = 0;
+            for (int n = 0; n < 2*SYMB_IN_LINE; n++) {
+                int8_t d = hex[buf[i + n]];
+                bad |= d;
+                v = (v << 4) | static_cast<uint64_t>(d & 0xF);
+            }
+            if (bad >= 0) {
+                for (int n = 0; n < SYMB_IN_LINE; n++) {
+                    mem_[line + n] = static_cast<uint8_t>(v >> (8*n));
+                }
+                line += SYMB_IN_LINE;
+                i += 2*SYMB_IN_LINE;
+                continue;
+            }
+        }
 
-uint8_t MemorySim::chtohex(int s) {
-    if (s >= '0' && s <= '9') {
-        s -= '0';
-    } else if (s >= 'A' && s <= 'F') {
-        s = s - 'A' + 10;
-    } else if (s >= 'a' && s <= 'f') {
-        s = s - 'a' + 10;
+        int8_t d = hex[buf[i++]];
+        if (d < 0) {
+            continue;
+        }
+        if (high < 0) {
+            high = d;
+            continue;
+        }
+        if (line + symbinline >= len) {
+            RISCV_error("HEX file tries to write out "
+                        "of allocated array\n", NULL);
+            break;
+        }
+        mem_[line + symbinline] = static_cast<uint8_t>((high << 4) | d);
+        high = -1;
+        if (--symbinline < 0) {
+            line += SYMB_IN_LINE;
+            symbinline = SYMB_IN_LINE - 1;
+        }
     }
-    return static_cast<uint8_t>(s);
 }
 
 }  // namespace debugger
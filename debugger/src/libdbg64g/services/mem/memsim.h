@@ -30,8 +30,7 @@ class MemorySim : public MemoryGeneric {
 
  private:
     static const int SYMB_IN_LINE = 16/2;
-    bool chishex(int s);
-    uint8_t chtohex(int s);
+    void loadHex(const uint8_t *buf, uint64_t sz);
 
  private:
     AttributeType initFile_;
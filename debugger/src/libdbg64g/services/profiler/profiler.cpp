@@ -0,0 +1,313 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <autobuffer.h>
+#include "profiler.h"
+
+namespace debugger {
+
+ProfilerService::ProfilerService(const char *name) : IService(name) {
+    registerInterface(static_cast<IClockListener *>(this));
+    registerInterface(static_cast<IProfiler *>(this));
+    registerAttribute("Enable", &enable_);
+    registerAttribute("Cpu", &cpu_);
+    registerAttribute("SourceCode", &sourceCode_);
+    registerAttribute("SamplePeriod", &samplePeriod_);
+
+    enable_.make_boolean(false);
+    cpu_.make_string("core0");
+    sourceCode_.make_string("src0");
+    samplePeriod_.make_uint64(10000);
+    iclk_ = 0;
+    icpu_ = 0;
+    isrc_ = 0;
+    enabled_ = false;
+    stacks_ = 0;
+    stackCnt_ = 0;
+    stackMax_ = 0;
+    hash_ = 0;
+    hashMax_ = 0;
+    frames_ = 0;
+    frameCnt_ = 0;
+    frameMax_ = 0;
+    total_ = 0;
+    RISCV_mutex_init(&mutex_);
+}
+
+ProfilerService::~ProfilerService() {
+    delete [] stacks_;
+    delete [] hash_;
+    delete [] frames_;
+    RISCV_mutex_destroy(&mutex_);
+}
+
+void ProfilerService::postinitService() {
+    iclk_ = static_cast<IClock *>(
+        RISCV_get_service_iface(cpu_.to_string(), IFACE_CLOCK));
+    icpu_ = static_cast<ICpuFunctional *>(
+        RISCV_get_service_iface(cpu_.to_string(), IFACE_CPU_FUNCTIONAL));
+    if (!iclk_ || !icpu_) {
+        RISCV_error("Functional CPU '%s' not found", cpu_.to_string());
+        return;
+    }
+    isrc_ = static_cast<ISourceCode *>(
+        RISCV_get_service_iface(sourceCode_.to_string(), IFACE_SOURCE_CODE));
+    if (!isrc_) {
+        RISCV_error("Source code interface '%s' not found",
+                    sourceCode_.to_string());
+    }
+    enableProfiler(enable_.to_bool(), 0);
+    // The only registration outside of the CPU thread: it isn't running yet
+    iclk_->registerStepCallback(static_cast<IClockListener *>(this),
+                                iclk_->getStepCounter()
+                                + samplePeriod_.to_uint64());
+}
+
+/**
+ * Called from the command thread, so it only changes the flag. Callback
+ * always stays in the clock queue and is re-registered by stepCallback()
+ * in the CPU thread; new period is applied starting from the next sample.
+ */
+void ProfilerService::enableProfiler(bool en, uint64_t period) {
+    if (!iclk_) {
+        return;
+    }
+    if (period) {
+        samplePeriod_.make_uint64(period);
+    } else if (samplePeriod_.to_uint64() == 0) {
+        samplePeriod_.make_uint64(1);
+    }
+    enabled_ = en;
+}
+
+void ProfilerService::stepCallback(uint64_t t) {
+    iclk_->registerStepCallback(static_cast<IClockListener *>(this),
+                                t + samplePeriod_.to_uint64());
+    if (!enabled_) {
+        return;
+    }
+    uint64_t frames[STACK_DEPTH_MAX + 1];
+    unsigned depth = icpu_->getCallStack(frames, STACK_DEPTH_MAX);
+    frames[depth++] = icpu_->getPC();
+
+    RISCV_mutex_lock(&mutex_);
+    addSample(frames, depth);
+    RISCV_mutex_unlock(&mutex_);
+}
+
+void ProfilerService::resetProfile() {
+    RISCV_mutex_lock(&mutex_);
+    stackCnt_ = 0;
+    frameCnt_ = 0;
+    total_ = 0;
+    if (hash_) {
+        memset(hash_, 0xFF, hashMax_ * sizeof(int));
+    }
+    RISCV_mutex_unlock(&mutex_);
+}
+
+uint64_t ProfilerService::stackHash(const uint64_t *frames, unsigned depth) {
+    uint64_t h = depth;
+    for (unsigned i = 0; i < depth; i++) {
+        h = (h ^ frames[i]) * 0x9E3779B97F4A7C15ull;
+        h ^= h >> 29;
+    }
+    return h ^ (h >> 32);
+}
+
+void ProfilerService::rehash(unsigned sz) {
+    delete [] hash_;
+    hashMax_ = sz;
+    hash_ = new int[hashMax_];
+    memset(hash_, 0xFF, hashMax_ * sizeof(int));
+    for (unsigned i = 0; i < stackCnt_; i++) {
+        StackType &st = stacks_[i];
+        unsigned slot = static_cast<unsigned>(
+                stackHash(&frames_[st.offset], st.depth)) & (hashMax_ - 1);
+        while (hash_[slot] >= 0) {
+            slot = (slot + 1) & (hashMax_ - 1);
+        }
+        hash_[slot] = static_cast<int>(i);
+    }
+}
+
+void ProfilerService::addSample(const uint64_t *frames, unsigned depth) {
+    if (2 * (stackCnt_ + 1) > hashMax_) {
+        rehash(hashMax_ ? 2 * hashMax_ : 1024);
+    }
+    unsigned slot = static_cast<unsigned>(stackHash(frames, depth))
+                    & (hashMax_ - 1);
+    total_++;
+    while (hash_[slot] >= 0) {
+        StackType &st = stacks_[hash_[slot]];
+        if (st.depth == depth && memcmp(&frames_[st.offset], frames,
+                                        depth * sizeof(uint64_t)) == 0) {
+            st.count++;
+            return;
+        }
+        slot = (slot + 1) & (hashMax_ - 1);
+    }
+
+    if (stackCnt_ == stackMax_) {
+        stackMax_ = stackMax_ ? 2 * stackMax_ : 512;
+        StackType *t = new StackType[stackMax_];
+        if (stackCnt_) {
+            memcpy(t, stacks_, stackCnt_ * sizeof(StackType));
+        }
+        delete [] stacks_;
+        stacks_ = t;
+    }
+    if (frameCnt_ + depth > frameMax_) {
+        while (frameCnt_ + depth > frameMax_) {
+            frameMax_ = frameMax_ ? 2 * frameMax_ : 4096;
+        }
+        uint64_t *t = new uint64_t[frameMax_];
+        if (frameCnt_) {
+            memcpy(t, frames_, frameCnt_ * sizeof(uint64_t));
+        }
+        delete [] frames_;
+        frames_ = t;
+    }
+    StackType &st = stacks_[stackCnt_];
+    st.count = 1;
+    st.offset = frameCnt_;
+    st.depth = depth;
+    memcpy(&frames_[frameCnt_], frames, depth * sizeof(uint64_t));
+    frameCnt_ += depth;
+    hash_[slot] = static_cast<int>(stackCnt_++);
+}
+
+/** Function name or hex address when it's outside of the known symbols */
+void ProfilerService::symbolName(uint64_t addr, AttributeType *name) {
+    AttributeType info;
+    if (isrc_) {
+        isrc_->addressToSymbol(addr, &info);
+    }
+    if (info.is_list() && info.size() && info[0u].size()) {
+        *name = info[0u];
+    } else {
+        char tstr[32];
+        RISCV_sprintf(tstr, sizeof(tstr), "0x%08" RV_PRI64 "x", addr);
+        name->make_string(tstr);
+    }
+}
+
+void ProfilerService::getTopFunctions(unsigned n, AttributeType *res) {
+    AttributeType items;        // [name, self, inclusive] per stack frame
+    AttributeType names;
+    AttributeType item;
+    items.make_list(0);
+    item.make_list(ProfFunc_Total);
+
+    RISCV_mutex_lock(&mutex_);
+    for (unsigned i = 0; i < stackCnt_; i++) {
+        StackType &st = stacks_[i];
+        names.make_list(st.depth);
+        for (unsigned k = 0; k < st.depth; k++) {
+            symbolName(frames_[st.offset + k], &names[k]);
+        }
+        for (unsigned k = 0; k < st.depth; k++) {
+            // Recursive calls are counted once per sample
+            bool found = false;
+            for (unsigned j = k + 1; j < st.depth && !found; j++) {
+                found = names[j].is_equal(names[k].to_string());
+            }
+            if (found) {
+                continue;
+            }
+            item[ProfFunc_Name] = names[k];
+            item[ProfFunc_Self].make_uint64(k + 1 == st.depth ? st.count : 0);
+            item[ProfFunc_Inclusive].make_uint64(st.count);
+            items.add_to_list(&item);
+        }
+    }
+    RISCV_mutex_unlock(&mutex_);
+
+    // Merge items of the same function
+    AttributeType funcs;
+    funcs.make_list(0);
+    items.sort(ProfFunc_Name);
+    for (unsigned i = 0; i < items.size(); i++) {
+        AttributeType &t = items[i];
+        if (funcs.size() == 0 || !funcs[funcs.size() - 1][ProfFunc_Name]
+                    .is_equal(t[ProfFunc_Name].to_string())) {
+            funcs.add_to_list(&t);
+            continue;
+        }
+        AttributeType &f = funcs[funcs.size() - 1];
+        f[ProfFunc_Self].make_uint64(f[ProfFunc_Self].to_uint64()
+                                   + t[ProfFunc_Self].to_uint64());
+        f[ProfFunc_Inclusive].make_uint64(f[ProfFunc_Inclusive].to_uint64()
+                                        + t[ProfFunc_Inclusive].to_uint64());
+    }
+
+    funcs.sort(ProfFunc_Self);
+    if (n > funcs.size()) {
+        n = funcs.size();
+    }
+    res->make_list(n);
+    for (unsigned i = 0; i < n; i++) {
+        (*res)[i] = funcs[funcs.size() - 1 - i];
+    }
+}
+
+bool ProfilerService::writeFoldedStacks(const char *filename) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        return false;
+    }
+    AttributeType lines;        // [stack string, count]
+    AttributeType item;
+    AttributeType name;
+    AutoBuffer buf;
+    lines.make_list(0);
+    item.make_list(2);
+
+    RISCV_mutex_lock(&mutex_);
+    for (unsigned i = 0; i < stackCnt_; i++) {
+        StackType &st = stacks_[i];
+        buf.clear();
+        for (unsigned k = 0; k < st.depth; k++) {
+            symbolName(frames_[st.offset + k], &name);
+            if (k) {
+                buf.write_string(';');
+            }
+            buf.write_string(name.to_string());
+        }
+        item[0u].make_string(buf.getBuffer());
+        item[1].make_uint64(st.count);
+        lines.add_to_list(&item);
+    }
+    RISCV_mutex_unlock(&mutex_);
+
+    // Different addresses of the same functions give the same lines
+    lines.sort(0);
+    for (unsigned i = 0; i < lines.size(); ) {
+        const char *stack = lines[i][0u].to_string();
+        uint64_t cnt = 0;
+        for (; i < lines.size() && lines[i][0u].is_equal(stack); i++) {
+            cnt += lines[i][1].to_uint64();
+        }
+        fprintf(fp, "%s %" RV_PRI64 "d\n", stack, cnt);
+    }
+    fclose(fp);
+    return true;
+}
+
+}  // namespace debugger
@@ -0,0 +1,100 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef __DEBUGGER_SERVICES_PROFILER_PROFILER_H__
+#define __DEBUGGER_SERVICES_PROFILER_PROFILER_H__
+
+#include "iclass.h"
+#include "iservice.h"
+#include "coreservices/iclock.h"
+#include "coreservices/icpufunctional.h"
+#include "coreservices/isrccode.h"
+#include "coreservices/iprofiler.h"
+
+namespace debugger {
+
+/**
+ * @brief PC-sampling profiler.
+ *
+ * Sampling is done by the clock queue callback in the CPU thread. Stacks
+ * are stored as raw addresses and converted into the function names only
+ * on request, so that sampling doesn't depend on the symbols number.
+ */
+class ProfilerService : public IService,
+                        public IClockListener,
+                        public IProfiler {
+ public:
+    explicit ProfilerService(const char *name);
+    virtual ~ProfilerService();
+
+    /** IService interface */
+    virtual void postinitService();
+
+    /** IClockListener */
+    virtual void stepCallback(uint64_t t);
+
+    /** IProfiler */
+    virtual void enableProfiler(bool en, uint64_t period);
+    virtual bool isProfilerEnabled() { return enabled_; }
+    virtual uint64_t getSamplePeriod() { return samplePeriod_.to_uint64(); }
+    virtual uint64_t sampleTotal() { return total_; }
+    virtual void resetProfile();
+    virtual void getTopFunctions(unsigned n, AttributeType *res);
+    virtual bool writeFoldedStacks(const char *filename);
+
+ private:
+    void addSample(const uint64_t *frames, unsigned depth);
+    uint64_t stackHash(const uint64_t *frames, unsigned depth);
+    void rehash(unsigned sz);
+    void symbolName(uint64_t addr, AttributeType *name);
+
+ private:
+    static const unsigned STACK_DEPTH_MAX = 64;
+
+    AttributeType enable_;
+    AttributeType cpu_;
+    AttributeType sourceCode_;
+    AttributeType samplePeriod_;
+
+    IClock *iclk_;
+    ICpuFunctional *icpu_;
+    ISourceCode *isrc_;
+    bool enabled_;
+
+    /** Unique call stacks: call addresses followed by pc */
+    struct StackType {
+        uint64_t count;
+        unsigned offset;            // first frame in frames_
+        unsigned depth;
+    };
+    StackType *stacks_;
+    unsigned stackCnt_;
+    unsigned stackMax_;
+    int *hash_;                     // index in stacks_ or -1
+    unsigned hashMax_;              // power of 2
+    uint64_t *frames_;
+    unsigned frameCnt_;
+    unsigned frameMax_;
+    uint64_t total_;
+    mutex_def mutex_;
+};
+
+DECLARE_CLASS(ProfilerService)
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_SERVICES_PROFILER_PROFILER_H__
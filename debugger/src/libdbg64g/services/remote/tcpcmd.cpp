@@ -145,6 +145,8 @@ void TcpCommands::processCommand() {
         } else if (requestAction.is_equal("TimeSec")) {
             double t1 = iclk_->getStepCounter() / iclk_->getFreqHz();
             resp->make_floating(t1);
+        } else if (requestAction.is_equal("InstrMix")) {
+            iexec_->exec("imix", resp, false);
         } else {
             resp->make_string("Wrong status command");
         }
@@ -157,6 +159,25 @@ void TcpCommands::processCommand() {
         } else {
             resp->make_string("Wrong symbol command");
         }
+    } else if (requestType.is_equal("Snapshot")) {
+        /** Checkpoint of the halted simulation */
+        char tstr[4096];
+        const char *cmd = 0;
+        if (requestAction[0u].is_equal("Save")) {
+            cmd = "save";
+        } else if (requestAction[0u].is_equal("Restore")) {
+            cmd = "restore";
+        }
+        if (cmd && requestAction.size() == 1) {
+            // In-memory snapshot
+            iexec_->exec(cmd, resp, false);
+        } else if (cmd) {
+            RISCV_sprintf(tstr, sizeof(tstr), "%s %s", cmd,
+                          requestAction[1].to_string());
+            iexec_->exec(tstr, resp, false);
+        } else {
+            resp->make_string("Wrong snapshot command");
+        }
     } else if (requestType.is_equal("Attribute")) {
         IService *isrv = static_cast<IService *>(
                         RISCV_get_service(requestAction[0u].to_string()));
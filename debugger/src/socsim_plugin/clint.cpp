@@ -0,0 +1,303 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      Core Local Interruptor (CLINT) functional model.
+ */
+
+#include "api_core.h"
+#include "clint.h"
+#include <riscv-isa.h>
+
+namespace debugger {
+
+ClintHart::ClintHart(IService *parent, const char *portname, int idx) {
+    parent_ = parent;
+    parent->registerPortInterface(portname,
+                                  static_cast<IClockListener *>(this));
+    idx_ = idx;
+}
+
+void ClintHart::stepCallback(uint64_t t) {
+    static_cast<Clint *>(parent_)->hartCallback(idx_, t);
+}
+
+Clint::Clint(const char *name)  : IService(name) {
+    registerInterface(static_cast<IMemoryOperation *>(this));
+    registerInterface(static_cast<ISnapshot *>(this));
+    registerAttribute("CPU", &cpu_);
+    registerAttribute("TimeQuantum", &timeQuantum_);
+
+    cpu_.make_list(0);
+    timeQuantum_.make_uint64(0);
+
+    memset(hart_, 0, sizeof(hart_));
+    hartTotal_ = 0;
+    memset(&regs_, 0, sizeof(regs_));
+    for (int i = 0; i < HART_MAX; i++) {
+        regs_.mtimecmp[i] = ~0ull;
+    }
+    RISCV_mutex_init(&mutex_);
+}
+
+Clint::~Clint() {
+    for (int i = 0; i < hartTotal_; i++) {
+        delete hart_[i].listener;
+        RISCV_event_close(&hart_[i].evStep);
+    }
+    RISCV_mutex_destroy(&mutex_);
+}
+
+void Clint::postinitService() {
+    if (!cpu_.is_list() || cpu_.size() > static_cast<unsigned>(HART_MAX)) {
+        RISCV_error("List of up to %d harts expected", HART_MAX);
+        return;
+    }
+
+    uint64_t quantum = timeQuantum_.to_uint64();
+    for (unsigned i = 0; i < cpu_.size(); i++) {
+        const char *cpuname = cpu_[i].to_string();
+        HartType *p = &hart_[i];
+        p->iclk = static_cast<IClock *>(
+            RISCV_get_service_iface(cpuname, IFACE_CLOCK));
+        p->icpu = static_cast<ICpuGeneric *>(
+            RISCV_get_service_iface(cpuname, IFACE_CPU_GENERIC));
+        p->ifunc = static_cast<ICpuFunctional *>(
+            RISCV_get_service_iface(cpuname, IFACE_CPU_FUNCTIONAL));
+        p->ithread = static_cast<IThread *>(
+            RISCV_get_service_iface(cpuname, IFACE_THREAD));
+        if (!p->iclk || !p->icpu || !p->ifunc || !p->ithread) {
+            RISCV_error("Can't find functional CPU %s", cpuname);
+            return;
+        }
+        p->listener = new ClintHart(this, cpuname, i);
+        RISCV_event_create(&p->evStep, "clint_step");
+        hartTotal_++;
+
+        if (quantum) {
+            regs_.boundary[i] = quantum;
+            p->iclk->registerStepCallback(p->listener, quantum);
+        }
+    }
+}
+
+/**
+ * Registers map:
+ *     0x0000 + 4*hart  msip[hart]      Software interrupt pending bit
+ *     0x4000 + 8*hart  mtimecmp[hart]  Timer compare value
+ *     0xBFF8           mtime           Steps of the first hart
+ */
+ETransStatus Clint::b_transport(Axi4TransactionType *trans) {
+    uint64_t mask = (length_.to_uint64() - 1);
+    uint64_t off = ((trans->addr - getBaseAddress()) & mask) & ~0x3ull;
+    trans->response = MemResp_Valid;
+    RISCV_mutex_lock(&mutex_);
+    if (trans->action == MemAction_Write) {
+        for (uint64_t i = 0; i < trans->xsize; i += 4) {
+            if (((trans->wstrb >> i) & 0xF) == 0) {
+                continue;
+            }
+            writeReg(off + i, trans->wpayload.b32[i / 4]);
+        }
+    } else {
+        for (uint64_t i = 0; i < trans->xsize; i += 4) {
+            trans->rpayload.b32[i / 4] = readReg(off + i);
+        }
+    }
+    RISCV_mutex_unlock(&mutex_);
+    return TRANS_OK;
+}
+
+uint32_t Clint::readReg(uint64_t off) {
+    uint64_t t;
+    int idx;
+    if (off < 0x4000) {
+        idx = static_cast<int>(off >> 2);
+        return idx < hartTotal_ ? regs_.msip[idx] : 0;
+    } else if (off < 0xBFF8) {
+        idx = static_cast<int>((off - 0x4000) >> 3);
+        if (idx >= hartTotal_) {
+            return 0;
+        }
+        t = regs_.mtimecmp[idx];
+    } else if (off < 0xC000) {
+        t = getMTime();
+    } else {
+        return 0;
+    }
+    if (off & 0x4) {
+        t >>= 32;
+    }
+    return static_cast<uint32_t>(t);
+}
+
+void Clint::writeReg(uint64_t off, uint32_t val) {
+    uint64_t t;
+    int idx;
+    if (off < 0x4000) {
+        idx = static_cast<int>(off >> 2);
+        if (idx >= hartTotal_) {
+            return;
+        }
+        regs_.msip[idx] = val & 0x1;
+        RISCV_info("Set msip[%d] = %d", idx, regs_.msip[idx]);
+        wakeup(idx);
+        return;
+    }
+
+    if (off < 0xBFF8) {
+        idx = static_cast<int>((off - 0x4000) >> 3);
+        if (idx >= hartTotal_) {
+            return;
+        }
+        t = regs_.mtimecmp[idx];
+    } else if (off < 0xC000) {
+        idx = -1;
+        t = getMTime();
+    } else {
+        return;
+    }
+
+    if (off & 0x4) {
+        t &= 0xFFFFFFFFull;
+        t |= static_cast<uint64_t>(val) << 32;
+    } else {
+        t &= ~0xFFFFFFFFull;
+        t |= val;
+    }
+
+    if (idx >= 0) {
+        regs_.mtimecmp[idx] = t;
+        RISCV_info("Set mtimecmp[%d] = %" RV_PRI64 "x", idx, t);
+        wakeup(idx);
+    } else {
+        setMTime(t);
+        RISCV_info("Set mtime = %" RV_PRI64 "x", t);
+        for (int i = 0; i < hartTotal_; i++) {
+            wakeup(i);
+        }
+    }
+}
+
+uint64_t Clint::getMTime() {
+    if (hartTotal_ == 0) {
+        return 0;
+    }
+    return hart_[0].iclk->getStepCounter() + regs_.mtime_offset;
+}
+
+void Clint::setMTime(uint64_t val) {
+    if (hartTotal_ == 0) {
+        return;
+    }
+    regs_.mtime_offset = val - hart_[0].iclk->getStepCounter();
+}
+
+/**
+ * Registers may be written by any hart, so the new state is applied by
+ * the callback called from the thread of the target hart. Called with
+ * the mutex locked, so two harts can't both fail to move the callback and
+ * both register it.
+ */
+void Clint::wakeup(int idx) {
+    HartType *p = &hart_[idx];
+    p->iclk->moveStepCallback(p->listener, p->iclk->getStepCounter());
+    RISCV_event_set(&p->evStep);
+}
+
+/**
+ * Timer and software interrupts are raised on each step while they are
+ * pending the same way as the level interrupt of the IrqController. Timer
+ * deadline is converted into steps of the hart.
+ */
+void Clint::hartCallback(int idx, uint64_t t) {
+    HartType *p = &hart_[idx];
+    uint64_t quantum = timeQuantum_.to_uint64();
+    uint64_t next = ~0ull;
+    if (quantum) {
+        // Boundary is used only by this hart, waiting is done unlocked
+        if (t >= regs_.boundary[idx]) {
+            waitHarts(idx, regs_.boundary[idx]);
+            regs_.boundary[idx] = (t / quantum + 1) * quantum;
+        }
+        next = regs_.boundary[idx];
+    }
+
+    RISCV_mutex_lock(&mutex_);
+    uint64_t mtime = getMTime();
+    if (mtime >= regs_.mtimecmp[idx]) {
+        p->icpu->raiseSignal(INTERRUPT_MTimer);
+        next = t + 1;
+    } else {
+        p->icpu->lowerSignal(INTERRUPT_MTimer);
+        uint64_t dt = regs_.mtimecmp[idx] - mtime;
+        if (dt < next - t) {
+            next = t + dt;
+        }
+    }
+
+    // Software interrupt has higher priority and raised the last to be
+    // written into mcause
+    if (regs_.msip[idx]) {
+        p->icpu->raiseSignal(INTERRUPT_MSoftware);
+        next = t + 1;
+    } else {
+        p->icpu->lowerSignal(INTERRUPT_MSoftware);
+    }
+
+    if (next != ~0ull) {
+        p->iclk->moveStepCallback(p->listener, next);
+    }
+    RISCV_mutex_unlock(&mutex_);
+}
+
+/**
+ * Halted, turned off or stopped harts don't hold the others, so the
+ * breakpoint on one hart doesn't stop the whole system. Each hart reaching
+ * the boundary signals the others; halt doesn't signal anything, so the
+ * wait is also limited by 1 ms before the states are checked again.
+ */
+void Clint::waitHarts(int idx, uint64_t t) {
+    HartType *self = &hart_[idx];
+    for (int i = 0; i < hartTotal_; i++) {
+        if (i != idx) {
+            RISCV_event_set(&hart_[i].evStep);
+        }
+    }
+    for (int i = 0; i < hartTotal_; i++) {
+        HartType *p = &hart_[i];
+        if (i == idx) {
+            continue;
+        }
+        while (true) {
+            RISCV_event_clear(&self->evStep);
+            if (!self->ithread->isEnabled()
+                || !p->ithread->isEnabled() || !p->ifunc->isOn()
+                || p->ifunc->isHalt() || p->iclk->getStepCounter() >= t) {
+                break;
+            }
+            RISCV_event_wait_ms(&self->evStep, 1);
+        }
+    }
+}
+
+/**
+ * Hart callbacks are saved in the clock queues of the harts as the ports
+ * of this service.
+ */
+void Clint::saveState(AutoBuffer *buf) {
+    uint32_t total = static_cast<uint32_t>(hartTotal_);
+    buf->write_bin(reinterpret_cast<char *>(&total), sizeof(total));
+    buf->write_bin(reinterpret_cast<char *>(&regs_), sizeof(regs_));
+}
+
+bool Clint::restoreState(SnapshotReader *rd) {
+    uint32_t total;
+    if (!rd->read(&total, sizeof(total))
+        || total != static_cast<uint32_t>(hartTotal_)) {
+        return false;
+    }
+    return rd->read(&regs_, sizeof(regs_));
+}
+
+}  // namespace debugger
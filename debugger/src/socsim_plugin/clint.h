@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      Core Local Interruptor (CLINT) functional model.
+ */
+
+#ifndef __DEBUGGER_SOCSIM_PLUGIN_CLINT_H__
+#define __DEBUGGER_SOCSIM_PLUGIN_CLINT_H__
+
+#include <iclass.h>
+#include <iservice.h>
+#include "coreservices/iclock.h"
+#include "coreservices/imemop.h"
+#include "coreservices/isnapshot.h"
+#include "coreservices/ithread.h"
+#include "coreservices/icpugen.h"
+#include "coreservices/icpufunctional.h"
+
+namespace debugger {
+
+/** Clock listener registered in the queue of one hart */
+class ClintHart : public IClockListener {
+ public:
+    ClintHart(IService *parent, const char *portname, int idx);
+
+    /** IClockListener interface */
+    virtual void stepCallback(uint64_t t);
+
+ protected:
+    IService *parent_;
+    int idx_;
+};
+
+/**
+ * @brief Software interrupts and timer shared by the harts.
+ *
+ * Each hart is a separate CPU service running in its own thread. Interrupt
+ * signals are raised and lowered only from the thread of the hart, other
+ * threads just move the hart callback in its clock queue. Registers and
+ * the callback registration are changed under one mutex. When TimeQuantum
+ * isn't zero the hart callback is also called on each quantum boundary and
+ * waits until other running harts reach the same step.
+ */
+class Clint : public IService,
+              public IMemoryOperation,
+              public ISnapshot {
+ public:
+    explicit Clint(const char *name);
+    ~Clint();
+
+    /** IService interface */
+    virtual void postinitService();
+
+    /** IMemoryOperation */
+    virtual ETransStatus b_transport(Axi4TransactionType *trans);
+
+    /** ISnapshot */
+    virtual void saveState(AutoBuffer *buf);
+    virtual bool restoreState(SnapshotReader *rd);
+
+    /** Controller specific methods visible for ports */
+    void hartCallback(int idx, uint64_t t);
+
+ private:
+    uint32_t readReg(uint64_t off);
+    void writeReg(uint64_t off, uint32_t val);
+    uint64_t getMTime();
+    void setMTime(uint64_t val);
+    void wakeup(int idx);
+    void waitHarts(int idx, uint64_t t);
+
+ private:
+    AttributeType cpu_;
+    AttributeType timeQuantum_;
+
+    static const int HART_MAX = 16;
+    struct HartType {
+        ClintHart *listener;
+        IClock *iclk;
+        ICpuGeneric *icpu;
+        ICpuFunctional *ifunc;
+        IThread *ithread;
+        event_def evStep;       // other hart reached boundary or wakeup
+    } hart_[HART_MAX];
+    int hartTotal_;
+    mutex_def mutex_;
+
+    struct clint_state {
+        uint32_t msip[HART_MAX];        // 0x0000 + 4*hart: [RW]
+        uint64_t mtimecmp[HART_MAX];    // 0x4000 + 8*hart: [RW]
+        uint64_t mtime_offset;          // 0xBFF8 mtime relative hart 0
+        uint64_t boundary[HART_MAX];    // next quantum boundary step
+    } regs_;
+};
+
+DECLARE_CLASS(Clint)
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_SOCSIM_PLUGIN_CLINT_H__
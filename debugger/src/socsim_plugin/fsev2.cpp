@@ -21,6 +21,7 @@ static const uint32_t FSE2_STATE_IDLE       = (1 << 16);
 
 FseV2::FseV2(const char *name)  : IService(name) {
     registerInterface(static_cast<IMemoryOperation *>(this));
+    registerInterface(static_cast<ISnapshot *>(this));
 
     memset(&regs_, 0, sizeof(regs_));
     regs_.hw_id = (16 << 16) | 5;   // 16 msec accum, 5=id
@@ -48,4 +49,12 @@ ETransStatus FseV2::b_transport(Axi4TransactionType *trans) {
     return TRANS_OK;
 }
 
+void FseV2::saveState(AutoBuffer *buf) {
+    buf->write_bin(reinterpret_cast<char *>(&regs_), sizeof(regs_));
+}
+
+bool FseV2::restoreState(SnapshotReader *rd) {
+    return rd->read(&regs_, sizeof(regs_));
+}
+
 }  // namespace debugger
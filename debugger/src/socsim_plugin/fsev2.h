@@ -11,17 +11,23 @@
 #include "iclass.h"
 #include "iservice.h"
 #include "coreservices/imemop.h"
+#include "coreservices/isnapshot.h"
 
 namespace debugger {
 
 class FseV2 : public IService, 
-              public IMemoryOperation {
+              public IMemoryOperation,
+              public ISnapshot {
 public:
     FseV2(const char *name);
 
     /** IMemoryOperation */
     virtual ETransStatus b_transport(Axi4TransactionType *trans);
 
+    /** ISnapshot */
+    virtual void saveState(AutoBuffer *buf);
+    virtual bool restoreState(SnapshotReader *rd);
+
 private:
     static const int FSE2_CHAN_MAX = 32;
 
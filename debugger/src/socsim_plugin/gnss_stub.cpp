@@ -13,6 +13,7 @@ namespace debugger {
 GNSSStub::GNSSStub(const char *name)  : IService(name) {
     registerInterface(static_cast<IMemoryOperation *>(this));
     registerInterface(static_cast<IClockListener *>(this));
+    registerInterface(static_cast<ISnapshot *>(this));
     registerAttribute("IrqControl", &irqctrl_);
     registerAttribute("ClkSource", &clksrc_);
 
@@ -79,5 +80,13 @@ void GNSSStub::stepCallback(uint64_t t) {
     }
 }
 
+void GNSSStub::saveState(AutoBuffer *buf) {
+    buf->write_bin(reinterpret_cast<char *>(&regs_), sizeof(regs_));
+}
+
+bool GNSSStub::restoreState(SnapshotReader *rd) {
+    return rd->read(&regs_, sizeof(regs_));
+}
+
 }  // namespace debugger
 
@@ -11,6 +11,7 @@
 #include "iclass.h"
 #include "iservice.h"
 #include "coreservices/imemop.h"
+#include "coreservices/isnapshot.h"
 #include "coreservices/iclock.h"
 #include "coreservices/iwire.h"
 
@@ -18,7 +19,8 @@ namespace debugger {
 
 class GNSSStub : public IService, 
                  public IMemoryOperation,
-                 public IClockListener {
+                 public IClockListener,
+                 public ISnapshot {
 public:
     GNSSStub(const char *name);
     ~GNSSStub();
@@ -28,6 +30,10 @@ public:
 
     /** IMemoryOperation */
     virtual ETransStatus b_transport(Axi4TransactionType *trans);
+
+    /** ISnapshot */
+    virtual void saveState(AutoBuffer *buf);
+    virtual bool restoreState(SnapshotReader *rd);
     
     /** IClockListener */
     virtual void stepCallback(uint64_t t);
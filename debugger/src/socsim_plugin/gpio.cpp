@@ -13,6 +13,7 @@ namespace debugger {
 GPIO::GPIO(const char *name)  : IService(name) {
     registerInterface(static_cast<IMemoryOperation *>(this));
     registerInterface(static_cast<IWire *>(this));
+    registerInterface(static_cast<ISnapshot *>(this));
     registerAttribute("DIP", &dip_);
 
     memset(&regs_, 0, sizeof(regs_));
@@ -63,4 +64,12 @@ ETransStatus GPIO::b_transport(Axi4TransactionType *trans) {
     RISCV_info("set level pins[%d:%d] <= %" RV_PRI64 "x", start - 1, width, t);
 }*/
 
+void GPIO::saveState(AutoBuffer *buf) {
+    buf->write_bin(reinterpret_cast<char *>(&regs_), sizeof(regs_));
+}
+
+bool GPIO::restoreState(SnapshotReader *rd) {
+    return rd->read(&regs_, sizeof(regs_));
+}
+
 }  // namespace debugger
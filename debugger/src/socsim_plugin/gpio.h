@@ -11,13 +11,15 @@
 #include "iclass.h"
 #include "iservice.h"
 #include "coreservices/imemop.h"
+#include "coreservices/isnapshot.h"
 #include "coreservices/iwire.h"
 
 namespace debugger {
 
 class GPIO : public IService, 
              public IMemoryOperation,
-             public IWire {
+             public IWire,
+             public ISnapshot {
 public:
     GPIO(const char *name);
     ~GPIO();
@@ -28,6 +30,10 @@ public:
     /** IMemoryOperation */
     virtual ETransStatus b_transport(Axi4TransactionType *trans);
 
+    /** ISnapshot */
+    virtual void saveState(AutoBuffer *buf);
+    virtual bool restoreState(SnapshotReader *rd);
+
     /** IWire interface */
     virtual void raiseLine() {}
     virtual void lowerLine() {}
@@ -12,6 +12,8 @@ namespace debugger {
 
 GPTimers::GPTimers(const char *name)  : IService(name) {
     registerInterface(static_cast<IMemoryOperation *>(this));
+    registerInterface(static_cast<IClockListener *>(this));
+    registerInterface(static_cast<ISnapshot *>(this));
     registerAttribute("IrqControl", &irqctrl_);
     registerAttribute("ClkSource", &clksrc_);
 
@@ -128,6 +130,13 @@ void GPTimers::stepCallback(uint64_t t) {
     }
 }
 
+void GPTimers::saveState(AutoBuffer *buf) {
+    buf->write_bin(reinterpret_cast<char *>(&regs_), sizeof(regs_));
+}
+
+bool GPTimers::restoreState(SnapshotReader *rd) {
+    return rd->read(&regs_, sizeof(regs_));
+}
 
 }  // namespace debugger
 
@@ -35,6 +35,7 @@ void IrqPort::setLevel(bool level) {
 IrqController::IrqController(const char *name)  : IService(name) {
     registerInterface(static_cast<IMemoryOperation *>(this));
     registerInterface(static_cast<IClockListener *>(this));
+    registerInterface(static_cast<ISnapshot *>(this));
     registerAttribute("CPU", &cpu_);
     registerAttribute("CSR_MIPI", &mipi_);
     registerAttribute("IrqTotal", &irqTotal_);
@@ -52,9 +53,13 @@ IrqController::IrqController(const char *name)  : IService(name) {
     memset(&regs_, 0, sizeof(regs_));
     regs_.irq_mask = ~0;
     regs_.irq_lock = 1;
+    iclk_ = 0;
+    scheduled_ = false;
+    RISCV_mutex_init(&mutexPending_);
 }
 
 IrqController::~IrqController() {
+    RISCV_mutex_destroy(&mutexPending_);
 }
 
 void IrqController::postinitService() {
@@ -71,8 +76,6 @@ void IrqController::postinitService() {
         RISCV_error("Can't find ICpuRiscV interface %s", cpu_.to_string());
         return;
     }
-    uint64_t t = iclk_->getStepCounter();
-    iclk_->registerStepCallback(static_cast<IClockListener *>(this), t + 1);
 }
 
 ETransStatus IrqController::b_transport(Axi4TransactionType *trans) {
@@ -81,6 +84,7 @@ ETransStatus IrqController::b_transport(Axi4TransactionType *trans) {
     uint32_t t1;
     trans->response = MemResp_Valid;
     if (trans->action == MemAction_Write) {
+        RISCV_mutex_lock(&mutexPending_);
         for (uint64_t i = 0; i < trans->xsize/4; i++) {
             if (((trans->wstrb >> 4*i) & 0xFF) == 0) {
                 continue;
@@ -159,6 +163,8 @@ ETransStatus IrqController::b_transport(Axi4TransactionType *trans) {
             default:;
             }
         }
+        checkPending();
+        RISCV_mutex_unlock(&mutexPending_);
     } else {
         for (uint64_t i = 0; i < trans->xsize/4; i++) {
             switch (off + i) {
@@ -232,20 +238,73 @@ ETransStatus IrqController::b_transport(Axi4TransactionType *trans) {
 }
 
 void IrqController::stepCallback(uint64_t t) {
-    iclk_->registerStepCallback(static_cast<IClockListener *>(this), t + 1);
-    if (regs_.irq_lock == 1) {
-        return;
+    bool raise = false;
+    RISCV_mutex_lock(&mutexPending_);
+    scheduled_ = false;
+    if (regs_.irq_lock == 0 && (~regs_.irq_mask & regs_.irq_pending)) {
+        scheduled_ = true;
+        iclk_->registerStepCallback(static_cast<IClockListener *>(this),
+                                    t + 1);
+        raise = true;
     }
-    if (~regs_.irq_mask & regs_.irq_pending) {
+    RISCV_mutex_unlock(&mutexPending_);
+    if (raise) {
         icpu_->raiseSignal(INTERRUPT_MExternal);   // PLIC interrupt (external)
         RISCV_debug("Raise interrupt", NULL);
     }
 }
 
 void IrqController::requestInterrupt(int idx) {
+    RISCV_mutex_lock(&mutexPending_);
     regs_.irq_pending |= (0x1 << idx);
+    checkPending();
+    RISCV_mutex_unlock(&mutexPending_);
     RISCV_info("request Interrupt %d", idx);
 }
 
+/**
+ * Controller is registered in the clock queue only while it has unmasked
+ * and unlocked pending request, raising the CPU signal on each step until
+ * the request is served. Called with mutexPending_ locked.
+ */
+void IrqController::checkPending() {
+    if (scheduled_ || !iclk_ || regs_.irq_lock == 1
+        || (~regs_.irq_mask & regs_.irq_pending) == 0) {
+        return;
+    }
+    scheduled_ = true;
+    iclk_->registerStepCallback(static_cast<IClockListener *>(this),
+                                iclk_->getStepCounter());
+}
+
+/**
+ * Scheduling flag is saved together with the CPU clock queue, so it stays
+ * consistent with the restored queue.
+ */
+void IrqController::saveState(AutoBuffer *buf) {
+    uint32_t st[2];
+    st[0] = scheduled_ ? 1 : 0;
+    st[1] = 0;
+    for (int i = 1; i < IRQ_MAX; i++) {
+        if (irqlines_[i]->getLevel()) {
+            st[1] |= 1u << i;
+        }
+    }
+    buf->write_bin(reinterpret_cast<char *>(&regs_), sizeof(regs_));
+    buf->write_bin(reinterpret_cast<char *>(st), sizeof(st));
+}
+
+bool IrqController::restoreState(SnapshotReader *rd) {
+    uint32_t st[2];
+    if (!rd->read(&regs_, sizeof(regs_)) || !rd->read(st, sizeof(st))) {
+        return false;
+    }
+    scheduled_ = st[0] != 0;
+    for (int i = 1; i < IRQ_MAX; i++) {
+        irqlines_[i]->restoreLevel(((st[1] >> i) & 0x1) != 0);
+    }
+    return true;
+}
+
 }  // namespace debugger
 
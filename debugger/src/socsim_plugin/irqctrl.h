@@ -12,6 +12,7 @@
 #include <iservice.h>
 #include "coreservices/iclock.h"
 #include "coreservices/imemop.h"
+#include "coreservices/isnapshot.h"
 #include "coreservices/iwire.h"
 #include "coreservices/icpugen.h"
 
@@ -27,6 +28,9 @@ class IrqPort : public IWire {
     virtual void setLevel(bool level);
     virtual bool getLevel() { return level_; }
 
+    /** Set level without interrupt request */
+    void restoreLevel(bool level) { level_ = level; }
+
  protected:
     IService *parent_;
     int idx_;
@@ -35,7 +39,8 @@ class IrqPort : public IWire {
 
 class IrqController : public IService, 
                       public IMemoryOperation,
-                      public IClockListener {
+                      public IClockListener,
+                      public ISnapshot {
  public:
     IrqController(const char *name);
     ~IrqController();
@@ -46,18 +51,27 @@ class IrqController : public IService,
     /** IMemoryOperation */
     virtual ETransStatus b_transport(Axi4TransactionType *payload);
 
+    /** ISnapshot */
+    virtual void saveState(AutoBuffer *buf);
+    virtual bool restoreState(SnapshotReader *rd);
+
     /** IClockListener interface */
     virtual void stepCallback(uint64_t t);
 
     /** Controller specific methods visible for ports */
     void requestInterrupt(int idx);
 
+ private:
+    void checkPending();
+
  private:
     AttributeType mipi_;
     AttributeType irqTotal_;
     AttributeType cpu_;
     ICpuGeneric *icpu_;
     IClock *iclk_;
+    mutex_def mutexPending_;    // UART threads request interrupts too
+    bool scheduled_;
     static const int IRQ_MAX = 32;
     IrqPort *irqlines_[IRQ_MAX];
 
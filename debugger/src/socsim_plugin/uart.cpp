@@ -33,6 +33,7 @@ static const uint32_t UART_CONTROL_PARITY_ENA = 0x00008000;
 UART::UART(const char *name)  : IService(name) {
     registerInterface(static_cast<IMemoryOperation *>(this));
     registerInterface(static_cast<ISerial *>(this));
+    registerInterface(static_cast<ISnapshot *>(this));
     registerAttribute("IrqControl", &irqctrl_);
     registerAttribute("AutoTestEna", &autoTestEna_);
     registerAttribute("TestCases", &testCases_);
@@ -243,5 +244,33 @@ void UART::AutoTest::stepCallback(uint64_t t) {
     }
 }
 
+void UART::saveState(AutoBuffer *buf) {
+    int32_t fifo[3];
+    fifo[0] = static_cast<int32_t>(p_rx_wr_ - rxfifo_);
+    fifo[1] = static_cast<int32_t>(p_rx_rd_ - rxfifo_);
+    fifo[2] = rx_total_;
+    buf->write_bin(reinterpret_cast<char *>(&regs_), sizeof(regs_));
+    buf->write_bin(rxfifo_, sizeof(rxfifo_));
+    buf->write_bin(reinterpret_cast<char *>(fifo), sizeof(fifo));
+}
+
+bool UART::restoreState(SnapshotReader *rd) {
+    int32_t fifo[3];
+    if (!rd->read(&regs_, sizeof(regs_))
+        || !rd->read(rxfifo_, sizeof(rxfifo_))
+        || !rd->read(fifo, sizeof(fifo))) {
+        return false;
+    }
+    for (int i = 0; i < 3; i++) {
+        if (fifo[i] < 0 || fifo[i] > RX_FIFO_SIZE) {
+            return false;
+        }
+    }
+    p_rx_wr_ = &rxfifo_[fifo[0] % RX_FIFO_SIZE];
+    p_rx_rd_ = &rxfifo_[fifo[1] % RX_FIFO_SIZE];
+    rx_total_ = fifo[2];
+    return true;
+}
+
 }  // namespace debugger
 
@@ -20,6 +20,7 @@
 #include "iclass.h"
 #include "iservice.h"
 #include "coreservices/imemop.h"
+#include "coreservices/isnapshot.h"
 #include "coreservices/iserial.h"
 #include "coreservices/iwire.h"
 #include "coreservices/irawlistener.h"
@@ -30,7 +31,8 @@ namespace debugger {
 
 class UART : public IService, 
              public IMemoryOperation,
-             public ISerial {
+             public ISerial,
+             public ISnapshot {
  public:
     UART(const char *name);
     ~UART();
@@ -41,6 +43,10 @@ class UART : public IService,
     /** IMemoryOperation */
     virtual ETransStatus b_transport(Axi4TransactionType *trans);
 
+    /** ISnapshot */
+    virtual void saveState(AutoBuffer *buf);
+    virtual bool restoreState(SnapshotReader *rd);
+
     /** ISerial */
     virtual int writeData(const char *buf, int sz);
     virtual void registerRawListener(IFace *listener);